@@ -53,7 +53,41 @@ Window {
         Button {
             text: "Step"
             Layout.margins: 10
-            onClicked: Computer.cpu.clock()
+            onClicked: Computer.stepClock()
+        }
+        Button {
+            text: "Step Back"
+            Layout.margins: 10
+            onClicked: Computer.stepBackClock()
+        }
+        ComboBox {
+            id: frequency_box
+            Layout.margins: 10
+            model: [ "1 MHz", "1.79 MHz (NTSC)", "2 MHz" ]
+            property var frequencies: [ 1.0, 1.789773, 2.0 ]
+            onCurrentIndexChanged: Computer.frequencyMHz = frequencies[currentIndex]
+        }
+        SpinBox {
+            id: speed_box
+            Layout.margins: 10
+            decimals: 2
+            stepSize: 0.25
+            minimumValue: 0.25
+            maximumValue: 16
+            value: 1
+            suffix: "x"
+            enabled: !Computer.turbo
+            onValueChanged: Computer.speedMultiplier = value
+        }
+        CheckBox {
+            text: "Turbo"
+            Layout.margins: 10
+            checked: Computer.turbo
+            onClicked: Computer.turbo = checked
+        }
+        Label {
+            Layout.margins: 10
+            text: Computer.effectiveMHz.toFixed(3) + " MHz"
         }
     }
     ColumnLayout {
@@ -0,0 +1,636 @@
+#include "batchexecutor.hpp"
+#include <algorithm>
+#include <type_traits>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+// The instructions executed in lockstep are written once, as kernels over a
+// type holding one byte register for some number of lanes. Lanes16 holds
+// sixteen of them in an SSE2 register; Lanes1 holds a single one, for
+// machines without SSE2. Comparisons give 0xFF where true and 0x00 where
+// false, the same as SSE2's.
+namespace
+{
+using Operation = InstructionExecutor::Operation;
+
+#if defined(__SSE2__)
+class Lanes16
+{
+public:
+    static constexpr size_t width = 16;
+
+    Lanes16(__m128i value) : _value(value) {}
+
+    static Lanes16 load(const uint8_t *lanes) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(lanes)); }
+    static Lanes16 splat(uint8_t value) { return _mm_set1_epi8(static_cast<char>(value)); }
+    void store(uint8_t *lanes) const { _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), _value); }
+
+    friend Lanes16 operator &(Lanes16 l, Lanes16 r) { return _mm_and_si128(l._value, r._value); }
+    friend Lanes16 operator |(Lanes16 l, Lanes16 r) { return _mm_or_si128(l._value, r._value); }
+    friend Lanes16 operator ^(Lanes16 l, Lanes16 r) { return _mm_xor_si128(l._value, r._value); }
+    friend Lanes16 operator +(Lanes16 l, Lanes16 r) { return _mm_add_epi8(l._value, r._value); }
+    friend Lanes16 operator -(Lanes16 l, Lanes16 r) { return _mm_sub_epi8(l._value, r._value); }
+    friend Lanes16 operator ~(Lanes16 l) { return _mm_xor_si128(l._value, _mm_set1_epi8(-1)); }
+    friend Lanes16 equal(Lanes16 l, Lanes16 r) { return _mm_cmpeq_epi8(l._value, r._value); }
+    friend Lanes16 maximum(Lanes16 l, Lanes16 r) { return _mm_max_epu8(l._value, r._value); }
+    friend Lanes16 shiftRight(Lanes16 l) { return _mm_and_si128(_mm_srli_epi16(l._value, 1), _mm_set1_epi8(0x7F)); }
+    friend Lanes16 select(Lanes16 mask, Lanes16 l, Lanes16 r)
+    {
+        return _mm_or_si128(_mm_and_si128(mask._value, l._value), _mm_andnot_si128(mask._value, r._value));
+    }
+private:
+    __m128i _value;
+};
+#endif
+
+class Lanes1
+{
+public:
+    static constexpr size_t width = 1;
+
+    Lanes1(uint8_t value) : _value(value) {}
+
+    static Lanes1 load(const uint8_t *lanes) { return *lanes; }
+    static Lanes1 splat(uint8_t value) { return value; }
+    void store(uint8_t *lanes) const { *lanes = _value; }
+
+    friend Lanes1 operator &(Lanes1 l, Lanes1 r) { return l._value & r._value; }
+    friend Lanes1 operator |(Lanes1 l, Lanes1 r) { return l._value | r._value; }
+    friend Lanes1 operator ^(Lanes1 l, Lanes1 r) { return l._value ^ r._value; }
+    friend Lanes1 operator +(Lanes1 l, Lanes1 r) { return static_cast<uint8_t>(l._value + r._value); }
+    friend Lanes1 operator -(Lanes1 l, Lanes1 r) { return static_cast<uint8_t>(l._value - r._value); }
+    friend Lanes1 operator ~(Lanes1 l) { return static_cast<uint8_t>(~l._value); }
+    friend Lanes1 equal(Lanes1 l, Lanes1 r) { return (l._value == r._value) ? 0xFF : 0x00; }
+    friend Lanes1 maximum(Lanes1 l, Lanes1 r) { return std::max(l._value, r._value); }
+    friend Lanes1 shiftRight(Lanes1 l) { return l._value >> 1; }
+    friend Lanes1 select(Lanes1 mask, Lanes1 l, Lanes1 r) { return (mask._value & l._value) | (~mask._value & r._value); }
+private:
+    uint8_t _value;
+};
+
+template<typename Lanes>
+struct LaneRegisters
+{
+    Lanes a, x, y, stack_pointer, status;
+};
+
+template<typename Lanes>
+Lanes isSet(Lanes value, uint8_t bits)
+{
+    return ~equal(value & Lanes::splat(bits), Lanes::splat(0));
+}
+
+// Sets N and Z from value
+template<typename Lanes>
+Lanes withNZ(Lanes status, Lanes value)
+{
+    return (status & Lanes::splat(static_cast<uint8_t>(~(N | Z)))) |
+           (value & Lanes::splat(N)) |
+           (equal(value, Lanes::splat(0)) & Lanes::splat(Z));
+}
+
+// Sets N and Z from value, and C in the lanes where carry is 0xFF
+template<typename Lanes>
+Lanes withCNZ(Lanes status, Lanes carry, Lanes value)
+{
+    return withNZ((status & Lanes::splat(static_cast<uint8_t>(~C))) | (carry & Lanes::splat(C)), value);
+}
+
+template<typename Lanes>
+void addWithCarry(LaneRegisters<Lanes> &r, Lanes value)
+{
+    const Lanes carry_in = isSet(r.status, C);
+    const Lanes partial  = r.a + value;
+    const Lanes sum      = partial + (carry_in & Lanes::splat(1));
+
+    // Unsigned overflow shows as a sum smaller than what was added to
+    const Lanes carry    = ~equal(maximum(partial, r.a), partial) | (carry_in & equal(sum, Lanes::splat(0)));
+    const Lanes overflow = shiftRight(~(r.a ^ value) & (r.a ^ sum)) & Lanes::splat(V);
+
+    r.status = withCNZ(r.status & Lanes::splat(static_cast<uint8_t>(~V)), carry, sum) | overflow;
+    r.a      = sum;
+}
+
+template<typename Lanes>
+void compare(LaneRegisters<Lanes> &r, Lanes reg, Lanes value)
+{
+    r.status = withCNZ(r.status, equal(maximum(reg, value), reg), reg - value);
+}
+
+// Sets N and Z from a value, and passes it on to be stored
+template<typename Lanes>
+Lanes nz(LaneRegisters<Lanes> &r, Lanes value)
+{
+    r.status = withNZ(r.status, value);
+    return value;
+}
+
+// Runs a kernel over lanes [first, end) that many at a time, keeping the
+// results only for the lanes in mask
+template<typename Lanes, typename Kernel>
+size_t applyKernel(size_t first, size_t end, const uint8_t *mask, const uint8_t *operand,
+                   uint8_t *a, uint8_t *x, uint8_t *y, uint8_t *stack_pointer, uint8_t *status, Kernel &kernel)
+{
+    size_t index = first;
+
+    for (; index + Lanes::width <= end; index += Lanes::width)
+    {
+        const Lanes               active = Lanes::load(mask + index);
+        const LaneRegisters<Lanes> before { Lanes::load(a + index), Lanes::load(x + index), Lanes::load(y + index),
+                                            Lanes::load(stack_pointer + index), Lanes::load(status + index) };
+        LaneRegisters<Lanes>       after = before;
+
+        kernel(after, Lanes::load(operand + index));
+        select(active, after.a, before.a).store(a + index);
+        select(active, after.x, before.x).store(x + index);
+        select(active, after.y, before.y).store(y + index);
+        select(active, after.stack_pointer, before.stack_pointer).store(stack_pointer + index);
+        select(active, after.status, before.status).store(status + index);
+    }
+    return index;
+}
+
+bool readsOperand(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::LDA: case Operation::LDX: case Operation::LDY:
+    case Operation::AND: case Operation::ORA: case Operation::EOR:
+    case Operation::ADC: case Operation::SBC:
+    case Operation::CMP: case Operation::CPX: case Operation::CPY:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+BatchExecutor::BatchExecutor(size_t lanes)
+    :
+    _lanes(lanes),
+    _padded_lanes((lanes + 15) & ~size_t(15)),
+    _a(_padded_lanes), _x(_padded_lanes), _y(_padded_lanes), _stack_pointer(_padded_lanes), _status(_padded_lanes),
+    _program_counter(_padded_lanes),
+    _lockstep(_padded_lanes),
+    _operand(_padded_lanes),
+    _memory(lanes << 16),
+    _results(lanes),
+    _scalar_registers(lanes),
+    _scalar(lanes)
+{
+}
+
+BatchExecutor::~BatchExecutor()
+{
+}
+
+void BatchExecutor::load(addressType address, const std::vector<uint8_t> &bytes)
+{
+    for (size_t lane = 0; lane < _lanes; ++lane)
+    {
+        for (size_t index = 0; index < bytes.size(); ++index)
+            memory(lane)[static_cast<addressType>(address + index)] = bytes[index];
+    }
+}
+
+Registers BatchExecutor::registers(size_t lane) const
+{
+    Registers registers;
+
+    registers.a               = _a[lane];
+    registers.x               = _x[lane];
+    registers.y               = _y[lane];
+    registers.stack_pointer   = _stack_pointer[lane];
+    registers.program_counter = _program_counter[lane];
+    registers.status          = _status[lane];
+    return registers;
+}
+
+void BatchExecutor::setRegisters(size_t lane, const Registers &registers)
+{
+    _a[lane]               = registers.a;
+    _x[lane]               = registers.x;
+    _y[lane]               = registers.y;
+    _stack_pointer[lane]   = registers.stack_pointer;
+    _program_counter[lane] = registers.program_counter;
+    _status[lane]          = registers.status;
+}
+
+void BatchExecutor::run(uint64_t cycle_budget)
+{
+    std::vector<size_t> dropped;
+
+    std::fill(_results.begin(), _results.end(), LaneResult());
+    std::fill(_lockstep.begin(), _lockstep.begin() + _lanes, 0xFF);
+    for (auto &scalar : _scalar)
+    {
+        // Lockstep execution writes memory behind the executors' backs
+        if (scalar)
+            scalar->setPredecode(false);
+    }
+
+    while (true)
+    {
+        size_t leader = _lanes;
+
+        for (size_t lane = 0; lane < _lanes; ++lane)
+        {
+            if (_lockstep[lane] && (_results[lane].cycles >= cycle_budget))
+                _lockstep[lane] = 0x00;
+            else if (_lockstep[lane] && (leader == _lanes))
+                leader = lane;
+        }
+        if (leader == _lanes)
+            break;
+
+        // Lanes which are somewhere else, or have different code there, go their own way.
+        const uint8_t *code    = memory(leader);
+        const uint16_t address = _program_counter[leader];
+        const uint8_t  opcode  = code[address];
+        const uint8_t  length  = InstructionExecutor::lengthOf(opcode);
+
+        for (size_t lane = leader + 1; lane < _lanes; ++lane)
+        {
+            if (!_lockstep[lane])
+                continue;
+
+            bool same = (_program_counter[lane] == address);
+
+            for (uint8_t index = 0; same && (index < length); ++index)
+                same = (memory(lane)[static_cast<addressType>(address + index)] == code[static_cast<addressType>(address + index)]);
+            if (!same)
+            {
+                _lockstep[lane] = 0x00;
+                dropped.push_back(lane);
+            }
+        }
+
+        const INSTRUCTION &entry = InstructionExecutor::instructionFor(opcode);
+
+        // Every lane in lockstep has executed as many instructions as the leader
+        if ((_results[leader].instructions > 0) &&
+            ((entry.operate == Operation::BRK) || (entry.operate == Operation::XXX)))
+        {
+            for (size_t lane = leader; lane < _lanes; ++lane)
+            {
+                if (_lockstep[lane])
+                {
+                    _results[lane].reason = (entry.operate == Operation::BRK) ? StopReason::Break : StopReason::IllegalOpcode;
+                    _lockstep[lane] = 0x00;
+                }
+            }
+            break;
+        }
+
+        uint16_t operand = 0;
+
+        if (length > 1)
+            operand = code[static_cast<addressType>(address + 1)];
+        if (length > 2)
+            operand |= code[static_cast<addressType>(address + 2)] << 8;
+
+        if (executeLockstep(entry, operand, length))
+        {
+            for (size_t lane = leader; lane < _lanes; ++lane)
+            {
+                if (_lockstep[lane])
+                {
+                    _status[lane] |= U;
+                    _results[lane].cycles += entry.cycles;
+                }
+            }
+        }
+        else
+        {
+            for (size_t lane = leader; lane < _lanes; ++lane)
+            {
+                if (_lockstep[lane])
+                    executeScalar(lane);
+            }
+        }
+
+        for (size_t lane = leader; lane < _lanes; ++lane)
+        {
+            if (_lockstep[lane])
+            {
+                ++_results[lane].instructions;
+                ++_results[lane].lockstep_instructions;
+            }
+        }
+    }
+
+    for (size_t lane : dropped)
+        runScalar(lane, cycle_budget);
+}
+
+InstructionExecutor &BatchExecutor::scalarFor(size_t lane)
+{
+    if (!_scalar[lane])
+    {
+        uint8_t *host = memory(lane);
+
+        _scalar[lane].reset(new InstructionExecutor(_scalar_registers[lane],
+                                                    [host](addressType address, bool) { return host[address]; },
+                                                    [host](addressType address, uint8_t data) { host[address] = data; }));
+        for (unsigned page = 0; page < 0x100; ++page)
+            _scalar[lane]->mapPage(static_cast<uint8_t>(page), host + page * 0x100, host + page * 0x100);
+        _scalar[lane]->setPredecode(false);
+    }
+    return *_scalar[lane];
+}
+
+// Executes the next instruction of a lane in lockstep by itself
+void BatchExecutor::executeScalar(size_t lane)
+{
+    InstructionExecutor &executor = scalarFor(lane);
+
+    _scalar_registers[lane] = registers(lane);
+    _results[lane].cycles += executor.runInstructions(1).cycles;
+    setRegisters(lane, _scalar_registers[lane]);
+}
+
+// Runs a lane which has left lockstep to the end of the budget
+void BatchExecutor::runScalar(size_t lane, uint64_t cycle_budget)
+{
+    InstructionExecutor &executor = scalarFor(lane);
+    LaneResult          &result = _results[lane];
+    const Operation      next = InstructionExecutor::instructionFor(memory(lane)[_program_counter[lane]]).operate;
+
+    // A run only goes past a BRK or an illegal opcode it starts on.
+    if ((result.instructions > 0) && ((next == Operation::BRK) || (next == Operation::XXX)))
+    {
+        result.reason = (next == Operation::BRK) ? StopReason::Break : StopReason::IllegalOpcode;
+        return;
+    }
+
+    _scalar_registers[lane] = registers(lane);
+    executor.invalidatePredecoded();
+    executor.setPredecode(true);
+
+    InstructionExecutor::RunResult scalar = executor.runCycles(cycle_budget - result.cycles);
+
+    // Finish off the last instruction, as lanes in lockstep do
+    if (!executor.complete())
+        scalar.cycles += executor.runCycles(executor.remainingCyclesForInstruction()).cycles;
+
+    result.cycles       += scalar.cycles;
+    result.instructions += scalar.instructions;
+    result.reason        = scalar.reason;
+    setRegisters(lane, _scalar_registers[lane]);
+}
+
+uint16_t BatchExecutor::addressFor(size_t lane, AddressingMode mode, uint16_t operand, bool &crossed_page) const
+{
+    const uint8_t *host = &_memory[lane << 16];
+    uint16_t       address = operand;
+
+    crossed_page = false;
+    switch (mode)
+    {
+    case AddressingMode::ZPX:
+        return (operand + _x[lane]) & 0x00FF;
+    case AddressingMode::ZPY:
+        return (operand + _y[lane]) & 0x00FF;
+    case AddressingMode::ABX:
+        address = operand + _x[lane];
+        break;
+    case AddressingMode::ABY:
+        address = operand + _y[lane];
+        break;
+    case AddressingMode::IZX:
+        return host[(operand + _x[lane]) & 0x00FF] | (host[(operand + _x[lane] + 1) & 0x00FF] << 8);
+    case AddressingMode::IZY:
+        operand = host[operand & 0x00FF] | (host[(operand + 1) & 0x00FF] << 8);
+        address = operand + _y[lane];
+        break;
+    default:
+        return operand;
+    }
+    crossed_page = ((address & 0xFF00) != (operand & 0xFF00));
+    return address;
+}
+
+// Fills in each lane's operand. Every instruction reading one takes an extra
+// cycle when indexing crosses a page.
+bool BatchExecutor::fetchOperands(AddressingMode mode, uint16_t operand)
+{
+    switch (mode)
+    {
+    case AddressingMode::IMP:
+        _operand = _a;
+        return true;
+    case AddressingMode::IMM:
+        std::fill(_operand.begin(), _operand.end(), static_cast<uint8_t>(operand));
+        return true;
+    case AddressingMode::REL:
+    case AddressingMode::IND:
+        return false;
+    default:
+        break;
+    }
+
+    for (size_t lane = 0; lane < _lanes; ++lane)
+    {
+        if (_lockstep[lane])
+        {
+            bool crossed_page;
+
+            _operand[lane] = memory(lane)[addressFor(lane, mode, operand, crossed_page)];
+            _results[lane].cycles += crossed_page ? 1 : 0;
+        }
+    }
+    return true;
+}
+
+bool BatchExecutor::storeOperands(AddressingMode mode, uint16_t operand, const std::vector<uint8_t> &source)
+{
+    if ((mode == AddressingMode::IMP) || (mode == AddressingMode::IMM) ||
+        (mode == AddressingMode::REL) || (mode == AddressingMode::IND))
+        return false;
+
+    for (size_t lane = 0; lane < _lanes; ++lane)
+    {
+        if (_lockstep[lane])
+        {
+            bool crossed_page;
+
+            memory(lane)[addressFor(lane, mode, operand, crossed_page)] = source[lane];
+        }
+    }
+    return true;
+}
+
+void BatchExecutor::branch(uint8_t flag, bool taken_when_set, uint16_t operand)
+{
+    const uint16_t offset = (operand & 0x80) ? (operand | 0xFF00) : operand;
+
+    for (size_t lane = 0; lane < _lanes; ++lane)
+    {
+        if (_lockstep[lane] && (((_status[lane] & flag) != 0) == taken_when_set))
+        {
+            const uint16_t next   = _program_counter[lane];
+            const uint16_t target = next + offset;
+
+            _results[lane].cycles += ((target & 0xFF00) != (next & 0xFF00)) ? 2 : 1;
+            _program_counter[lane] = target;
+        }
+    }
+}
+
+template<typename Kernel>
+void BatchExecutor::apply(Kernel kernel)
+{
+    size_t index = 0;
+
+#if defined(__SSE2__)
+    index = applyKernel<Lanes16>(index, _padded_lanes, _lockstep.data(), _operand.data(),
+                                 _a.data(), _x.data(), _y.data(), _stack_pointer.data(), _status.data(), kernel);
+#endif
+    applyKernel<Lanes1>(index, _padded_lanes, _lockstep.data(), _operand.data(),
+                        _a.data(), _x.data(), _y.data(), _stack_pointer.data(), _status.data(), kernel);
+}
+
+bool BatchExecutor::executeLockstep(const INSTRUCTION &entry, uint16_t operand, uint8_t length)
+{
+    const Operation operation = entry.operate;
+
+#ifndef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+    // Decimal mode is left to the scalar executors.
+    if ((operation == Operation::ADC) || (operation == Operation::SBC))
+    {
+        for (size_t lane = 0; lane < _lanes; ++lane)
+        {
+            if (_lockstep[lane] && (_status[lane] & D))
+                return false;
+        }
+    }
+#endif
+
+    if (readsOperand(operation) && !fetchOperands(entry.addrmode, operand))
+        return false;
+
+    switch (operation)
+    {
+    case Operation::LDA: apply([](auto &r, auto m) { r.a = nz(r, m); }); break;
+    case Operation::LDX: apply([](auto &r, auto m) { r.x = nz(r, m); }); break;
+    case Operation::LDY: apply([](auto &r, auto m) { r.y = nz(r, m); }); break;
+    case Operation::AND: apply([](auto &r, auto m) { r.a = nz(r, r.a & m); }); break;
+    case Operation::ORA: apply([](auto &r, auto m) { r.a = nz(r, r.a | m); }); break;
+    case Operation::EOR: apply([](auto &r, auto m) { r.a = nz(r, r.a ^ m); }); break;
+    case Operation::ADC: apply([](auto &r, auto m) { addWithCarry(r, m); }); break;
+    case Operation::SBC: apply([](auto &r, auto m) { addWithCarry(r, ~m); }); break;
+    case Operation::CMP: apply([](auto &r, auto m) { compare(r, r.a, m); }); break;
+    case Operation::CPX: apply([](auto &r, auto m) { compare(r, r.x, m); }); break;
+    case Operation::CPY: apply([](auto &r, auto m) { compare(r, r.y, m); }); break;
+
+    case Operation::INX: apply([](auto &r, auto m) { r.x = nz(r, r.x + decltype(m)::splat(1)); }); break;
+    case Operation::INY: apply([](auto &r, auto m) { r.y = nz(r, r.y + decltype(m)::splat(1)); }); break;
+    case Operation::DEX: apply([](auto &r, auto m) { r.x = nz(r, r.x - decltype(m)::splat(1)); }); break;
+    case Operation::DEY: apply([](auto &r, auto m) { r.y = nz(r, r.y - decltype(m)::splat(1)); }); break;
+    case Operation::TAX: apply([](auto &r, auto)   { r.x = nz(r, r.a); }); break;
+    case Operation::TAY: apply([](auto &r, auto)   { r.y = nz(r, r.a); }); break;
+    case Operation::TXA: apply([](auto &r, auto)   { r.a = nz(r, r.x); }); break;
+    case Operation::TYA: apply([](auto &r, auto)   { r.a = nz(r, r.y); }); break;
+    case Operation::TSX: apply([](auto &r, auto)   { r.x = nz(r, r.stack_pointer); }); break;
+    case Operation::TXS: apply([](auto &r, auto)   { r.stack_pointer = r.x; }); break;
+
+    case Operation::CLC: apply([](auto &r, auto m) { r.status = r.status & decltype(m)::splat(static_cast<uint8_t>(~C)); }); break;
+    case Operation::CLD: apply([](auto &r, auto m) { r.status = r.status & decltype(m)::splat(static_cast<uint8_t>(~D)); }); break;
+    case Operation::CLI: apply([](auto &r, auto m) { r.status = r.status & decltype(m)::splat(static_cast<uint8_t>(~I)); }); break;
+    case Operation::CLV: apply([](auto &r, auto m) { r.status = r.status & decltype(m)::splat(static_cast<uint8_t>(~V)); }); break;
+    case Operation::SEC: apply([](auto &r, auto m) { r.status = r.status | decltype(m)::splat(C); }); break;
+    case Operation::SED: apply([](auto &r, auto m) { r.status = r.status | decltype(m)::splat(D); }); break;
+    case Operation::SEI: apply([](auto &r, auto m) { r.status = r.status | decltype(m)::splat(I); }); break;
+
+    case Operation::ASL:
+    case Operation::LSR:
+    case Operation::ROL:
+    case Operation::ROR:
+        // Only on the accumulator; shifting memory is left to the scalar executors
+        if (entry.addrmode != AddressingMode::IMP)
+            return false;
+        switch (operation)
+        {
+        case Operation::ASL: apply([](auto &r, auto) { r.status = withCNZ(r.status, isSet(r.a, N), r.a + r.a); r.a = r.a + r.a; }); break;
+        case Operation::LSR: apply([](auto &r, auto) { r.status = withCNZ(r.status, isSet(r.a, C), shiftRight(r.a)); r.a = shiftRight(r.a); }); break;
+        case Operation::ROL:
+            apply([](auto &r, auto m)
+            {
+                const auto rotated = (r.a + r.a) | (r.status & decltype(m)::splat(C));
+
+                r.status = withCNZ(r.status, isSet(r.a, N), rotated);
+                r.a = rotated;
+            });
+            break;
+        default:
+            apply([](auto &r, auto m)
+            {
+                const auto rotated = shiftRight(r.a) | (isSet(r.status, C) & decltype(m)::splat(N));
+
+                r.status = withCNZ(r.status, isSet(r.a, C), rotated);
+                r.a = rotated;
+            });
+            break;
+        }
+        break;
+
+    case Operation::NOP:
+        if (entry.addrmode != AddressingMode::IMP)
+            return false;
+        break;
+
+    case Operation::STA:
+        if (!storeOperands(entry.addrmode, operand, _a))
+            return false;
+        break;
+    case Operation::STX:
+        if (!storeOperands(entry.addrmode, operand, _x))
+            return false;
+        break;
+    case Operation::STY:
+        if (!storeOperands(entry.addrmode, operand, _y))
+            return false;
+        break;
+
+    case Operation::JMP:
+        if (entry.addrmode != AddressingMode::ABS)
+            return false;
+        for (size_t lane = 0; lane < _lanes; ++lane)
+        {
+            if (_lockstep[lane])
+                _program_counter[lane] = operand;
+        }
+        return true;
+
+    case Operation::BCC: case Operation::BCS: case Operation::BEQ: case Operation::BNE:
+    case Operation::BMI: case Operation::BPL: case Operation::BVC: case Operation::BVS:
+        break;
+
+    default:
+        return false;
+    }
+
+    // Go past the instruction, then perhaps branch
+    for (size_t lane = 0; lane < _lanes; ++lane)
+    {
+        if (_lockstep[lane])
+            _program_counter[lane] += length;
+    }
+
+    switch (operation)
+    {
+    case Operation::BCC: branch(C, false, operand); break;
+    case Operation::BCS: branch(C, true,  operand); break;
+    case Operation::BNE: branch(Z, false, operand); break;
+    case Operation::BEQ: branch(Z, true,  operand); break;
+    case Operation::BPL: branch(N, false, operand); break;
+    case Operation::BMI: branch(N, true,  operand); break;
+    case Operation::BVC: branch(V, false, operand); break;
+    case Operation::BVS: branch(V, true,  operand); break;
+    default:
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,108 @@
+#ifndef BATCHEXECUTOR_HPP
+#define BATCHEXECUTOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "instructionexecutor.hpp"
+
+
+/** Runs many independent 6502s at once, in lockstep.
+ *
+ *  Each machine, or lane, has its own registers and 64K of plain memory.
+ *  The registers of all lanes are kept in structure-of-arrays form, one array
+ *  per register, so that an instruction can be carried out for sixteen lanes
+ *  at a time with SSE2 (or one at a time where that is not available).
+ *
+ *  Lanes run in lockstep for as long as they are at the same address and
+ *  their code there is the same.  The common register, flag, load and store
+ *  instructions are executed for all of them together.  The rest are
+ *  executed lane by lane by an InstructionExecutor, so the semantics are the
+ *  same as everywhere else.  A lane whose program counter goes its own way
+ *  after a branch or a return, or whose code differs from the others', drops
+ *  out of lockstep and carries on by itself with its InstructionExecutor.
+ */
+class BatchExecutor
+{
+public:
+    using addressType = uint16_t;
+    using StopReason  = InstructionExecutor::StopReason;
+
+    /** What a run did for one lane.
+     */
+    struct LaneResult
+    {
+        uint64_t   cycles = 0;                ///< Clock cycles consumed
+        uint64_t   instructions = 0;          ///< Instructions executed
+        uint64_t   lockstep_instructions = 0; ///< How many of those were executed in lockstep
+        StopReason reason = StopReason::BudgetSpent;
+    };
+
+    explicit BatchExecutor(size_t lanes);
+    BatchExecutor(const BatchExecutor &) = delete;
+    ~BatchExecutor();
+
+    size_t lanes() const { return _lanes; }
+
+    /** The 64K of memory belonging to a lane.
+     *
+     *  It may be changed freely between runs.
+     */
+    uint8_t *memory(size_t lane) { return &_memory[lane << 16]; }
+
+    /** Copies @p bytes into the memory of every lane, starting at @p address.
+     */
+    void load(addressType address, const std::vector<uint8_t> &bytes);
+
+    Registers registers(size_t lane) const;
+    void      setRegisters(size_t lane, const Registers &registers);
+
+    /** Runs every lane until it has consumed at least @p cycle_budget clock cycles.
+     *
+     *  Only whole instructions are executed.  Like InstructionExecutor::runCycles(),
+     *  a lane stops early in front of a BRK or an illegal opcode, other than
+     *  the one it starts on.
+     */
+    void run(uint64_t cycle_budget);
+
+    /** What the last run did for @p lane.
+     */
+    const LaneResult &result(size_t lane) const { return _results[lane]; }
+
+    BatchExecutor &operator =(const BatchExecutor &) = delete;
+private:
+    size_t _lanes;
+    size_t _padded_lanes; // Rounded up to a whole number of vectors
+
+    // The registers, one array each
+    std::vector<uint8_t>  _a, _x, _y, _stack_pointer, _status;
+    std::vector<uint16_t> _program_counter;
+
+    std::vector<uint8_t>  _lockstep; // 0xFF for the lanes still running in lockstep, 0x00 for the rest
+    std::vector<uint8_t>  _operand;  // The value each lane's instruction operates on
+    std::vector<uint8_t>  _memory;
+    std::vector<LaneResult> _results;
+
+    // Each lane's own interpreter, and the registers it runs with
+    std::vector<Registers> _scalar_registers;
+    std::vector<std::unique_ptr<InstructionExecutor>> _scalar;
+
+    using INSTRUCTION    = InstructionExecutor::INSTRUCTION;
+    using AddressingMode = InstructionExecutor::AddressingMode;
+
+    InstructionExecutor &scalarFor(size_t lane);
+    void                 executeScalar(size_t lane);
+    void                 runScalar(size_t lane, uint64_t cycle_budget);
+
+    // Executes an instruction for every lane in lockstep, or returns false
+    // if it is one left to the scalar executors
+    bool     executeLockstep(const INSTRUCTION &entry, uint16_t operand, uint8_t length);
+    uint16_t addressFor(size_t lane, AddressingMode mode, uint16_t operand, bool &crossed_page) const;
+    bool     fetchOperands(AddressingMode mode, uint16_t operand);
+    bool     storeOperands(AddressingMode mode, uint16_t operand, const std::vector<uint8_t> &source);
+    void     branch(uint8_t flag, bool taken_when_set, uint16_t operand);
+    template<typename Kernel>
+    void     apply(Kernel kernel);
+};
+
+#endif // BATCHEXECUTOR_HPP
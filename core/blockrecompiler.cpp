@@ -0,0 +1,684 @@
+#include "blockrecompiler.hpp"
+#include "instructionexecutor.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__unix__)
+#define BLOCKRECOMPILER_X86_64
+#include <sys/mman.h>
+#endif
+
+
+// Holds the compiled code. The memory is only made writable while a block is
+// being copied in, and is executable the rest of the time.
+class BlockRecompiler::CodeBuffer
+{
+public:
+    static constexpr size_t capacity = 4 * 1024 * 1024;
+
+    CodeBuffer()
+    {
+#ifdef BLOCKRECOMPILER_X86_64
+        void *memory = mmap(nullptr, capacity, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (memory != MAP_FAILED)
+            _memory = static_cast<uint8_t *>(memory);
+#endif
+    }
+
+    ~CodeBuffer()
+    {
+#ifdef BLOCKRECOMPILER_X86_64
+        if (_memory)
+            munmap(_memory, capacity);
+#endif
+    }
+
+    // Copies the code in, returning where it ended up, or nullptr when full
+    void *place(const std::vector<uint8_t> &code)
+    {
+        if (!_memory || (code.size() > capacity - _used))
+            return nullptr;
+
+        uint8_t *destination = _memory + _used;
+
+#ifdef BLOCKRECOMPILER_X86_64
+        if (mprotect(_memory, capacity, PROT_READ | PROT_WRITE) != 0)
+            return nullptr;
+        std::memcpy(destination, code.data(), code.size());
+        if (mprotect(_memory, capacity, PROT_READ | PROT_EXEC) != 0)
+            return nullptr;
+#endif
+        // Keep each block on its own cache line
+        _used += (code.size() + 63) & ~static_cast<size_t>(63);
+        return destination;
+    }
+
+    void clear() { _used = 0; }
+
+private:
+    uint8_t *_memory = nullptr;
+    size_t   _used = 0;
+};
+
+
+namespace
+{
+// Just enough of an x86-64 assembler for what blocks are made of. The
+// executor is kept in rbx, its registers in r13, the cycles consumed in r12,
+// the instructions executed in r14, and the budget for looping in r15.
+class Assembler
+{
+public:
+    using label = size_t;
+
+    std::vector<uint8_t> code;
+
+    label here() const { return code.size(); }
+
+    void prologue()
+    {
+        emit({ 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57 }); // push rbx, r12, r13, r14, r15
+        emit({ 0x48, 0x89, 0xFB });                                     // mov rbx, rdi
+        emit({ 0x49, 0x89, 0xF7 });                                     // mov r15, rsi
+        emit({ 0x45, 0x31, 0xE4 });                                     // xor r12d, r12d
+        emit({ 0x45, 0x31, 0xF6 });                                     // xor r14d, r14d
+    }
+
+    void epilogue()
+    {
+        emit({ 0x4C, 0x89, 0xE0 });                                     // mov rax, r12
+        emit({ 0x4C, 0x89, 0xF2 });                                     // mov rdx, r14
+        emit({ 0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B }); // pop r15, r14, r13, r12, rbx
+        emit({ 0xC3 });                                                 // ret
+    }
+
+    void loadRegistersPointer(const void *registers)
+    {
+        emit({ 0x49, 0xBD });                                           // mov r13, imm64
+        emit64(reinterpret_cast<uint64_t>(registers));
+    }
+
+    // Guest register accesses, [r13 + disp8]
+    void orRegister(uint8_t offset, uint8_t value)          { emit({ 0x41, 0x80, 0x4D, offset, value }); }
+    void andRegister(uint8_t offset, uint8_t value)         { emit({ 0x41, 0x80, 0x65, offset, value }); }
+    void storeRegister(uint8_t offset, uint8_t value)       { emit({ 0x41, 0xC6, 0x45, offset, value }); }
+    void incrementRegister(uint8_t offset)                  { emit({ 0x41, 0xFE, 0x45, offset }); }
+    void decrementRegister(uint8_t offset)                  { emit({ 0x41, 0xFE, 0x4D, offset }); }
+    void testRegister(uint8_t offset, uint8_t value)        { emit({ 0x41, 0xF6, 0x45, offset, value }); }
+    void loadRegisterToAl(uint8_t offset)                   { emit({ 0x41, 0x0F, 0xB6, 0x45, offset }); }
+    void storeAlToRegister(uint8_t offset)                  { emit({ 0x41, 0x88, 0x45, offset }); }
+    void storeWordRegister(uint8_t offset, uint16_t value)
+    {
+        emit({ 0x66, 0x41, 0xC7, 0x45, offset });
+        emit16(value);
+    }
+    void compareWordRegister(uint8_t offset, uint16_t value)
+    {
+        emit({ 0x66, 0x41, 0x81, 0x7D, offset });
+        emit16(value);
+    }
+
+    // Executor member accesses, [rbx + disp32]
+    void storeMember(int32_t offset, uint8_t value)         { emit({ 0xC6, 0x83 }); emit32(offset); emit({ value }); }
+    void orMember(int32_t offset, uint8_t value)            { emit({ 0x80, 0x8B }); emit32(offset); emit({ value }); }
+    void andMember(int32_t offset, uint8_t value)           { emit({ 0x80, 0xA3 }); emit32(offset); emit({ value }); }
+    void compareMember(int32_t offset, uint8_t value)       { emit({ 0x80, 0xBB }); emit32(offset); emit({ value }); }
+    void testMember(int32_t offset, uint8_t value)          { emit({ 0xF6, 0x83 }); emit32(offset); emit({ value }); }
+    void storeAlToMember(int32_t offset)                    { emit({ 0x88, 0x83 }); emit32(offset); }
+    void addMemberToCycles(int32_t offset)
+    {
+        emit({ 0x0F, 0xB6, 0x83 });                                     // movzx eax, byte [rbx + disp32]
+        emit32(offset);
+        emit({ 0x49, 0x01, 0xC4 });                                     // add r12, rax
+    }
+
+    void addCycles(uint8_t cycles)                          { emit({ 0x49, 0x83, 0xC4, cycles }); }
+    void countInstruction()                                 { emit({ 0x49, 0xFF, 0xC6 }); }
+
+    // Calls handler(executor, operand)
+    void callHandler(const void *handler, uint16_t operand)
+    {
+        emit({ 0x48, 0x89, 0xDF });                                     // mov rdi, rbx
+        emit({ 0xBE });                                                 // mov esi, imm32
+        emit32(operand);
+        emit({ 0x48, 0xB8 });                                           // mov rax, imm64
+        emit64(reinterpret_cast<uint64_t>(handler));
+        emit({ 0xFF, 0xD0 });                                           // call rax
+    }
+
+    // Jumps if r12 + cycles > r15
+    label jumpIfOverBudget(uint32_t cycles)
+    {
+        emit({ 0x49, 0x8D, 0x84, 0x24 });                               // lea rax, [r12 + disp32]
+        emit32(cycles);
+        emit({ 0x4C, 0x39, 0xF8 });                                     // cmp rax, r15
+        emit({ 0x0F, 0x87 });                                           // ja rel32
+        return placeholder();
+    }
+
+    // Sets al to 1 if the last comparison or test found equality (or zero), else to 0
+    void setAlIfEqual()                                     { emit({ 0x0F, 0x94, 0xC0 }); }
+    void setAlIfNotEqual()                                  { emit({ 0x0F, 0x95, 0xC0 }); }
+    void testAl()                                           { emit({ 0x84, 0xC0 }); }
+
+    label jumpIfEqual()
+    {
+        emit({ 0x0F, 0x84 });                                           // je rel32
+        return placeholder();
+    }
+
+    label jumpIfNotEqual()
+    {
+        emit({ 0x0F, 0x85 });                                           // jne rel32
+        return placeholder();
+    }
+
+    label jump()
+    {
+        emit({ 0xE9 });                                                 // jmp rel32
+        return placeholder();
+    }
+
+    void jumpTo(label target)
+    {
+        emit({ 0xE9 });                                                 // jmp rel32
+        emit32(static_cast<uint32_t>(target - (here() + 4)));
+    }
+
+    void bind(label jump, label target)
+    {
+        uint32_t relative = static_cast<uint32_t>(target - (jump + 4));
+
+        std::memcpy(&code[jump], &relative, sizeof(relative));
+    }
+
+private:
+    void emit(std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); }
+    void emit16(uint16_t value) { emitValue(value); }
+    void emit32(uint32_t value) { emitValue(value); }
+    void emit64(uint64_t value) { emitValue(value); }
+
+    template<typename T>
+    void emitValue(T value)
+    {
+        uint8_t bytes[sizeof(T)];
+
+        std::memcpy(bytes, &value, sizeof(T));
+        code.insert(code.end(), bytes, bytes + sizeof(T));
+    }
+
+    label placeholder()
+    {
+        label location = here();
+
+        emit32(0);
+        return location;
+    }
+};
+
+using Operation      = InstructionExecutor::Operation;
+using AddressingMode = InstructionExecutor::AddressingMode;
+
+bool endsBlock(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::BCC: case Operation::BCS: case Operation::BEQ: case Operation::BMI:
+    case Operation::BNE: case Operation::BPL: case Operation::BVC: case Operation::BVS:
+    case Operation::JMP: case Operation::JSR: case Operation::RTS: case Operation::RTI:
+    case Operation::BRA:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isBranch(Operation operation)
+{
+    return endsBlock(operation) &&
+           (operation != Operation::JMP) && (operation != Operation::JSR) &&
+           (operation != Operation::RTS) && (operation != Operation::RTI);
+}
+
+// The flag a branch tests, and the value it branches on. Branches on V are
+// left to the interpreter, as V is the awkward one to work out.
+bool branchCondition(Operation operation, FLAGS6502 &flag, bool &value)
+{
+    switch (operation)
+    {
+    case Operation::BCC: flag = C; value = false; return true;
+    case Operation::BCS: flag = C; value = true;  return true;
+    case Operation::BNE: flag = Z; value = false; return true;
+    case Operation::BEQ: flag = Z; value = true;  return true;
+    case Operation::BPL: flag = N; value = false; return true;
+    case Operation::BMI: flag = N; value = true;  return true;
+    default:             return false;
+    }
+}
+}
+
+
+bool BlockRecompiler::available()
+{
+#ifdef BLOCKRECOMPILER_X86_64
+    return true;
+#else
+    return false;
+#endif
+}
+
+BlockRecompiler::BlockRecompiler(InstructionExecutor &executor)
+    :
+    _executor(executor),
+    _code(new CodeBuffer),
+    _entries(new Block *[0x10000]()),
+    _heat(new uint8_t[0x10000]())
+{
+}
+
+BlockRecompiler::~BlockRecompiler()
+{
+}
+
+auto BlockRecompiler::blockAt(addressType address) -> const Block *
+{
+    Block *block = _entries[address];
+
+    if (block)
+        return block;
+
+    uint8_t &heat = _heat[address];
+
+    if ((heat == not_compilable) || (++heat < hot_threshold))
+        return nullptr;
+
+    block = compile(address);
+    if (!block)
+        heat = not_compilable;
+    return block;
+}
+
+auto BlockRecompiler::run(const Block &block, uint64_t loop_budget) -> BlockResult
+{
+    return block.code(&_executor, loop_budget);
+}
+
+void BlockRecompiler::invalidate(addressType address)
+{
+    _heat[address] = 0;
+
+    std::vector<Block *> &blocks = _blocks_by_page[address >> 8];
+
+    for (size_t index = 0; index < blocks.size(); )
+    {
+        Block *block = blocks[index];
+
+        if (static_cast<addressType>(address - block->start) < block->length)
+            forget(block); // Which takes it out of blocks
+        else
+            ++index;
+    }
+}
+
+void BlockRecompiler::invalidate()
+{
+    std::fill(_entries.get(), _entries.get() + 0x10000, nullptr);
+    std::fill(_heat.get(), _heat.get() + 0x10000, 0);
+    for (auto &blocks : _blocks_by_page)
+        blocks.clear();
+    _blocks.clear();
+    _code->clear();
+    _executor._block_exit = 1;
+}
+
+void BlockRecompiler::forget(Block *block)
+{
+    _entries[block->start] = nullptr;
+
+    const unsigned first_page = block->start >> 8;
+    const unsigned last_page  = static_cast<addressType>(block->start + block->length - 1) >> 8;
+
+    for (unsigned page = first_page; ; page = (page + 1) & 0xFF)
+    {
+        auto &blocks = _blocks_by_page[page];
+
+        blocks.erase(std::remove(blocks.begin(), blocks.end(), block), blocks.end());
+        if (page == last_page)
+            break;
+    }
+
+    // Stop it, in case it is the one running.
+    _executor._block_exit = 1;
+
+    _blocks.erase(std::find_if(_blocks.begin(), _blocks.end(),
+                               [block](const std::unique_ptr<Block> &owned) { return owned.get() == block; }));
+}
+
+auto BlockRecompiler::compile(addressType address) -> Block *
+{
+#ifdef BLOCKRECOMPILER_X86_64
+    struct Decoded
+    {
+        addressType address;
+        uint8_t     opcode;
+        uint8_t     length;
+        uint16_t    operand;
+    };
+
+    // Gather the instructions. Only code in plain memory can be read without
+    // side effects, and can be relied upon to only change through writes.
+    std::vector<Decoded> decoded;
+    addressType pc = address;
+    uint32_t    worst_cycles = 0;
+    uint16_t    length = 0;
+
+    while (decoded.size() < max_instructions)
+    {
+        const uint8_t opcode_page = pc >> 8;
+
+        if (!_executor._read_pages[opcode_page])
+            break;
+
+        Decoded instruction { pc, _executor._read_pages[opcode_page][pc & 0xFF], 0, 0 };
+        const auto &entry = _executor.instruction(instruction.opcode);
+
+        // The 65C02's bit branches, WAI and STP are left to the interpreter.
+        if ((entry.operate == Operation::BRK) || (entry.operate == Operation::XXX) ||
+            (entry.operate == Operation::BBR) || (entry.operate == Operation::BBS) ||
+            (entry.operate == Operation::WAI) || (entry.operate == Operation::STP))
+            break;
+
+        instruction.length = _executor.instructionLength(instruction.opcode);
+
+        bool mapped = true;
+
+        for (uint8_t offset = 1; offset < instruction.length; ++offset)
+        {
+            const addressType operand_address = static_cast<addressType>(pc + offset);
+            const uint8_t    *page = _executor._read_pages[operand_address >> 8];
+
+            if (!page)
+            {
+                mapped = false;
+                break;
+            }
+            instruction.operand |= page[operand_address & 0xFF] << (8 * (offset - 1));
+        }
+        if (!mapped)
+            break;
+        if ((entry.addrmode == AddressingMode::REL) && (instruction.operand & 0x80))
+            instruction.operand |= 0xFF00;
+
+        decoded.push_back(instruction);
+
+        // At most a page crossing plus a branch being taken on top
+        worst_cycles += entry.cycles + 2;
+        length += instruction.length;
+        pc += instruction.length;
+
+        if (endsBlock(entry.operate))
+            break;
+    }
+
+    if (decoded.empty())
+        return nullptr;
+
+    // Where things are, relative to the executor or its registers
+    const auto member = [this](const void *field)
+    {
+        return static_cast<int32_t>(static_cast<const char *>(field) - reinterpret_cast<const char *>(&_executor));
+    };
+    const int32_t cycles        = member(&_executor._cycles);
+    const int32_t pending_flags = member(&_executor._pending_flags);
+    const int32_t nz_result     = member(&_executor._nz_result);
+    const int32_t block_exit    = member(&_executor._block_exit);
+    const uint8_t reg_a         = offsetof(Registers, a);
+    const uint8_t reg_x         = offsetof(Registers, x);
+    const uint8_t reg_y         = offsetof(Registers, y);
+    const uint8_t reg_stkp      = offsetof(Registers, stack_pointer);
+    const uint8_t reg_pc        = offsetof(Registers, program_counter);
+    const uint8_t reg_status    = offsetof(Registers, status);
+
+    Assembler assembler;
+    std::vector<Assembler::label> exits;
+
+    assembler.prologue();
+    assembler.loadRegistersPointer(&_executor.registers());
+    assembler.storeMember(block_exit, 0);
+    assembler.orRegister(reg_status, U);
+
+    const Assembler::label body = assembler.here();
+    bool pc_stored = true;
+
+    const auto setNZFromAl = [&]()
+    {
+        assembler.storeAlToMember(nz_result);
+        assembler.orMember(pending_flags, N | Z);
+    };
+    const auto setFlag = [&](FLAGS6502 flag, bool value)
+    {
+        assembler.andMember(pending_flags, static_cast<uint8_t>(~flag));
+        if (value)
+            assembler.orRegister(reg_status, flag);
+        else
+            assembler.andRegister(reg_status, static_cast<uint8_t>(~flag));
+    };
+    const auto transfer = [&](uint8_t from, uint8_t to, bool flags)
+    {
+        assembler.loadRegisterToAl(from);
+        assembler.storeAlToRegister(to);
+        if (flags)
+            setNZFromAl();
+    };
+    const auto step = [&](uint8_t offset, bool increment)
+    {
+        if (increment)
+            assembler.incrementRegister(offset);
+        else
+            assembler.decrementRegister(offset);
+        assembler.loadRegisterToAl(offset);
+        setNZFromAl();
+    };
+    const auto load = [&](uint8_t offset, uint8_t value)
+    {
+        assembler.storeRegister(offset, value);
+        assembler.storeMember(nz_result, value);
+        assembler.orMember(pending_flags, N | Z);
+    };
+
+    // Leaves al holding a flag, working it out from the last result if it is pending
+    const auto flagToAl = [&](FLAGS6502 flag)
+    {
+        Assembler::label from_status = 0;
+
+        if (flag != C)
+        {
+            assembler.testMember(pending_flags, flag);
+            from_status = assembler.jumpIfEqual();
+            if (flag == Z)
+            {
+                assembler.compareMember(nz_result, 0);
+                assembler.setAlIfEqual();
+            }
+            else
+            {
+                assembler.testMember(nz_result, 0x80);
+                assembler.setAlIfNotEqual();
+            }
+
+            const Assembler::label done = assembler.jump();
+
+            assembler.bind(from_status, assembler.here());
+            assembler.testRegister(reg_status, flag);
+            assembler.setAlIfNotEqual();
+            assembler.bind(done, assembler.here());
+        }
+        else
+        {
+            assembler.testRegister(reg_status, flag);
+            assembler.setAlIfNotEqual();
+        }
+    };
+
+    const Decoded &last = decoded.back();
+    const auto    &last_entry = _executor.instruction(last.opcode);
+    FLAGS6502      branch_flag = C;
+    bool           branch_value = false;
+    const bool     native_branch = branchCondition(last_entry.operate, branch_flag, branch_value);
+
+    for (const Decoded &instruction : decoded)
+    {
+        const auto &entry = _executor.instruction(instruction.opcode);
+        const bool  immediate = (entry.addrmode == AddressingMode::IMM);
+        bool        inlined = true;
+
+        if (native_branch && (&instruction == &last))
+            break;
+
+        // The simplest instructions are done right here...
+        switch (entry.operate)
+        {
+        case Operation::INX: step(reg_x, true);  break;
+        case Operation::INY: step(reg_y, true);  break;
+        case Operation::DEX: step(reg_x, false); break;
+        case Operation::DEY: step(reg_y, false); break;
+        case Operation::TAX: transfer(reg_a, reg_x, true); break;
+        case Operation::TAY: transfer(reg_a, reg_y, true); break;
+        case Operation::TXA: transfer(reg_x, reg_a, true); break;
+        case Operation::TYA: transfer(reg_y, reg_a, true); break;
+        case Operation::TSX: transfer(reg_stkp, reg_x, true); break;
+        case Operation::TXS: transfer(reg_x, reg_stkp, false); break;
+        case Operation::CLC: setFlag(C, false); break;
+        case Operation::SEC: setFlag(C, true);  break;
+        case Operation::CLD: setFlag(D, false); break;
+        case Operation::SED: setFlag(D, true);  break;
+        case Operation::CLI: setFlag(I, false); break;
+        case Operation::SEI: setFlag(I, true);  break;
+        case Operation::CLV: setFlag(V, false); break;
+        case Operation::LDA: inlined = immediate; if (inlined) load(reg_a, instruction.operand & 0xFF); break;
+        case Operation::LDX: inlined = immediate; if (inlined) load(reg_x, instruction.operand & 0xFF); break;
+        case Operation::LDY: inlined = immediate; if (inlined) load(reg_y, instruction.operand & 0xFF); break;
+        case Operation::NOP: inlined = (instruction.opcode == 0xEA); break;
+        default:             inlined = false; break;
+        }
+
+        if (inlined)
+        {
+            assembler.addCycles(entry.cycles);
+            assembler.countInstruction();
+            pc_stored = false;
+        }
+        else
+        {
+            // ...and everything else is handed to the interpreter's handler.
+            if (!pc_stored)
+                assembler.storeWordRegister(reg_pc, instruction.address);
+            assembler.callHandler(reinterpret_cast<const void *>(_executor.predecodedHandlerFor(instruction.opcode)),
+                                  instruction.operand);
+            assembler.addMemberToCycles(cycles);
+            assembler.countInstruction();
+            pc_stored = true;
+
+            // The instruction may have written over the code of this block,
+            // and it has run, so it is counted before leaving.
+            assembler.compareMember(block_exit, 0);
+            exits.push_back(assembler.jumpIfNotEqual());
+        }
+    }
+
+    // A loop back to the start of the block goes round again while there is
+    // budget for another whole pass.
+    const addressType next = static_cast<addressType>(last.address + last.length);
+    const addressType target = isBranch(last_entry.operate)
+                               ? static_cast<addressType>(next + last.operand)
+                               : last.operand;
+    const auto loopBack = [&]()
+    {
+        exits.push_back(assembler.jumpIfOverBudget(worst_cycles));
+        assembler.jumpTo(body);
+    };
+
+    if (native_branch)
+    {
+        // Both ways out of the branch are known, and so is whether taking it
+        // crosses a page.
+        flagToAl(branch_flag);
+        assembler.testAl();
+
+        const Assembler::label taken = branch_value ? assembler.jumpIfNotEqual() : assembler.jumpIfEqual();
+
+        assembler.storeWordRegister(reg_pc, next);
+        assembler.addCycles(last_entry.cycles);
+        assembler.countInstruction();
+        exits.push_back(assembler.jump());
+
+        assembler.bind(taken, assembler.here());
+        assembler.storeWordRegister(reg_pc, target);
+        assembler.addCycles(static_cast<uint8_t>(last_entry.cycles + (((target & 0xFF00) != (next & 0xFF00)) ? 2 : 1)));
+        assembler.countInstruction();
+        if (target == address)
+            loopBack();
+    }
+    else
+    {
+        if (!pc_stored)
+            assembler.storeWordRegister(reg_pc, pc);
+
+        if ((isBranch(last_entry.operate) ||
+             ((last_entry.operate == Operation::JMP) && (last_entry.addrmode == AddressingMode::ABS))) &&
+            (target == address))
+        {
+            assembler.compareWordRegister(reg_pc, address);
+            exits.push_back(assembler.jumpIfNotEqual());
+            loopBack();
+        }
+    }
+
+    const Assembler::label exit = assembler.here();
+
+    for (Assembler::label jump : exits)
+        assembler.bind(jump, exit);
+    assembler.storeMember(cycles, 0);
+    assembler.epilogue();
+
+    void *code = _code->place(assembler.code);
+
+    if (!code)
+    {
+        // Out of room, so start over.
+        invalidate();
+        code = _code->place(assembler.code);
+        if (!code)
+            return nullptr;
+    }
+
+    std::unique_ptr<Block> block(new Block);
+
+    block->code         = reinterpret_cast<BlockResult (*)(InstructionExecutor *, uint64_t)>(code);
+    block->start        = address;
+    block->length       = length;
+    block->instructions = static_cast<uint32_t>(decoded.size());
+    block->worst_cycles = worst_cycles;
+
+    _entries[address] = block.get();
+
+    const unsigned first_page = address >> 8;
+    const unsigned last_page  = static_cast<addressType>(address + length - 1) >> 8;
+
+    for (unsigned page = first_page; ; page = (page + 1) & 0xFF)
+    {
+        _blocks_by_page[page].push_back(block.get());
+        if (page == last_page)
+            break;
+    }
+    _executor.markCode(address, static_cast<uint8_t>(length));
+
+    _blocks.push_back(std::move(block));
+    return _blocks.back().get();
+#else
+    (void)address;
+    return nullptr;
+#endif
+}
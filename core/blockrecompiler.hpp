@@ -0,0 +1,100 @@
+#ifndef BLOCKRECOMPILER_HPP
+#define BLOCKRECOMPILER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class InstructionExecutor;
+
+
+/** Translates hot blocks of guest code into native x86-64 code.
+ *
+ *  A block is a run of instructions starting at some address and ending with
+ *  the first branch, jump, subroutine call or return.  Once execution has
+ *  reached the start of a block often enough, it is compiled into a host
+ *  function.  Simple register and flag instructions are translated directly,
+ *  and every other instruction becomes a direct call to the handler the
+ *  executor's predecoded instruction cache uses for it, with the operand
+ *  already in place.  A block that branches back to its own start keeps
+ *  looping inside the host code for as long as the cycle budget allows.
+ *
+ *  Only code in pages mapped to host memory is compiled, so memory mapped
+ *  devices keep going through the interpreter.  BRK and unofficial opcodes
+ *  are never compiled either, so that the executor can stop on them.
+ *
+ *  Compiled code is only available on x86-64 unix systems (see available()).
+ */
+class BlockRecompiler
+{
+public:
+    using addressType = uint16_t;
+
+    /** What running a block did.
+     */
+    struct BlockResult
+    {
+        uint64_t cycles;       ///< Clock cycles consumed, exactly
+        uint64_t instructions; ///< Instructions executed
+    };
+
+    struct Block
+    {
+        BlockResult (*code)(InstructionExecutor *executor, uint64_t loop_budget) = nullptr;
+        addressType start = 0;
+        uint16_t    length = 0;       ///< In bytes of guest code
+        uint32_t    instructions = 0; ///< In a single pass through the block
+        uint32_t    worst_cycles = 0; ///< The most cycles a single pass can take
+    };
+
+    /** Indicates whether compiled code can run on this host.
+     */
+    static bool available();
+
+    explicit BlockRecompiler(InstructionExecutor &executor);
+    BlockRecompiler(const BlockRecompiler &) = delete;
+    ~BlockRecompiler();
+
+    /** Retrieves the block starting at @p address, compiling it once it is hot.
+     *
+     *  @return The compiled block, or @c nullptr if the code should be interpreted
+     */
+    const Block *blockAt(addressType address);
+
+    /** Runs a block.
+     *
+     *  @param block       The block to run
+     *  @param loop_budget The most cycles the block may consume by looping back to its start, or 0 to run it once
+     */
+    BlockResult run(const Block &block, uint64_t loop_budget);
+
+    /** Forgets every block compiled from code at @p address.
+     *
+     *  A block that is running stops after the instruction making the change.
+     */
+    void invalidate(addressType address);
+
+    /** Forgets every compiled block.
+     */
+    void invalidate();
+
+    BlockRecompiler &operator =(const BlockRecompiler &) = delete;
+private:
+    class CodeBuffer;
+
+    static constexpr uint8_t  hot_threshold = 16;   // Visits before a block is compiled
+    static constexpr uint8_t  not_compilable = 0xFF;
+    static constexpr size_t   max_instructions = 32;
+
+    InstructionExecutor        &_executor;
+    std::unique_ptr<CodeBuffer> _code;
+    std::vector<std::unique_ptr<Block>> _blocks;
+    std::unique_ptr<Block *[]>  _entries;           // The block starting at each address, if any
+    std::unique_ptr<uint8_t[]>  _heat;              // How often each address was reached without a block
+    std::vector<Block *>        _blocks_by_page[0x100]; // The blocks covering some part of each page
+
+    Block *compile(addressType address);
+    void   forget(Block *block);
+};
+
+#endif // BLOCKRECOMPILER_HPP
@@ -0,0 +1,56 @@
+#include "busdevice.hpp"
+#include "memorybus.hpp"
+
+
+BusDevice::BusDevice(addressType lower_address,
+                     addressType upper_address,
+                     bool        writable,
+                     bool        readable)
+    :
+    _lower_address_range(lower_address),
+    _upper_address_range(upper_address),
+    _writable(writable),
+    _readable(readable)
+{
+}
+
+BusDevice::~BusDevice()
+{
+    // Don't leave a dangling device in any page map.
+    while (!_buses.empty())
+        _buses.back()->detach(this);
+}
+
+bool BusDevice::handlesAddress(addressType address) const
+{
+    return (address >= _lower_address_range) && (address <= _upper_address_range);
+}
+
+void BusDevice::write(addressType address, uint8_t data)
+{
+    if (handlesAddress(address) && writable())
+        writeImplementation(address, data);
+}
+
+uint8_t BusDevice::read(addressType address, bool read_only)
+{
+    if (handlesAddress(address) && readable())
+        return readImplementation(address, read_only);
+    return 0x00;
+}
+
+const uint8_t *BusDevice::directReadPage(addressType) const
+{
+    return nullptr;
+}
+
+uint8_t *BusDevice::directWritePage(addressType)
+{
+    return nullptr;
+}
+
+void BusDevice::notifyDirectPagesChanged()
+{
+    for (MemoryBus *bus : _buses)
+        bus->directPagesChanged();
+}
@@ -0,0 +1,74 @@
+#ifndef BUSDEVICE_HPP
+#define BUSDEVICE_HPP
+
+#include <cstdint>
+#include <vector>
+
+class MemoryBus;
+
+
+/** Something occupying a range of addresses on a MemoryBus.
+ *
+ *  Devices are attached to a bus with MemoryBus::attach(), and detach
+ *  themselves from every bus they are on when destroyed.
+ */
+class BusDevice
+{
+public:
+    using addressType = uint16_t;
+
+    BusDevice(addressType lower_address,
+              addressType upper_address,
+              bool        writable,
+              bool        readable);
+    BusDevice(const BusDevice &) = delete;
+    virtual ~BusDevice();
+
+    bool writable() const { return _writable; }
+    bool readable() const { return _readable; }
+
+    addressType lowerAddress() const { return _lower_address_range; }
+    addressType upperAddress() const { return _upper_address_range; }
+
+    bool handlesAddress(addressType address) const;
+
+    void    write(addressType address, uint8_t data);
+    uint8_t read(addressType address, bool read_only);
+
+    /** Gives direct access to the memory backing a page of this device.
+     *
+     *  Devices which are nothing more than a block of memory can hand out
+     *  a pointer to the 256 bytes backing a page, so the CPU can access it
+     *  without going through the bus.  Devices whose accesses have side
+     *  effects must return @c nullptr, which is the default.
+     *
+     *  @param page_address The first address of the page
+     *
+     *  @return The memory backing the page, or @c nullptr
+     */
+    ///@{
+    virtual const uint8_t *directReadPage(addressType page_address) const;
+    virtual       uint8_t *directWritePage(addressType page_address);
+    ///@}
+
+    BusDevice &operator =(const BusDevice &) = delete;
+protected:
+    virtual void    writeImplementation(addressType address, uint8_t data) = 0;
+    virtual uint8_t readImplementation(addressType address, bool read_only) = 0;
+
+    /** Tells the buses the device is on that the pointers returned by
+     *  directReadPage() or directWritePage() have changed.
+     */
+    void notifyDirectPagesChanged();
+
+private:
+    friend class MemoryBus;
+
+    addressType _lower_address_range = 0;
+    addressType _upper_address_range = 0;
+    bool        _writable = false;
+    bool        _readable = false;
+    std::vector<MemoryBus *> _buses; // The buses the device is attached to
+};
+
+#endif // BUSDEVICE_HPP
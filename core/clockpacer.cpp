@@ -0,0 +1,99 @@
+#include "clockpacer.hpp"
+
+
+namespace
+{
+// How long the effective frequency is measured over
+constexpr std::chrono::milliseconds measurement_window { 250 };
+}
+
+constexpr double ClockPacer::ntscFrequency;
+
+ClockPacer::ClockPacer(double frequency)
+    :
+    _frequency(frequency)
+{
+    start(clockType::now());
+}
+
+void ClockPacer::setFrequency(double frequency, clockType::time_point now)
+{
+    if (frequency != _frequency)
+    {
+        _frequency = frequency;
+        start(now);
+    }
+}
+
+void ClockPacer::setSpeedMultiplier(double multiplier, clockType::time_point now)
+{
+    if (multiplier != _speed_multiplier)
+    {
+        _speed_multiplier = multiplier;
+        start(now);
+    }
+}
+
+void ClockPacer::setTurbo(bool turbo, clockType::time_point now)
+{
+    if (turbo != _turbo)
+    {
+        _turbo = turbo;
+        start(now);
+    }
+}
+
+void ClockPacer::start(clockType::time_point now)
+{
+    _anchor              = now;
+    _cycles_since_anchor = 0;
+    _window_start        = now;
+    _cycles_in_window    = 0;
+}
+
+uint64_t ClockPacer::cyclesOwed(clockType::time_point now)
+{
+    if (_turbo)
+        return turboBatch();
+
+    const std::chrono::duration<double> elapsed = now - _anchor;
+    const double                        due     = elapsed.count() * rate();
+    const double                        lag     = due - static_cast<double>(_cycles_since_anchor);
+
+    if (lag <= 0.0)
+        return 0;
+
+    const std::chrono::duration<double> maximum_lag = maximumLag();
+    const double                        maximum     = maximum_lag.count() * rate();
+
+    if (lag > maximum)
+    {
+        // Too far behind to catch up; carry on as though it had been kept up with.
+        _anchor              = now - std::chrono::duration_cast<clockType::duration>(maximum_lag);
+        _cycles_since_anchor = 0;
+        return static_cast<uint64_t>(maximum);
+    }
+    return static_cast<uint64_t>(lag);
+}
+
+void ClockPacer::ran(uint64_t cycles, clockType::time_point now)
+{
+    _cycles_since_anchor += cycles;
+    _cycles_in_window    += cycles;
+
+    const std::chrono::duration<double> window = now - _window_start;
+
+    if (window >= measurement_window)
+    {
+        _effective_frequency = static_cast<double>(_cycles_in_window) / window.count();
+        _window_start        = now;
+        _cycles_in_window    = 0;
+    }
+}
+
+auto ClockPacer::dueAt(uint64_t cycles) const -> clockType::time_point
+{
+    const std::chrono::duration<double> due(static_cast<double>(_cycles_since_anchor + cycles) / rate());
+
+    return _anchor + std::chrono::duration_cast<clockType::duration>(due);
+}
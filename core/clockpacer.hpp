@@ -0,0 +1,95 @@
+#ifndef CLOCKPACER_HPP
+#define CLOCKPACER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+
+/** Works out how many cycles a CPU should run to keep up with real time.
+ *
+ *  The pacer is anchored at a moment in time, and counts every cycle run
+ *  since.  What is owed is always worked out from the anchor, rather than
+ *  added up a frame at a time, so rounding and late wake-ups don't drift:
+ *  a frame which ran long is made up for by a shorter one after it.
+ *
+ *  Falling more than @c maximumLag() behind, which happens when the host
+ *  is suspended or can't keep up, drops the cycles owed rather than trying
+ *  to catch up with them all at once.
+ *
+ *  Time is passed in rather than read, so a pacer can be tested without
+ *  waiting for it.
+ */
+class ClockPacer
+{
+public:
+    using clockType = std::chrono::steady_clock;
+
+    static constexpr double ntscFrequency = 1789773.0; ///< The NES's 2A03, in Hz
+
+    /** Creates a pacer.
+     *
+     *  @param frequency The target frequency, in Hz
+     */
+    explicit ClockPacer(double frequency = 1000000.0);
+
+    /** The target frequency, in Hz, before the speed multiplier is applied.
+     */
+    double frequency() const { return _frequency; }
+    void   setFrequency(double frequency, clockType::time_point now);
+
+    /** Scales the target frequency, so 2.0 runs at twice the speed.
+     */
+    double speedMultiplier() const { return _speed_multiplier; }
+    void   setSpeedMultiplier(double multiplier, clockType::time_point now);
+
+    /** Runs as fast as the host can, ignoring the target frequency.
+     */
+    bool turbo() const { return _turbo; }
+    void setTurbo(bool turbo, clockType::time_point now);
+
+    /** How far behind the pacer may fall before it gives up on the cycles owed.
+     */
+    static constexpr std::chrono::milliseconds maximumLag() { return std::chrono::milliseconds(100); }
+
+    /** How many cycles are run in one go in turbo mode.
+     */
+    static constexpr uint64_t turboBatch() { return 100000; }
+
+    /** Re-anchors the pacer at @p now, owing nothing.
+     */
+    void start(clockType::time_point now);
+
+    /** How many cycles should be run now to catch up with real time.
+     */
+    uint64_t cyclesOwed(clockType::time_point now);
+
+    /** Records that @p cycles were run, which may be more than were owed.
+     */
+    void ran(uint64_t cycles, clockType::time_point now);
+
+    /** When real time will have caught up with @p cycles more than have been run.
+     *
+     *  A CPU with nothing to do until then can sleep until this moment.
+     */
+    clockType::time_point dueAt(uint64_t cycles) const;
+
+    /** The frequency actually achieved, in Hz, measured over the last fraction of a second.
+     */
+    double effectiveFrequency() const { return _effective_frequency; }
+
+private:
+    double                _frequency;
+    double                _speed_multiplier = 1.0;
+    bool                  _turbo            = false;
+
+    clockType::time_point _anchor;
+    uint64_t              _cycles_since_anchor = 0;
+
+    clockType::time_point _window_start;
+    uint64_t              _cycles_in_window    = 0;
+    double                _effective_frequency = 0.0;
+
+    double rate() const { return _frequency * _speed_multiplier; }
+};
+
+#endif // CLOCKPACER_HPP
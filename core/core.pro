@@ -0,0 +1,68 @@
+TEMPLATE = lib
+CONFIG += staticlib
+
+CONFIG += c++14
+CONFIG += thread
+CONFIG -= qt
+
+# Everything here is plain C++, so it can be used without Qt: headless batch
+# runs, benchmarks and tools link against this library alone.
+
+# InstructionExecutor normally dispatches opcodes through its lookup table of
+# member function pointers. Uncomment the following line to dispatch through a
+# switch over handlers specialised for each opcode at compile time instead.
+#DEFINES += INSTRUCTIONEXECUTOR_SWITCH_DISPATCH
+
+# Uncomment the following line to have InstructionExecutor start out running
+# from its cache of predecoded instructions (see InstructionExecutor::setPredecode).
+#DEFINES += INSTRUCTIONEXECUTOR_PREDECODE
+
+# ADC and SBC follow the D flag, except on the NES's 2A03 (see
+# InstructionExecutor::setInstructionSet). Uncomment the following line to
+# leave decimal mode out of every instruction set, where the flag can still
+# be set and cleared but does nothing.
+#DEFINES += INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+
+SOURCES += \
+    batchexecutor.cpp \
+    blockrecompiler.cpp \
+    busdevice.cpp \
+    clockpacer.cpp \
+    decimalmode.cpp \
+    emulationthread.cpp \
+    eventscheduler.cpp \
+    fleetrunner.cpp \
+    inputjournal.cpp \
+    instructionexecutor.cpp \
+    machine.cpp \
+    memorybus.cpp \
+    pagedmemory.cpp \
+    ramdevice.cpp \
+    recompiledrunner.cpp \
+    rewindbuffer.cpp \
+    staticrecompiler.cpp
+
+HEADERS += \
+    batchexecutor.hpp \
+    blockrecompiler.hpp \
+    busdevice.hpp \
+    clockpacer.hpp \
+    decimalmode.hpp \
+    emulationthread.hpp \
+    eventscheduler.hpp \
+    flags.hpp \
+    fleetrunner.hpp \
+    inputjournal.hpp \
+    instructionexecutor.hpp \
+    instructions.hpp \
+    machine.hpp \
+    memorybus.hpp \
+    opcodes.hpp \
+    pagedmemory.hpp \
+    ramdevice.hpp \
+    recompiledcode.hpp \
+    recompiledrunner.hpp \
+    registers.hpp \
+    rewindbuffer.hpp \
+    spscqueue.hpp \
+    staticrecompiler.hpp
@@ -0,0 +1,136 @@
+#include "decimalmode.hpp"
+#include "flags.hpp"
+#include <memory>
+
+
+namespace
+{
+constexpr size_t table_size = 2 * 0x100 * 0x100;
+
+size_t indexOf(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    return (static_cast<size_t>(carry) << 16) | (static_cast<size_t>(accumulator) << 8) | operand;
+}
+
+uint8_t statusOf(bool carry, bool zero, bool overflow, bool negative)
+{
+    return static_cast<uint8_t>((carry ? C : 0) | (zero ? Z : 0) | (overflow ? V : 0) | (negative ? N : 0));
+}
+
+DecimalResult add(int accumulator, int operand, int carry)
+{
+    // The low digit is adjusted first, carrying into the high one.
+    int low = (accumulator & 0x0F) + (operand & 0x0F) + carry;
+
+    if (low >= 0x0A)
+        low = ((low + 0x06) & 0x0F) + 0x10;
+
+    int sum = (accumulator & 0xF0) + (operand & 0xF0) + low;
+
+    // N and V are taken here, treating the high digits as signed, before
+    // the high digit is adjusted.
+    const int  signed_sum = static_cast<int8_t>(accumulator & 0xF0) + static_cast<int8_t>(operand & 0xF0) + low;
+    const bool negative   = (sum & 0x80) != 0;
+    const bool overflow   = (signed_sum < -128) || (signed_sum > 127);
+
+    // Z ignores the adjustments altogether.
+    const bool zero = ((accumulator + operand + carry) & 0xFF) == 0;
+
+    if (sum >= 0xA0)
+        sum += 0x60;
+    return { static_cast<uint8_t>(sum & 0xFF), statusOf(sum >= 0x100, zero, overflow, negative) };
+}
+
+DecimalResult subtract(int accumulator, int operand, int carry)
+{
+    // The flags are the binary ones.
+    const int     difference = accumulator - operand - (1 - carry);
+    const bool    overflow   = ((accumulator ^ operand) & (accumulator ^ difference) & 0x80) != 0;
+    const uint8_t status     = statusOf(difference >= 0, (difference & 0xFF) == 0, overflow, (difference & 0x80) != 0);
+
+    int low = (accumulator & 0x0F) - (operand & 0x0F) + carry - 1;
+
+    if (low < 0)
+        low = ((low - 0x06) & 0x0F) - 0x10;
+
+    int result = (accumulator & 0xF0) - (operand & 0xF0) + low;
+
+    if (result < 0)
+        result -= 0x60;
+    return { static_cast<uint8_t>(result & 0xFF), status };
+}
+
+// The 65C02 adds the same way, but N and Z are right.
+DecimalResult add65C02(int accumulator, int operand, int carry)
+{
+    DecimalResult result = add(accumulator, operand, carry);
+
+    result.status = static_cast<uint8_t>((result.status & (C | V)) | ((result.value == 0) ? Z : 0) | (result.value & N));
+    return result;
+}
+
+// It subtracts differently for operands which aren't valid BCD, adjusting the
+// whole difference rather than digit by digit, and N and Z are right too.
+DecimalResult subtract65C02(int accumulator, int operand, int carry)
+{
+    const int     difference = accumulator - operand - (1 - carry);
+    const bool    overflow   = ((accumulator ^ operand) & (accumulator ^ difference) & 0x80) != 0;
+    const int     low        = (accumulator & 0x0F) - (operand & 0x0F) + carry - 1;
+    int           result     = difference;
+
+    if (result < 0)
+        result -= 0x60;
+    if (low < 0)
+        result -= 0x06;
+
+    const uint8_t value = static_cast<uint8_t>(result & 0xFF);
+
+    return { value, statusOf(difference >= 0, value == 0, overflow, (value & 0x80) != 0) };
+}
+
+std::unique_ptr<DecimalResult[]> makeTable(DecimalResult (*operation)(int, int, int))
+{
+    std::unique_ptr<DecimalResult[]> table(new DecimalResult[table_size]);
+
+    for (int carry = 0; carry < 2; ++carry)
+    {
+        for (int accumulator = 0; accumulator < 0x100; ++accumulator)
+        {
+            for (int operand = 0; operand < 0x100; ++operand)
+            {
+                table[indexOf(static_cast<uint8_t>(accumulator), static_cast<uint8_t>(operand), carry != 0)] =
+                    operation(accumulator, operand, carry);
+            }
+        }
+    }
+    return table;
+}
+}
+
+const DecimalResult &decimalAdd(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    static const std::unique_ptr<DecimalResult[]> table = makeTable(add);
+
+    return table[indexOf(accumulator, operand, carry)];
+}
+
+const DecimalResult &decimalSubtract(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    static const std::unique_ptr<DecimalResult[]> table = makeTable(subtract);
+
+    return table[indexOf(accumulator, operand, carry)];
+}
+
+const DecimalResult &decimalAdd65C02(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    static const std::unique_ptr<DecimalResult[]> table = makeTable(add65C02);
+
+    return table[indexOf(accumulator, operand, carry)];
+}
+
+const DecimalResult &decimalSubtract65C02(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    static const std::unique_ptr<DecimalResult[]> table = makeTable(subtract65C02);
+
+    return table[indexOf(accumulator, operand, carry)];
+}
@@ -0,0 +1,41 @@
+#ifndef DECIMALMODE_HPP
+#define DECIMALMODE_HPP
+
+#include <cstdint>
+
+
+/** What ADC or SBC does to the accumulator and the flags in decimal mode.
+ */
+struct DecimalResult
+{
+    uint8_t value;  ///< The new accumulator
+    uint8_t status; ///< The C, Z, V and N flags, where they are in the status register
+};
+
+/** Binary coded decimal addition and subtraction, as the NMOS 6502 does them.
+ *
+ *  Every combination of accumulator, operand and carry is worked out once,
+ *  the first time either is called, into a table of 128K results each, so
+ *  an ADC or SBC with the D flag set is a single look up.  Binary mode never
+ *  goes near them.
+ *
+ *  The results are exact for any operands, including ones which aren't
+ *  valid BCD.  The flags are as undocumented as the real thing: after an
+ *  ADC, Z comes from the binary sum while N and V come from the sum with
+ *  only its low digit adjusted, and SBC sets all four exactly as it would
+ *  in binary.
+ */
+const DecimalResult &decimalAdd(uint8_t accumulator, uint8_t operand, bool carry);
+const DecimalResult &decimalSubtract(uint8_t accumulator, uint8_t operand, bool carry);
+
+/** The same, as the 65C02 does them.
+ *
+ *  The results are the same as the NMOS 6502's for valid BCD, except that
+ *  N and Z are set from the result.  SBC adjusts the whole difference, not
+ *  each digit, so operands which aren't valid BCD come out differently.
+ *  The tables are built separately, only if a 65C02 ever uses them.
+ */
+const DecimalResult &decimalAdd65C02(uint8_t accumulator, uint8_t operand, bool carry);
+const DecimalResult &decimalSubtract65C02(uint8_t accumulator, uint8_t operand, bool carry);
+
+#endif // DECIMALMODE_HPP
@@ -0,0 +1,226 @@
+#include "emulationthread.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+// How often the emulation looks for commands while it has nothing else to do
+constexpr std::chrono::milliseconds poll_interval { 1 };
+
+// The longest an idle guest sleeps for, so commands are still seen within a frame
+constexpr std::chrono::milliseconds idle_interval { 16 };
+
+// The cycles between checkpoints, which is a tenth of a second at 1 MHz, and
+// the bytes they may take up
+constexpr uint64_t rewind_interval = 100000;
+constexpr size_t   rewind_budget   = 16 * 1024 * 1024;
+
+bool sameRegisters(const Registers &lhs, const Registers &rhs)
+{
+    return (lhs.a == rhs.a) &&
+           (lhs.x == rhs.x) &&
+           (lhs.y == rhs.y) &&
+           (lhs.stack_pointer == rhs.stack_pointer) &&
+           (lhs.program_counter == rhs.program_counter) &&
+           (lhs.status == rhs.status);
+}
+}
+
+EmulationThread::EmulationThread()
+    :
+    _rewind(rewind_interval, rewind_budget)
+{
+    _machine.executor().setScheduler(&_scheduler);
+    _rewind.capture(_machine);
+    _thread = std::thread([this]() { run(); });
+}
+
+EmulationThread::~EmulationThread()
+{
+    while (!post({ Command::Type::Quit }))
+        std::this_thread::yield();
+    _thread.join();
+}
+
+bool EmulationThread::readSnapshot(const readerType &reader)
+{
+    if (!_snapshot_ready.load(std::memory_order_acquire))
+        return false;
+
+    reader(_snapshot);
+    _snapshot_ready.store(false, std::memory_order_release);
+    return true;
+}
+
+bool EmulationThread::valid(const Command &command)
+{
+    if ((command.type == Command::Type::RaiseIrq) || (command.type == Command::Type::LowerIrq))
+        return command.value < InstructionExecutor::numberOfIrqSources();
+    return true;
+}
+
+void EmulationThread::run()
+{
+    while (true)
+    {
+        Command command;
+
+        while (_commands.pop(command))
+            execute(command);
+        if (_quit)
+            return;
+
+        if (_running)
+            runOwedCycles();
+        publish();
+
+        // Turbo doesn't wait for anything, but everything else only wakes
+        // up often enough to be responsive.
+        if (_running && _idle)
+            waitWhileIdle();
+        else if (!_running || !_pacer.turbo())
+            std::this_thread::sleep_for(poll_interval);
+    }
+}
+
+void EmulationThread::execute(const Command &command)
+{
+    switch (command.type)
+    {
+    case Command::Type::Start:
+        if (!_running)
+            _pacer.start(clockType::now());
+        _running = true;
+        break;
+    case Command::Type::Stop:
+        _running = false;
+        break;
+    case Command::Type::Step:
+        _machine.executor().clock();
+        if (_machine.executor().clock_ticks >= _rewind.newest() + _rewind.interval())
+            _rewind.capture(_machine);
+        break;
+    case Command::Type::StepBack:
+        _rewind.stepBack(_machine, 1);
+        break;
+    case Command::Type::Poke:
+        _machine.poke(command.address, command.value);
+        _rewind.capture(_machine);
+        break;
+    case Command::Type::Reset:
+        _machine.executor().reset();
+        _rewind.capture(_machine);
+        break;
+    case Command::Type::RaiseIrq:
+        _machine.executor().raiseIrq(command.value);
+        _rewind.capture(_machine);
+        break;
+    case Command::Type::LowerIrq:
+        _machine.executor().lowerIrq(command.value);
+        _rewind.capture(_machine);
+        break;
+    case Command::Type::Nmi:
+        _machine.executor().raiseNmi();
+        _rewind.capture(_machine);
+        break;
+    case Command::Type::Quit:
+        _quit = true;
+        break;
+    }
+}
+
+void EmulationThread::runOwedCycles()
+{
+    auto now = clockType::now();
+
+    _pacer.setFrequency(_frequency.load(std::memory_order_relaxed), now);
+    _pacer.setSpeedMultiplier(_speed_multiplier.load(std::memory_order_relaxed), now);
+    _pacer.setTurbo(_turbo.load(std::memory_order_relaxed), now);
+
+    uint64_t owed = _pacer.cyclesOwed(now);
+    uint64_t ran  = 0;
+
+    // Turbo jumps a spinning guest straight to whatever it's waiting for.
+    if (_idle && _pacer.turbo() && !_scheduler.empty())
+        owed = std::max(owed, _scheduler.nextEventCycle() - std::min(_scheduler.nextEventCycle(), _machine.executor().clock_ticks));
+
+    // A run never stops on the instruction it starts with, so even a BRK
+    // in the way is stepped over by the next one.
+    _idle = false;
+    while (ran < owed)
+    {
+        auto result = _rewind.run(_machine, owed - ran);
+
+        ran  += result.cycles;
+        _idle = result.idle;
+    }
+    _pacer.ran(ran, clockType::now());
+}
+
+// Nothing happens in an idle guest until the next event, or a command, so
+// there's no point waking up before one of them is due.
+void EmulationThread::waitWhileIdle()
+{
+    auto wake = clockType::now() + idle_interval;
+
+    if (_pacer.turbo())
+    {
+        if (!_scheduler.empty())
+            return;
+        wake = clockType::now() + poll_interval;
+    }
+    else if (!_scheduler.empty() && (_scheduler.nextEventCycle() > _machine.executor().clock_ticks))
+        wake = std::min(wake, _pacer.dueAt(_scheduler.nextEventCycle() - _machine.executor().clock_ticks));
+
+    std::this_thread::sleep_until(wake);
+}
+
+// The snapshot's memory is always what the reader saw last, so comparing
+// against it finds exactly the pages the reader needs to hear about.
+void EmulationThread::publish()
+{
+    if (_snapshot_ready.load(std::memory_order_acquire))
+        return;
+
+    const double     effective_frequency = _running ? _pacer.effectiveFrequency() : 0.0;
+    const Registers &registers           = _machine.registers();
+    const uint64_t   clock_ticks         = _machine.executor().clock_ticks;
+
+    bool changed = !sameRegisters(_snapshot.registers, registers) ||
+                   (_snapshot.clock_ticks != clock_ticks)          ||
+                   (_snapshot.running != _running)                 ||
+                   (_snapshot.effective_frequency != effective_frequency);
+
+    // A page still shared with the memory last published can't have been
+    // written since, so only the pages which were are compared.
+    const PagedMemory &memory = _machine.memory();
+
+    _snapshot.dirty_pages.reset();
+    for (size_t index = 0; index < PagedMemory::numberOfPages(); ++index)
+    {
+        const uint8_t page = static_cast<uint8_t>(index);
+
+        if (memory.samePage(_published, page))
+            continue;
+
+        uint8_t       *published = _snapshot.memory.data() + index * PagedMemory::pageSize();
+        const uint8_t *current   = memory.readPage(page);
+
+        if (std::memcmp(published, current, PagedMemory::pageSize()) == 0)
+            continue;
+        std::memcpy(published, current, PagedMemory::pageSize());
+        _snapshot.dirty_pages.set(page);
+        changed = true;
+    }
+    _published = memory;
+
+    if (changed)
+    {
+        _snapshot.registers           = registers;
+        _snapshot.clock_ticks         = clock_ticks;
+        _snapshot.running             = _running;
+        _snapshot.effective_frequency = effective_frequency;
+        _snapshot_ready.store(true, std::memory_order_release);
+    }
+}
@@ -0,0 +1,165 @@
+#ifndef EMULATIONTHREAD_HPP
+#define EMULATIONTHREAD_HPP
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include "clockpacer.hpp"
+#include "eventscheduler.hpp"
+#include "machine.hpp"
+#include "pagedmemory.hpp"
+#include "rewindbuffer.hpp"
+#include "spscqueue.hpp"
+
+
+/** What the emulation looked like when it was last published.
+ */
+struct EmulationSnapshot
+{
+    using pagesType = std::bitset<0x100>;
+
+    using memoryType = std::array<uint8_t, 0x10000>;
+
+    Registers  registers;
+    uint64_t   clock_ticks         = 0;
+    bool       running             = false;
+    double     effective_frequency = 0.0; ///< In Hz, as measured by the ClockPacer
+    memoryType memory {};       ///< The whole address space, as the CPU sees it
+    pagesType  dirty_pages;     ///< The pages of @c memory which changed since the previous snapshot
+};
+
+/** A Machine, running on a thread of its own.
+ *
+ *  Nothing is shared with the thread which owns this object but two
+ *  lock-free hand-offs.  Commands go to the emulation through an SpscQueue,
+ *  and the emulation publishes an EmulationSnapshot whenever the previous
+ *  one has been read and something has changed since.  Neither side ever
+ *  waits for the other, so a slow reader only sees fewer snapshots, and a
+ *  busy emulation doesn't hold up the reader.
+ *
+ *  While running, the thread wakes about once a millisecond, and runs
+ *  however many cycles a ClockPacer says it owes in one batch.
+ *
+ *  A RewindBuffer keeps checkpoints of the machine as it goes, so it can
+ *  be stepped backwards as well as forwards.  A checkpoint is also taken
+ *  after every command which changes the machine from outside, so going
+ *  back never loses a poke, a reset or an interrupt from before the cycle
+ *  it goes back to.
+ */
+class EmulationThread
+{
+public:
+    using addressType = uint16_t;
+    using clockType   = std::chrono::steady_clock;
+    using readerType  = std::function<void (const EmulationSnapshot &)>;
+
+    /** Everything which can be asked of the emulation.
+     */
+    struct Command
+    {
+        enum class Type : uint8_t
+        {
+            Start,    ///< Start running the CPU in real time
+            Stop,     ///< Stop running it
+            Step,     ///< Execute one clock cycle
+            StepBack, ///< Go back one clock cycle, to how the machine was then
+            Poke,     ///< Write @c value to @c address
+            Reset,    ///< Reset the CPU
+            RaiseIrq, ///< Hold the IRQ line on behalf of source @c value
+            LowerIrq, ///< Let go of the IRQ line on behalf of source @c value
+            Nmi,      ///< Latch a non-maskable interrupt
+            Quit      ///< Finish the thread
+        };
+
+        Type        type    = Type::Stop;
+        addressType address = 0;
+        uint8_t     value   = 0;
+    };
+
+    /** Starts the thread, with the CPU stopped and memory cleared.
+     */
+    EmulationThread();
+    EmulationThread(const EmulationThread &) = delete;
+    ~EmulationThread();
+
+    /** Queues a command for the emulation.
+     *
+     *  @return false if the queue is full, or the command names an IRQ
+     *          source the CPU doesn't have, and the command was dropped
+     */
+    bool post(const Command &command) { return valid(command) && _commands.push(command); }
+
+    /** Conveniences for posting each command.
+     */
+    ///@{
+    bool start()                                  { return post({ Command::Type::Start }); }
+    bool stop()                                   { return post({ Command::Type::Stop }); }
+    bool step()                                   { return post({ Command::Type::Step }); }
+    bool stepBack()                               { return post({ Command::Type::StepBack }); }
+    bool poke(addressType address, uint8_t value) { return post({ Command::Type::Poke, address, value }); }
+    bool reset()                                  { return post({ Command::Type::Reset }); }
+    bool raiseIrq(uint8_t source = 0)             { return post({ Command::Type::RaiseIrq, 0, source }); }
+    bool lowerIrq(uint8_t source = 0)             { return post({ Command::Type::LowerIrq, 0, source }); }
+    bool nmi()                                    { return post({ Command::Type::Nmi }); }
+    ///@}
+
+    /** Sets how fast the CPU runs.
+     *
+     *  These take effect at the next batch.
+     *
+     *  @see ClockPacer
+     */
+    ///@{
+    void setFrequency(double frequency)        { _frequency.store(frequency, std::memory_order_relaxed); }
+    void setSpeedMultiplier(double multiplier) { _speed_multiplier.store(multiplier, std::memory_order_relaxed); }
+    void setTurbo(bool turbo)                  { _turbo.store(turbo, std::memory_order_relaxed); }
+    ///@}
+
+    /** Hands the latest snapshot to @p reader, if one has been published since the last call.
+     *
+     *  The snapshot is only valid during the call.  Its @c dirty_pages are
+     *  relative to the snapshot handed out before, so copying just those
+     *  pages keeps a copy of memory up to date.
+     *
+     *  @return Whether there was a snapshot to read
+     */
+    bool readSnapshot(const readerType &reader);
+
+    EmulationThread &operator =(const EmulationThread &) = delete;
+private:
+    Machine             _machine;
+    RewindBuffer        _rewind;
+    EventScheduler      _scheduler;
+    bool                _running = false;
+    bool                _idle    = false; // The guest is spinning until the next event
+
+    ClockPacer          _pacer;
+    std::atomic<double> _frequency        { 1000000.0 };
+    std::atomic<double> _speed_multiplier { 1.0 };
+    std::atomic<bool>   _turbo            { false };
+
+    SpscQueue<Command, 256> _commands;
+
+    // The snapshot belongs to the emulation while _snapshot_ready is false,
+    // and to the reader while it is true.
+    EmulationSnapshot _snapshot;
+    std::atomic<bool> _snapshot_ready { false };
+    PagedMemory       _published; // Shares the pages of _snapshot.memory which haven't been written since
+
+    bool                _quit = false;
+    std::thread         _thread;
+
+    static bool valid(const Command &command);
+
+    void run();
+    void execute(const Command &command);
+    void runOwedCycles();
+    void waitWhileIdle();
+    void publish();
+};
+
+#endif // EMULATIONTHREAD_HPP
@@ -0,0 +1,61 @@
+#include "eventscheduler.hpp"
+#include <algorithm>
+
+
+auto EventScheduler::schedule(cycleType cycle, actionType action) -> idType
+{
+    const idType id = _next_id++;
+
+    _events.push_back({ cycle, id, std::move(action) });
+    std::push_heap(std::begin(_events), std::end(_events), Later());
+    return id;
+}
+
+// Cancelled events are left where they are in the heap, and only dropped
+// once they reach the front of it, which saves rebuilding the heap.
+void EventScheduler::cancel(idType id)
+{
+    auto event = std::find_if(std::begin(_events), std::end(_events),
+                              [id](const Event &event) { return event.id == id; });
+
+    if (event == std::end(_events))
+        return;
+    _cancelled.insert(id);
+    discardCancelled();
+}
+
+void EventScheduler::clear()
+{
+    _events.clear();
+    _cancelled.clear();
+}
+
+size_t EventScheduler::runDue(cycleType now)
+{
+    size_t run = 0;
+
+    while (!_events.empty() && (_events.front().cycle <= now))
+    {
+        std::pop_heap(std::begin(_events), std::end(_events), Later());
+
+        Event event = std::move(_events.back());
+
+        _events.pop_back();
+        discardCancelled();
+
+        // The action may schedule more events, so the heap must be sound by now.
+        event.action(event.cycle);
+        ++run;
+    }
+    return run;
+}
+
+void EventScheduler::discardCancelled()
+{
+    while (!_events.empty() && (_cancelled.count(_events.front().id) > 0))
+    {
+        _cancelled.erase(_events.front().id);
+        std::pop_heap(std::begin(_events), std::end(_events), Later());
+        _events.pop_back();
+    }
+}
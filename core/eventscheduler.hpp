@@ -0,0 +1,82 @@
+#ifndef EVENTSCHEDULER_HPP
+#define EVENTSCHEDULER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+
+/** Things which are due to happen at a given cycle of the master clock.
+ *
+ *  Devices post events, such as "raise IRQ at cycle T" or "timer expires
+ *  at T", instead of being polled every cycle.  The events are kept in a
+ *  min-heap, so the next one due is always at hand, and the CPU can run
+ *  flat out until then.
+ *
+ *  Events due at the same cycle run in the order they were scheduled.  An
+ *  event may schedule or cancel others, including itself again.
+ *
+ *  @see InstructionExecutor::setScheduler
+ */
+class EventScheduler
+{
+public:
+    using cycleType  = uint64_t;
+    using idType     = uint64_t;
+    using actionType = std::function<void (cycleType cycle)>; ///< Given the cycle the event was scheduled for
+
+    static constexpr cycleType never() { return UINT64_MAX; }
+
+    /** Schedules @p action to run at @p cycle.
+     *
+     *  @return An id which can be passed to @c cancel()
+     */
+    idType schedule(cycleType cycle, actionType action);
+
+    /** Stops a scheduled event from running.  It does nothing if the event has already run.
+     */
+    void cancel(idType id);
+
+    /** Cancels every event.
+     */
+    void clear();
+
+    /** The cycle the next event is due at, or @c never() if there is none.
+     */
+    cycleType nextEventCycle() const { return _events.empty() ? never() : _events.front().cycle; }
+
+    bool empty() const { return _events.empty(); }
+
+    /** Runs every event due at or before @p now, earliest first.
+     *
+     *  @return How many events were run
+     */
+    size_t runDue(cycleType now);
+
+private:
+    struct Event
+    {
+        cycleType  cycle;
+        idType     id; // Also the order they were scheduled in
+        actionType action;
+    };
+
+    // Makes std::push_heap() and friends keep the earliest event at the front
+    struct Later
+    {
+        bool operator ()(const Event &lhs, const Event &rhs) const
+        {
+            return (lhs.cycle != rhs.cycle) ? (lhs.cycle > rhs.cycle) : (lhs.id > rhs.id);
+        }
+    };
+
+    std::vector<Event>         _events;
+    std::unordered_set<idType> _cancelled;
+    idType                     _next_id = 1;
+
+    void discardCancelled();
+};
+
+#endif // EVENTSCHEDULER_HPP
@@ -8,7 +8,7 @@ enum FLAGS6502 : uint8_t
     C = (1 << 0),	// Carry Bit
     Z = (1 << 1),	// Zero
     I = (1 << 2),	// Disable Interrupts
-    D = (1 << 3),	// Decimal Mode (unused in this implementation)
+    D = (1 << 3),	// Decimal Mode (for ADC and SBC, except on the 2A03 or when built with INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE)
     B = (1 << 4),	// Break
     U = (1 << 5),	// Unused
     V = (1 << 6),	// Overflow
@@ -0,0 +1,113 @@
+#include "fleetrunner.hpp"
+#include "machine.hpp"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+
+namespace
+{
+// The jobs dealt to one worker. The owner takes from the back, thieves
+// from the front, so they only meet over the last job.
+class WorkQueue
+{
+public:
+    void push(size_t job) { _jobs.push_back(job); }
+
+    bool take(size_t &job)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_jobs.empty())
+            return false;
+        job = _jobs.back();
+        _jobs.pop_back();
+        return true;
+    }
+
+    bool steal(size_t &job)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_jobs.empty())
+            return false;
+        job = _jobs.front();
+        _jobs.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex         _mutex;
+    std::deque<size_t> _jobs;
+};
+}
+
+FleetRunner::FleetRunner(unsigned threads)
+    :
+    _threads(threads ? threads : std::max(1U, std::thread::hardware_concurrency()))
+{
+}
+
+std::vector<FleetResult> FleetRunner::run(const std::vector<FleetJob> &jobs) const
+{
+    std::vector<FleetResult> results(jobs.size());
+    const size_t             workers = std::min<size_t>(_threads, jobs.size());
+
+    if (workers == 0)
+        return results;
+
+    // Each worker starts with a contiguous share, in order
+    std::vector<WorkQueue> queues(workers);
+
+    for (size_t job = jobs.size(); job-- > 0; )
+        queues[job * workers / jobs.size()].push(job);
+
+    const auto work = [&](size_t worker)
+    {
+        Machine machine;
+        size_t  job;
+
+        while (true)
+        {
+            bool found = queues[worker].take(job);
+
+            for (size_t other = 1; !found && (other < workers); ++other)
+                found = queues[(worker + other) % workers].steal(job);
+            if (!found)
+                return;
+
+            // Every job has a result of its own, so writing it needs no lock.
+            results[job] = runJob(machine, jobs[job]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    for (size_t worker = 1; worker < workers; ++worker)
+        threads.emplace_back(work, worker);
+    work(0);
+    for (auto &thread : threads)
+        thread.join();
+    return results;
+}
+
+FleetResult FleetRunner::runJob(Machine &machine, const FleetJob &job)
+{
+    FleetResult result;
+
+    machine.clear();
+    if (job.image)
+        machine.load(job.load_address, *job.image);
+    machine.load(job.input_address, job.input);
+    machine.start(job.entry_point);
+
+    const Machine::RunResult run = machine.run(job.cycle_budget);
+
+    result.registers     = machine.registers();
+    result.cycles        = run.cycles;
+    result.instructions  = run.instructions;
+    result.reason        = run.reason;
+    result.memory_digest = machine.memoryDigest();
+    return result;
+}
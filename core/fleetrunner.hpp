@@ -0,0 +1,69 @@
+#ifndef FLEETRUNNER_HPP
+#define FLEETRUNNER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "instructionexecutor.hpp"
+
+class Machine;
+
+
+/** One program to run, and how.
+ */
+struct FleetJob
+{
+    using imageType = std::shared_ptr<const std::vector<uint8_t>>;
+
+    imageType            image;             ///< The program, which may be shared between jobs
+    uint16_t             load_address  = 0; ///< Where the image is loaded
+    uint16_t             entry_point   = 0; ///< Where execution starts
+    uint64_t             cycle_budget  = 0; ///< How long to run for
+    std::vector<uint8_t> input;             ///< Loaded after the image, to vary the run
+    uint16_t             input_address = 0; ///< Where the input is loaded
+};
+
+/** How a job ended up.
+ */
+struct FleetResult
+{
+    Registers  registers;
+    uint64_t   cycles        = 0;
+    uint64_t   instructions  = 0;
+    InstructionExecutor::StopReason reason = InstructionExecutor::StopReason::BudgetSpent;
+    uint64_t   memory_digest = 0; ///< See Machine::memoryDigest()
+};
+
+/** Runs batches of jobs across all cores.
+ *
+ *  Each worker thread owns one Machine, which it reuses for every job it
+ *  runs, so nothing mutable is shared between threads.  The jobs are dealt
+ *  out to the workers evenly, and a worker which runs out steals from the
+ *  others, so a few long jobs do not hold up the rest.
+ */
+class FleetRunner
+{
+public:
+    /** Creates a runner.
+     *
+     *  @param threads How many worker threads to run, or 0 for one per core
+     */
+    explicit FleetRunner(unsigned threads = 0);
+
+    unsigned threads() const { return _threads; }
+
+    /** Runs every job, returning when they have all finished.
+     *
+     *  @return The results, in the same order as @p jobs
+     */
+    std::vector<FleetResult> run(const std::vector<FleetJob> &jobs) const;
+
+    /** Runs one job on @p machine, on the calling thread.
+     */
+    static FleetResult runJob(Machine &machine, const FleetJob &job);
+
+private:
+    unsigned _threads;
+};
+
+#endif // FLEETRUNNER_HPP
@@ -0,0 +1,220 @@
+#include "inputjournal.hpp"
+#include <algorithm>
+
+
+namespace
+{
+// "IJN", then the version of the format
+constexpr uint8_t header[] = { 'I', 'J', 'N', 1 };
+
+constexpr uint8_t irq_sources = InstructionExecutor::numberOfIrqSources();
+
+// Seven bits at a time, lowest first, with the top bit set on all but the last
+void encodeNumber(std::vector<uint8_t> &log, uint64_t number)
+{
+    while (number >= 0x80)
+    {
+        log.push_back(static_cast<uint8_t>(number | 0x80));
+        number >>= 7;
+    }
+    log.push_back(static_cast<uint8_t>(number));
+}
+
+bool decodeNumber(const uint8_t *&next, const uint8_t *end, uint64_t &number)
+{
+    number = 0;
+    for (unsigned shift = 0; (next < end) && (shift < 64); shift += 7)
+    {
+        const uint8_t byte = *next++;
+
+        number |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+}
+
+InputJournal::InputJournal()
+{
+}
+
+InputJournal::~InputJournal()
+{
+}
+
+void InputJournal::raiseNmi(Machine &machine)
+{
+    Entry entry { machine.executor().clock_ticks, Type::Nmi, 0, 0 };
+
+    apply(entry, machine);
+    record(entry);
+}
+
+void InputJournal::poke(Machine &machine, addressType address, uint8_t value)
+{
+    Entry entry { machine.executor().clock_ticks, Type::Poke, address, value };
+
+    apply(entry, machine);
+    record(entry);
+}
+
+void InputJournal::reset(Machine &machine)
+{
+    Entry entry { machine.executor().clock_ticks, Type::Reset, 0, 0 };
+
+    apply(entry, machine);
+    record(entry);
+}
+
+// decode() rejects a log with any other source, so none is ever recorded.
+bool InputJournal::raiseIrq(Machine &machine, uint8_t source)
+{
+    Entry entry { machine.executor().clock_ticks, Type::RaiseIrq, 0, source };
+
+    if (source >= irq_sources)
+        return false;
+
+    apply(entry, machine);
+    record(entry);
+    return true;
+}
+
+bool InputJournal::lowerIrq(Machine &machine, uint8_t source)
+{
+    Entry entry { machine.executor().clock_ticks, Type::LowerIrq, 0, source };
+
+    if (source >= irq_sources)
+        return false;
+
+    apply(entry, machine);
+    record(entry);
+    return true;
+}
+
+// Runs never overshoot their budget, so the machine gets to each entry's
+// cycle exactly, and is in the middle of the same instruction as it was
+// when the entry was recorded, if it was.
+void InputJournal::replay(Machine &machine, uint64_t clock_ticks, size_t first) const
+{
+    InstructionExecutor &executor = machine.executor();
+    auto                 entry    = std::lower_bound(_entries.begin() + std::min(first, _entries.size()), _entries.end(), executor.clock_ticks,
+                                                     [](const Entry &entry, uint64_t cycle) { return entry.cycle < cycle; });
+
+    while (true)
+    {
+        for (; (entry != _entries.end()) && (entry->cycle <= executor.clock_ticks) && (entry->cycle <= clock_ticks); ++entry)
+            apply(*entry, machine);
+
+        const uint64_t until = (entry != _entries.end()) ? std::min(entry->cycle, clock_ticks) : clock_ticks;
+
+        if (executor.clock_ticks >= until)
+            return;
+
+        // A run always executes the instruction it starts on, so one
+        // stopping in front of a BRK doesn't hold this up.
+        while (executor.clock_ticks < until)
+            executor.runCycles(until - executor.clock_ticks);
+    }
+}
+
+std::vector<uint8_t> InputJournal::encode() const
+{
+    std::vector<uint8_t> log(std::begin(header), std::end(header));
+    uint64_t             cycle = 0;
+
+    for (const Entry &entry : _entries)
+    {
+        log.push_back(static_cast<uint8_t>(entry.type));
+        encodeNumber(log, entry.cycle - cycle);
+        cycle = entry.cycle;
+
+        switch (entry.type)
+        {
+        case Type::RaiseIrq:
+        case Type::LowerIrq:
+            log.push_back(entry.value);
+            break;
+        case Type::Poke:
+            log.push_back(static_cast<uint8_t>(entry.address));
+            log.push_back(static_cast<uint8_t>(entry.address >> 8));
+            log.push_back(entry.value);
+            break;
+        case Type::Nmi:
+        case Type::Reset:
+            break;
+        }
+    }
+    return log;
+}
+
+bool InputJournal::decode(const std::vector<uint8_t> &log)
+{
+    const uint8_t *next  = log.data();
+    const uint8_t *end   = next + log.size();
+    uint64_t       cycle = 0;
+
+    _entries.clear();
+    if ((log.size() < sizeof(header)) || !std::equal(std::begin(header), std::end(header), next))
+        return false;
+    next += sizeof(header);
+
+    while (next < end)
+    {
+        Entry    entry;
+        uint64_t elapsed;
+        bool     valid = (*next <= static_cast<uint8_t>(Type::Reset));
+
+        entry.type = static_cast<Type>(*next++);
+        valid      = valid && decodeNumber(next, end, elapsed);
+
+        if (valid && ((entry.type == Type::RaiseIrq) || (entry.type == Type::LowerIrq)))
+        {
+            valid = (next < end) && (*next < irq_sources);
+            if (valid)
+                entry.value = *next++;
+        }
+        else if (valid && (entry.type == Type::Poke))
+        {
+            valid = (end - next >= 3);
+            if (valid)
+            {
+                entry.address = static_cast<addressType>(next[0] | (next[1] << 8));
+                entry.value   = next[2];
+                next += 3;
+            }
+        }
+
+        if (!valid)
+        {
+            _entries.clear();
+            return false;
+        }
+        cycle += elapsed;
+        entry.cycle = cycle;
+        _entries.push_back(entry);
+    }
+    return true;
+}
+
+void InputJournal::apply(const Entry &entry, Machine &machine)
+{
+    switch (entry.type)
+    {
+    case Type::RaiseIrq:
+        machine.executor().raiseIrq(entry.value);
+        break;
+    case Type::LowerIrq:
+        machine.executor().lowerIrq(entry.value);
+        break;
+    case Type::Nmi:
+        machine.executor().raiseNmi();
+        break;
+    case Type::Poke:
+        machine.poke(entry.address, entry.value);
+        break;
+    case Type::Reset:
+        machine.executor().reset();
+        break;
+    }
+}
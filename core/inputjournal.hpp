@@ -0,0 +1,104 @@
+#ifndef INPUTJOURNAL_HPP
+#define INPUTJOURNAL_HPP
+
+#include <cstdint>
+#include <vector>
+#include "machine.hpp"
+
+
+/** A log of everything done to a Machine from outside, to replay it exactly.
+ *
+ *  A Machine on its own is deterministic: run from the same snapshot, it
+ *  does the same thing cycle for cycle.  What isn't are the interrupts the
+ *  host raises and the bytes it writes, such as input devices' registers,
+ *  when they happen.  Doing them through a journal does them to the
+ *  machine and records them against its clock_ticks, so replaying the
+ *  journal on a machine restored from a snapshot taken when recording
+ *  started reproduces the session bit for bit, as fast as the host can run
+ *  it.  Events run by an EventScheduler are part of the machine, and
+ *  aren't recorded.
+ *
+ *  The journal can be encoded into a compact binary log, which is a small
+ *  header followed by each entry as its type, the cycles since the entry
+ *  before as a variable length number, and its operands.
+ */
+class InputJournal
+{
+public:
+    using addressType = uint16_t;
+
+    enum class Type : uint8_t
+    {
+        RaiseIrq, ///< InstructionExecutor::raiseIrq() for source @c value
+        LowerIrq, ///< InstructionExecutor::lowerIrq() for source @c value
+        Nmi,      ///< InstructionExecutor::raiseNmi()
+        Poke,     ///< Machine::poke() of @c value to @c address
+        Reset     ///< InstructionExecutor::reset()
+    };
+
+    struct Entry
+    {
+        uint64_t    cycle   = 0; ///< The machine's clock_ticks when it happened
+        Type        type    = Type::Poke;
+        addressType address = 0;
+        uint8_t     value   = 0;
+    };
+
+    InputJournal();
+    ~InputJournal();
+
+    /** Each does what it says to @p machine, and records it.
+     */
+    ///@{
+    void raiseNmi(Machine &machine);
+    void poke(Machine &machine, addressType address, uint8_t value);
+    void reset(Machine &machine);
+    ///@}
+
+    /** Each does what it says to @p machine for IRQ source @p source, and records it.
+     *
+     *  @return false if @p source isn't one of the executor's 32, and nothing was done
+     */
+    ///@{
+    bool raiseIrq(Machine &machine, uint8_t source = 0);
+    bool lowerIrq(Machine &machine, uint8_t source = 0);
+    ///@}
+
+    /** Records @p entry without doing it, for inputs done some other way.
+     *
+     *  Entries must be recorded in the order of their cycles.
+     */
+    void record(const Entry &entry) { _entries.push_back(entry); }
+
+    const std::vector<Entry> &entries() const { return _entries; }
+
+    void clear() { _entries.clear(); }
+
+    /** Runs @p machine up to @p clock_ticks, doing each entry from @p first
+     *  on at the cycle it was recorded at.
+     *
+     *  @p first is the size of entries() when the snapshot the machine was
+     *  restored from was taken, so that entries made at the snapshot's
+     *  cycle before it was taken aren't done a second time.  Any entries
+     *  from before the machine's clock_ticks are skipped too, and those at
+     *  @p clock_ticks itself are done.
+     */
+    void replay(Machine &machine, uint64_t clock_ticks, size_t first) const;
+
+    /** The journal as a binary log.
+     */
+    std::vector<uint8_t> encode() const;
+
+    /** Replaces the entries with those of a binary log made by encode().
+     *
+     *  @return false if @p log isn't one, and the journal was left empty
+     */
+    bool decode(const std::vector<uint8_t> &log);
+
+private:
+    std::vector<Entry> _entries;
+
+    static void apply(const Entry &entry, Machine &machine);
+};
+
+#endif // INPUTJOURNAL_HPP
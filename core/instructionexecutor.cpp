@@ -0,0 +1,2820 @@
+#include "instructionexecutor.hpp"
+#include "blockrecompiler.hpp"
+#include "decimalmode.hpp"
+#include "eventscheduler.hpp"
+#include <algorithm>
+
+
+namespace
+{
+using a  = InstructionExecutor;
+using op = InstructionExecutor::Operation;
+using am = InstructionExecutor::AddressingMode;
+
+// The translation table. It's big, it's ugly, but it yields a convenient way
+// to emulate the 6502. I'm certain there are some "code-golf" strategies to reduce this
+// but I've deliberately kept it verbose for study and alteration
+
+// It is 16x16 entries. This gives 256 instructions. It is arranged to that the bottom
+// 4 bits of the instruction choose the column, and the top 4 bits choose the row.
+
+// It is a compile time constant of 3 bytes per entry, so the whole table fits in a
+// handful of cache lines and is shared by every InstructionExecutor.
+constexpr InstructionExecutor::INSTRUCTION nmos_lookup[256] =
+{
+    { op::BRK, am::IMM, 7 },{ op::ORA, am::IZX, 6 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 3 },{ op::ORA, am::ZP0, 3 },{ op::ASL, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::PHP, am::IMP, 3 },{ op::ORA, am::IMM, 2 },{ op::ASL, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::NOP, am::IMP, 4 },{ op::ORA, am::ABS, 4 },{ op::ASL, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BPL, am::REL, 2 },{ op::ORA, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::ORA, am::ZPX, 4 },{ op::ASL, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::CLC, am::IMP, 2 },{ op::ORA, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::ORA, am::ABX, 4 },{ op::ASL, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+    { op::JSR, am::ABS, 6 },{ op::AND, am::IZX, 6 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::BIT, am::ZP0, 3 },{ op::AND, am::ZP0, 3 },{ op::ROL, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::PLP, am::IMP, 4 },{ op::AND, am::IMM, 2 },{ op::ROL, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::BIT, am::ABS, 4 },{ op::AND, am::ABS, 4 },{ op::ROL, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BMI, am::REL, 2 },{ op::AND, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::AND, am::ZPX, 4 },{ op::ROL, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::SEC, am::IMP, 2 },{ op::AND, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::AND, am::ABX, 4 },{ op::ROL, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+    { op::RTI, am::IMP, 6 },{ op::EOR, am::IZX, 6 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 3 },{ op::EOR, am::ZP0, 3 },{ op::LSR, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::PHA, am::IMP, 3 },{ op::EOR, am::IMM, 2 },{ op::LSR, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::JMP, am::ABS, 3 },{ op::EOR, am::ABS, 4 },{ op::LSR, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BVC, am::REL, 2 },{ op::EOR, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::EOR, am::ZPX, 4 },{ op::LSR, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::CLI, am::IMP, 2 },{ op::EOR, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::EOR, am::ABX, 4 },{ op::LSR, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+    { op::RTS, am::IMP, 6 },{ op::ADC, am::IZX, 6 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 3 },{ op::ADC, am::ZP0, 3 },{ op::ROR, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::PLA, am::IMP, 4 },{ op::ADC, am::IMM, 2 },{ op::ROR, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::JMP, am::IND, 5 },{ op::ADC, am::ABS, 4 },{ op::ROR, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BVS, am::REL, 2 },{ op::ADC, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::ADC, am::ZPX, 4 },{ op::ROR, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::SEI, am::IMP, 2 },{ op::ADC, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::ADC, am::ABX, 4 },{ op::ROR, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+    { op::NOP, am::IMP, 2 },{ op::STA, am::IZX, 6 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 6 },{ op::STY, am::ZP0, 3 },{ op::STA, am::ZP0, 3 },{ op::STX, am::ZP0, 3 },{ op::XXX, am::IMP, 3 },{ op::DEY, am::IMP, 2 },{ op::NOP, am::IMP, 2 },{ op::TXA, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::STY, am::ABS, 4 },{ op::STA, am::ABS, 4 },{ op::STX, am::ABS, 4 },{ op::XXX, am::IMP, 4 },
+    { op::BCC, am::REL, 2 },{ op::STA, am::IZY, 6 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 6 },{ op::STY, am::ZPX, 4 },{ op::STA, am::ZPX, 4 },{ op::STX, am::ZPY, 4 },{ op::XXX, am::IMP, 4 },{ op::TYA, am::IMP, 2 },{ op::STA, am::ABY, 5 },{ op::TXS, am::IMP, 2 },{ op::XXX, am::IMP, 5 },{ op::NOP, am::IMP, 5 },{ op::STA, am::ABX, 5 },{ op::XXX, am::IMP, 5 },{ op::XXX, am::IMP, 5 },
+    { op::LDY, am::IMM, 2 },{ op::LDA, am::IZX, 6 },{ op::LDX, am::IMM, 2 },{ op::XXX, am::IMP, 6 },{ op::LDY, am::ZP0, 3 },{ op::LDA, am::ZP0, 3 },{ op::LDX, am::ZP0, 3 },{ op::XXX, am::IMP, 3 },{ op::TAY, am::IMP, 2 },{ op::LDA, am::IMM, 2 },{ op::TAX, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::LDY, am::ABS, 4 },{ op::LDA, am::ABS, 4 },{ op::LDX, am::ABS, 4 },{ op::XXX, am::IMP, 4 },
+    { op::BCS, am::REL, 2 },{ op::LDA, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 5 },{ op::LDY, am::ZPX, 4 },{ op::LDA, am::ZPX, 4 },{ op::LDX, am::ZPY, 4 },{ op::XXX, am::IMP, 4 },{ op::CLV, am::IMP, 2 },{ op::LDA, am::ABY, 4 },{ op::TSX, am::IMP, 2 },{ op::XXX, am::IMP, 4 },{ op::LDY, am::ABX, 4 },{ op::LDA, am::ABX, 4 },{ op::LDX, am::ABY, 4 },{ op::XXX, am::IMP, 4 },
+    { op::CPY, am::IMM, 2 },{ op::CMP, am::IZX, 6 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::CPY, am::ZP0, 3 },{ op::CMP, am::ZP0, 3 },{ op::DEC, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::INY, am::IMP, 2 },{ op::CMP, am::IMM, 2 },{ op::DEX, am::IMP, 2 },{ op::XXX, am::IMP, 2 },{ op::CPY, am::ABS, 4 },{ op::CMP, am::ABS, 4 },{ op::DEC, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BNE, am::REL, 2 },{ op::CMP, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::CMP, am::ZPX, 4 },{ op::DEC, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::CLD, am::IMP, 2 },{ op::CMP, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::CMP, am::ABX, 4 },{ op::DEC, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+    { op::CPX, am::IMM, 2 },{ op::SBC, am::IZX, 6 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::CPX, am::ZP0, 3 },{ op::SBC, am::ZP0, 3 },{ op::INC, am::ZP0, 5 },{ op::XXX, am::IMP, 5 },{ op::INX, am::IMP, 2 },{ op::SBC, am::IMM, 2 },{ op::NOP, am::IMP, 2 },{ op::SBC, am::IMP, 2 },{ op::CPX, am::ABS, 4 },{ op::SBC, am::ABS, 4 },{ op::INC, am::ABS, 6 },{ op::XXX, am::IMP, 6 },
+    { op::BEQ, am::REL, 2 },{ op::SBC, am::IZY, 5 },{ op::XXX, am::IMP, 2 },{ op::XXX, am::IMP, 8 },{ op::NOP, am::IMP, 4 },{ op::SBC, am::ZPX, 4 },{ op::INC, am::ZPX, 6 },{ op::XXX, am::IMP, 6 },{ op::SED, am::IMP, 2 },{ op::SBC, am::ABY, 4 },{ op::NOP, am::IMP, 2 },{ op::XXX, am::IMP, 7 },{ op::NOP, am::IMP, 4 },{ op::SBC, am::ABX, 4 },{ op::INC, am::ABX, 7 },{ op::XXX, am::IMP, 7 },
+};
+
+// The pneumonics, in the same order as the translation table. They're only used
+// when disassembling, so they're kept out of the way of the table above.
+const char *const nmos_names[256] =
+{
+    "BRK","ORA","???","???","???","ORA","ASL","???","PHP","ORA","ASL","???","???","ORA","ASL","???",
+    "BPL","ORA","???","???","???","ORA","ASL","???","CLC","ORA","???","???","???","ORA","ASL","???",
+    "JSR","AND","???","???","BIT","AND","ROL","???","PLP","AND","ROL","???","BIT","AND","ROL","???",
+    "BMI","AND","???","???","???","AND","ROL","???","SEC","AND","???","???","???","AND","ROL","???",
+    "RTI","EOR","???","???","???","EOR","LSR","???","PHA","EOR","LSR","???","JMP","EOR","LSR","???",
+    "BVC","EOR","???","???","???","EOR","LSR","???","CLI","EOR","???","???","???","EOR","LSR","???",
+    "RTS","ADC","???","???","???","ADC","ROR","???","PLA","ADC","ROR","???","JMP","ADC","ROR","???",
+    "BVS","ADC","???","???","???","ADC","ROR","???","SEI","ADC","???","???","???","ADC","ROR","???",
+    "???","STA","???","???","STY","STA","STX","???","DEY","???","TXA","???","STY","STA","STX","???",
+    "BCC","STA","???","???","STY","STA","STX","???","TYA","STA","TXS","???","???","STA","???","???",
+    "LDY","LDA","LDX","???","LDY","LDA","LDX","???","TAY","LDA","TAX","???","LDY","LDA","LDX","???",
+    "BCS","LDA","???","???","LDY","LDA","LDX","???","CLV","LDA","TSX","???","LDY","LDA","LDX","???",
+    "CPY","CMP","???","???","CPY","CMP","DEC","???","INY","CMP","DEX","???","CPY","CMP","DEC","???",
+    "BNE","CMP","???","???","???","CMP","DEC","???","CLD","CMP","NOP","???","???","CMP","DEC","???",
+    "CPX","SBC","???","???","CPX","SBC","INC","???","INX","SBC","NOP","???","CPX","SBC","INC","???",
+    "BEQ","SBC","???","???","???","SBC","INC","???","SED","SBC","NOP","???","???","SBC","INC","???",
+};
+
+// The 65C02's table. It fills in most of the holes in the NMOS one, and the
+// rest are NOPs of various lengths rather than anything unofficial. JMP
+// indirect takes a cycle longer than on the NMOS chips, now that it gets
+// the page right, and the shifts and rotates by absolute,X take a cycle
+// less unless the index crosses a page. INC and DEC still take 7.
+constexpr InstructionExecutor::INSTRUCTION cmos_lookup[256] =
+{
+    { op::BRK, am::IMM, 7 },{ op::ORA, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::TSB, am::ZP0, 5 },{ op::ORA, am::ZP0, 3 },{ op::ASL, am::ZP0, 5 },{ op::RMB, am::ZP0, 5 },{ op::PHP, am::IMP, 3 },{ op::ORA, am::IMM, 2 },{ op::ASL, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::TSB, am::ABS, 6 },{ op::ORA, am::ABS, 4 },{ op::ASL, am::ABS, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::BPL, am::REL, 2 },{ op::ORA, am::IZY, 5 },{ op::ORA, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::TRB, am::ZP0, 5 },{ op::ORA, am::ZPX, 4 },{ op::ASL, am::ZPX, 6 },{ op::RMB, am::ZP0, 5 },{ op::CLC, am::IMP, 2 },{ op::ORA, am::ABY, 4 },{ op::INC, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::TRB, am::ABS, 6 },{ op::ORA, am::ABX, 4 },{ op::ASL, am::ABX, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::JSR, am::ABS, 6 },{ op::AND, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::BIT, am::ZP0, 3 },{ op::AND, am::ZP0, 3 },{ op::ROL, am::ZP0, 5 },{ op::RMB, am::ZP0, 5 },{ op::PLP, am::IMP, 4 },{ op::AND, am::IMM, 2 },{ op::ROL, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::BIT, am::ABS, 4 },{ op::AND, am::ABS, 4 },{ op::ROL, am::ABS, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::BMI, am::REL, 2 },{ op::AND, am::IZY, 5 },{ op::AND, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::BIT, am::ZPX, 4 },{ op::AND, am::ZPX, 4 },{ op::ROL, am::ZPX, 6 },{ op::RMB, am::ZP0, 5 },{ op::SEC, am::IMP, 2 },{ op::AND, am::ABY, 4 },{ op::DEC, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::BIT, am::ABX, 4 },{ op::AND, am::ABX, 4 },{ op::ROL, am::ABX, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::RTI, am::IMP, 6 },{ op::EOR, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ZP0, 3 },{ op::EOR, am::ZP0, 3 },{ op::LSR, am::ZP0, 5 },{ op::RMB, am::ZP0, 5 },{ op::PHA, am::IMP, 3 },{ op::EOR, am::IMM, 2 },{ op::LSR, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::JMP, am::ABS, 3 },{ op::EOR, am::ABS, 4 },{ op::LSR, am::ABS, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::BVC, am::REL, 2 },{ op::EOR, am::IZY, 5 },{ op::EOR, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ZPX, 4 },{ op::EOR, am::ZPX, 4 },{ op::LSR, am::ZPX, 6 },{ op::RMB, am::ZP0, 5 },{ op::CLI, am::IMP, 2 },{ op::EOR, am::ABY, 4 },{ op::PHY, am::IMP, 3 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ABS, 8 },{ op::EOR, am::ABX, 4 },{ op::LSR, am::ABX, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::RTS, am::IMP, 6 },{ op::ADC, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::STZ, am::ZP0, 3 },{ op::ADC, am::ZP0, 3 },{ op::ROR, am::ZP0, 5 },{ op::RMB, am::ZP0, 5 },{ op::PLA, am::IMP, 4 },{ op::ADC, am::IMM, 2 },{ op::ROR, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::JMP, am::IND, 6 },{ op::ADC, am::ABS, 4 },{ op::ROR, am::ABS, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::BVS, am::REL, 2 },{ op::ADC, am::IZY, 5 },{ op::ADC, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::STZ, am::ZPX, 4 },{ op::ADC, am::ZPX, 4 },{ op::ROR, am::ZPX, 6 },{ op::RMB, am::ZP0, 5 },{ op::SEI, am::IMP, 2 },{ op::ADC, am::ABY, 4 },{ op::PLY, am::IMP, 4 },{ op::NOP, am::IMP, 1 },{ op::JMP, am::IAX, 6 },{ op::ADC, am::ABX, 4 },{ op::ROR, am::ABX, 6 },{ op::BBR, am::ZPR, 5 },
+    { op::BRA, am::REL, 2 },{ op::STA, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::STY, am::ZP0, 3 },{ op::STA, am::ZP0, 3 },{ op::STX, am::ZP0, 3 },{ op::SMB, am::ZP0, 5 },{ op::DEY, am::IMP, 2 },{ op::BIT, am::IMM, 2 },{ op::TXA, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::STY, am::ABS, 4 },{ op::STA, am::ABS, 4 },{ op::STX, am::ABS, 4 },{ op::BBS, am::ZPR, 5 },
+    { op::BCC, am::REL, 2 },{ op::STA, am::IZY, 6 },{ op::STA, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::STY, am::ZPX, 4 },{ op::STA, am::ZPX, 4 },{ op::STX, am::ZPY, 4 },{ op::SMB, am::ZP0, 5 },{ op::TYA, am::IMP, 2 },{ op::STA, am::ABY, 5 },{ op::TXS, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::STZ, am::ABS, 4 },{ op::STA, am::ABX, 5 },{ op::STZ, am::ABX, 5 },{ op::BBS, am::ZPR, 5 },
+    { op::LDY, am::IMM, 2 },{ op::LDA, am::IZX, 6 },{ op::LDX, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::LDY, am::ZP0, 3 },{ op::LDA, am::ZP0, 3 },{ op::LDX, am::ZP0, 3 },{ op::SMB, am::ZP0, 5 },{ op::TAY, am::IMP, 2 },{ op::LDA, am::IMM, 2 },{ op::TAX, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::LDY, am::ABS, 4 },{ op::LDA, am::ABS, 4 },{ op::LDX, am::ABS, 4 },{ op::BBS, am::ZPR, 5 },
+    { op::BCS, am::REL, 2 },{ op::LDA, am::IZY, 5 },{ op::LDA, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::LDY, am::ZPX, 4 },{ op::LDA, am::ZPX, 4 },{ op::LDX, am::ZPY, 4 },{ op::SMB, am::ZP0, 5 },{ op::CLV, am::IMP, 2 },{ op::LDA, am::ABY, 4 },{ op::TSX, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::LDY, am::ABX, 4 },{ op::LDA, am::ABX, 4 },{ op::LDX, am::ABY, 4 },{ op::BBS, am::ZPR, 5 },
+    { op::CPY, am::IMM, 2 },{ op::CMP, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::CPY, am::ZP0, 3 },{ op::CMP, am::ZP0, 3 },{ op::DEC, am::ZP0, 5 },{ op::SMB, am::ZP0, 5 },{ op::INY, am::IMP, 2 },{ op::CMP, am::IMM, 2 },{ op::DEX, am::IMP, 2 },{ op::WAI, am::IMP, 3 },{ op::CPY, am::ABS, 4 },{ op::CMP, am::ABS, 4 },{ op::DEC, am::ABS, 6 },{ op::BBS, am::ZPR, 5 },
+    { op::BNE, am::REL, 2 },{ op::CMP, am::IZY, 5 },{ op::CMP, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ZPX, 4 },{ op::CMP, am::ZPX, 4 },{ op::DEC, am::ZPX, 6 },{ op::SMB, am::ZP0, 5 },{ op::CLD, am::IMP, 2 },{ op::CMP, am::ABY, 4 },{ op::PHX, am::IMP, 3 },{ op::STP, am::IMP, 3 },{ op::NOP, am::ABS, 4 },{ op::CMP, am::ABX, 4 },{ op::DEC, am::ABX, 7 },{ op::BBS, am::ZPR, 5 },
+    { op::CPX, am::IMM, 2 },{ op::SBC, am::IZX, 6 },{ op::NOP, am::IMM, 2 },{ op::NOP, am::IMP, 1 },{ op::CPX, am::ZP0, 3 },{ op::SBC, am::ZP0, 3 },{ op::INC, am::ZP0, 5 },{ op::SMB, am::ZP0, 5 },{ op::INX, am::IMP, 2 },{ op::SBC, am::IMM, 2 },{ op::NOP, am::IMP, 2 },{ op::NOP, am::IMP, 1 },{ op::CPX, am::ABS, 4 },{ op::SBC, am::ABS, 4 },{ op::INC, am::ABS, 6 },{ op::BBS, am::ZPR, 5 },
+    { op::BEQ, am::REL, 2 },{ op::SBC, am::IZY, 5 },{ op::SBC, am::ZPI, 5 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ZPX, 4 },{ op::SBC, am::ZPX, 4 },{ op::INC, am::ZPX, 6 },{ op::SMB, am::ZP0, 5 },{ op::SED, am::IMP, 2 },{ op::SBC, am::ABY, 4 },{ op::PLX, am::IMP, 4 },{ op::NOP, am::IMP, 1 },{ op::NOP, am::ABS, 4 },{ op::SBC, am::ABX, 4 },{ op::INC, am::ABX, 7 },{ op::BBS, am::ZPR, 5 },
+};
+
+const char *const cmos_names[256] =
+{
+    "BRK","ORA","NOP","NOP","TSB","ORA","ASL","RMB0","PHP","ORA","ASL","NOP","TSB","ORA","ASL","BBR0",
+    "BPL","ORA","ORA","NOP","TRB","ORA","ASL","RMB1","CLC","ORA","INC","NOP","TRB","ORA","ASL","BBR1",
+    "JSR","AND","NOP","NOP","BIT","AND","ROL","RMB2","PLP","AND","ROL","NOP","BIT","AND","ROL","BBR2",
+    "BMI","AND","AND","NOP","BIT","AND","ROL","RMB3","SEC","AND","DEC","NOP","BIT","AND","ROL","BBR3",
+    "RTI","EOR","NOP","NOP","NOP","EOR","LSR","RMB4","PHA","EOR","LSR","NOP","JMP","EOR","LSR","BBR4",
+    "BVC","EOR","EOR","NOP","NOP","EOR","LSR","RMB5","CLI","EOR","PHY","NOP","NOP","EOR","LSR","BBR5",
+    "RTS","ADC","NOP","NOP","STZ","ADC","ROR","RMB6","PLA","ADC","ROR","NOP","JMP","ADC","ROR","BBR6",
+    "BVS","ADC","ADC","NOP","STZ","ADC","ROR","RMB7","SEI","ADC","PLY","NOP","JMP","ADC","ROR","BBR7",
+    "BRA","STA","NOP","NOP","STY","STA","STX","SMB0","DEY","BIT","TXA","NOP","STY","STA","STX","BBS0",
+    "BCC","STA","STA","NOP","STY","STA","STX","SMB1","TYA","STA","TXS","NOP","STZ","STA","STZ","BBS1",
+    "LDY","LDA","LDX","NOP","LDY","LDA","LDX","SMB2","TAY","LDA","TAX","NOP","LDY","LDA","LDX","BBS2",
+    "BCS","LDA","LDA","NOP","LDY","LDA","LDX","SMB3","CLV","LDA","TSX","NOP","LDY","LDA","LDX","BBS3",
+    "CPY","CMP","NOP","NOP","CPY","CMP","DEC","SMB4","INY","CMP","DEX","WAI","CPY","CMP","DEC","BBS4",
+    "BNE","CMP","CMP","NOP","NOP","CMP","DEC","SMB5","CLD","CMP","PHX","STP","NOP","CMP","DEC","BBS5",
+    "CPX","SBC","NOP","NOP","CPX","SBC","INC","SMB6","INX","SBC","NOP","NOP","CPX","SBC","INC","BBS6",
+    "BEQ","SBC","SBC","NOP","NOP","SBC","INC","SMB7","SED","SBC","PLX","NOP","NOP","SBC","INC","BBS7",
+};
+
+// How many operand bytes follow the opcode for each addressing mode
+constexpr uint8_t operand_lengths[] =
+{
+    0, // IMP
+    1, // IMM
+    1, // ZP0
+    1, // ZPX
+    1, // ZPY
+    1, // REL
+    2, // ABS
+    2, // ABX
+    2, // ABY
+    2, // IND
+    1, // IZX
+    1, // IZY
+    1, // ZPI
+    2, // IAX
+    2, // ZPR
+};
+
+// How decimal mode works, if at all
+enum class Decimal { None, Nmos, Cmos };
+
+// The instruction sets. Each is a policy the handlers are specialised on, so
+// whatever sets one apart is a compile time constant folded into its own copy
+// of them, instead of being looked at while running.
+struct Nmos6502
+{
+    static constexpr a::InstructionSet           set    = a::InstructionSet::Nmos6502;
+    static constexpr const a::INSTRUCTION       *lookup = nmos_lookup;
+    static constexpr const char *const          *names  = nmos_names;
+    static constexpr Decimal                     decimal = Decimal::Nmos;
+    static constexpr bool                        indirect_jump_bug = true;
+    static constexpr bool                        interrupts_clear_decimal = false;
+    static constexpr bool                        shift_page_penalty = false;
+};
+
+struct Cmos65C02
+{
+    static constexpr a::InstructionSet           set    = a::InstructionSet::Cmos65C02;
+    static constexpr const a::INSTRUCTION       *lookup = cmos_lookup;
+    static constexpr const char *const          *names  = cmos_names;
+    static constexpr Decimal                     decimal = Decimal::Cmos;
+    static constexpr bool                        indirect_jump_bug = false;
+    static constexpr bool                        interrupts_clear_decimal = true;
+    static constexpr bool                        shift_page_penalty = true;
+};
+
+// The same as the NMOS 6502, with the decimal adjust cut out of the silicon
+struct Ricoh2A03
+{
+    static constexpr a::InstructionSet           set    = a::InstructionSet::Ricoh2A03;
+    static constexpr const a::INSTRUCTION       *lookup = nmos_lookup;
+    static constexpr const char *const          *names  = nmos_names;
+    static constexpr Decimal                     decimal = Decimal::None;
+    static constexpr bool                        indirect_jump_bug = true;
+    static constexpr bool                        interrupts_clear_decimal = false;
+    static constexpr bool                        shift_page_penalty = false;
+};
+
+// The member functions implementing each Operation and AddressingMode, in the
+// order they're declared in, for each instruction set.
+template<typename Isa>
+constexpr uint8_t (InstructionExecutor::*operations[])() =
+{
+    &a::ADC<Isa>, &a::AND, &a::ASL<Isa>, &a::BCC, &a::BCS, &a::BEQ, &a::BIT, &a::BMI, &a::BNE, &a::BPL,
+    &a::BRK<Isa>, &a::BVC, &a::BVS, &a::CLC, &a::CLD, &a::CLI, &a::CLV, &a::CMP, &a::CPX, &a::CPY,
+    &a::DEC, &a::DEX, &a::DEY, &a::EOR, &a::INC, &a::INX, &a::INY, &a::JMP, &a::JSR, &a::LDA,
+    &a::LDX, &a::LDY, &a::LSR<Isa>, &a::NOP, &a::ORA, &a::PHA, &a::PHP, &a::PLA, &a::PLP, &a::ROL<Isa>,
+    &a::ROR<Isa>, &a::RTI, &a::RTS, &a::SBC<Isa>, &a::SEC, &a::SED, &a::SEI, &a::STA, &a::STX, &a::STY,
+    &a::TAX, &a::TAY, &a::TSX, &a::TXA, &a::TXS, &a::TYA,
+    &a::BBR, &a::BBS, &a::BRA, &a::PHX, &a::PHY, &a::PLX, &a::PLY, &a::RMB, &a::SMB, &a::STP,
+    &a::STZ, &a::TRB, &a::TSB, &a::WAI, &a::XXX,
+};
+
+template<typename Isa>
+constexpr uint8_t (InstructionExecutor::*addressing_modes[])() =
+{
+    &a::IMP, &a::IMM, &a::ZP0, &a::ZPX, &a::ZPY, &a::REL, &a::ABS, &a::ABX, &a::ABY, &a::IND<Isa>, &a::IZX, &a::IZY,
+    &a::ZPI, &a::IAX, &a::ZPR,
+};
+
+static_assert(sizeof(operations<Nmos6502>) / sizeof(operations<Nmos6502>[0]) == static_cast<size_t>(op::XXX) + 1,
+              "Every Operation needs an entry in operations");
+static_assert(sizeof(addressing_modes<Nmos6502>) / sizeof(addressing_modes<Nmos6502>[0]) == static_cast<size_t>(am::ZPR) + 1,
+              "Every AddressingMode needs an entry in addressing_modes");
+
+template<typename Isa>
+constexpr uint8_t (InstructionExecutor::*operationOf(const InstructionExecutor::INSTRUCTION &instruction))()
+{
+    return operations<Isa>[static_cast<size_t>(instruction.operate)];
+}
+
+template<typename Isa>
+constexpr uint8_t (InstructionExecutor::*addressingModeOf(const InstructionExecutor::INSTRUCTION &instruction))()
+{
+    return addressing_modes<Isa>[static_cast<size_t>(instruction.addrmode)];
+}
+}
+
+
+InstructionExecutor::InstructionExecutor(Registers    &registers,
+                                         readDelegate  read_signal,
+                                         writeDelegate write_signal,
+                                         registersChangedDelegate registers_changed_signal
+                                         )
+    :
+    _registers(registers),
+    _read_delegate(read_signal),
+    _write_delegate(write_signal),
+    _registers_changed(registers_changed_signal),
+    _published(registers),
+    _dispatch(&dispatchFor(InstructionSet::Nmos6502)),
+#ifdef INSTRUCTIONEXECUTOR_PREDECODE
+    _predecode(true)
+#else
+    _predecode(false)
+#endif
+{
+}
+
+InstructionExecutor::~InstructionExecutor()
+{
+}
+
+const InstructionExecutor::INSTRUCTION &InstructionExecutor::instructionFor(uint8_t opcode, InstructionSet set)
+{
+    return dispatchFor(set).lookup[opcode];
+}
+
+const char *InstructionExecutor::nameOf(uint8_t opcode, InstructionSet set)
+{
+    return dispatchFor(set).names[opcode];
+}
+
+uint8_t InstructionExecutor::lengthOf(uint8_t opcode, InstructionSet set)
+{
+    return 1 + operand_lengths[static_cast<size_t>(instructionFor(opcode, set).addrmode)];
+}
+
+uint8_t InstructionExecutor::instructionLength(uint8_t opcode) const
+{
+    return 1 + operand_lengths[static_cast<size_t>(instruction(opcode).addrmode)];
+}
+
+void InstructionExecutor::setInstructionSet(InstructionSet set)
+{
+    if (set == instructionSet())
+        return;
+
+    // Whatever was decoded or compiled was for the other one.
+    _dispatch = &dispatchFor(set);
+    invalidatePredecoded();
+}
+
+auto InstructionExecutor::state() const -> State
+{
+    State state;
+
+    state.clock_ticks   = clock_ticks;
+    state.temp          = _temp;
+    state.addr_abs      = _addr_abs;
+    state.addr_rel      = _addr_rel;
+    state.fetched       = _fetched;
+    state.opcode        = _opcode;
+    state.cycles        = _cycles;
+    state.implied       = _implied;
+    state.pending_flags = _pending_flags;
+    state.nz_result     = _nz_result;
+    state.v_operand1    = _v_operand1;
+    state.v_operand2    = _v_operand2;
+    state.v_result      = _v_result;
+    state.irq_sources   = _irq_sources;
+    state.nmi_pending   = _nmi_pending;
+    state.waiting       = _waiting;
+    state.stopped       = _stopped;
+    return state;
+}
+
+void InstructionExecutor::setState(const State &state)
+{
+    clock_ticks    = state.clock_ticks;
+    _temp          = state.temp;
+    _addr_abs      = state.addr_abs;
+    _addr_rel      = state.addr_rel;
+    _fetched       = state.fetched;
+    _opcode        = state.opcode;
+    _cycles        = state.cycles;
+    _implied       = state.implied;
+    _pending_flags = state.pending_flags;
+    _nz_result     = state.nz_result;
+    _v_operand1    = state.v_operand1;
+    _v_operand2    = state.v_operand2;
+    _v_result      = state.v_result;
+    _irq_sources   = state.irq_sources;
+    _nmi_pending   = state.nmi_pending;
+    _waiting       = state.waiting;
+    _stopped       = state.stopped;
+}
+
+void InstructionExecutor::copySettings(const InstructionExecutor &other)
+{
+    setInstructionSet(other.instructionSet());
+    setPredecode(other.predecode());
+    setFuseInstructions(other.fuseInstructions());
+    setRecompile(other.recompile());
+    setSkipIdleLoops(other.skipIdleLoops());
+    _breakpoints = other._breakpoints;
+}
+
+// The 6502 can address between 0x0000 - 0xFFFF. The high byte is often referred
+// to as the "page", and the low byte is the offset into that page. This implies
+// there are 256 pages, each containing 256 bytes.
+//
+// Several addressing modes have the potential to require an additional clock
+// cycle if they cross a page boundary. This is combined with several instructions
+// that enable this additional clock cycle. So each addressing function returns
+// a flag saying it has potential, as does each instruction. If both instruction
+// and address function return 1, then an additional clock cycle is required.
+
+
+// Address Mode: Implied
+// There is no additional data required for this instruction. The instruction
+// does something very simple like like sets a status bit. However, we will
+// target the accumulator, for instructions like PHA
+uint8_t InstructionExecutor::IMP()
+{
+    _fetched = registers().a;
+    return 0;
+}
+
+// Address Mode: Immediate
+// The instruction expects the next byte to be used as a value, so we'll prep
+// the read address to point to the next byte
+uint8_t InstructionExecutor::IMM()
+{
+    _addr_abs = registers().program_counter++;
+    return 0;
+}
+
+// Address Mode: Zero Page
+// To save program bytes, zero page addressing allows you to absolutely address
+// a location in first 0xFF bytes of address range. Clearly this only requires
+// one byte instead of the usual two.
+uint8_t InstructionExecutor::ZP0()
+{
+    _addr_abs = read(registers().program_counter);
+    registers().program_counter++;
+    _addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Zero Page with X Offset
+// Fundamentally the same as Zero Page addressing, but the contents of the X Register
+// is added to the supplied single byte address. This is useful for iterating through
+// ranges within the first page.
+uint8_t InstructionExecutor::ZPX()
+{
+    _addr_abs = (read(registers().program_counter) + registers().x);
+    registers().program_counter++;
+    _addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Zero Page with Y Offset
+// Same as above but uses Y Register for offset
+uint8_t InstructionExecutor::ZPY()
+{
+    _addr_abs = (read(registers().program_counter) + registers().y);
+    registers().program_counter++;
+    _addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Relative
+// This address mode is exclusive to branch instructions. The address
+// must reside within -128 to +127 of the branch instruction, i.e.
+// you cant directly branch to any address in the addressable range.
+uint8_t InstructionExecutor::REL()
+{
+    _addr_rel = read(registers().program_counter);
+    registers().program_counter++;
+    if (_addr_rel & 0x80)
+        _addr_rel |= 0xFF00;
+    return 0;
+}
+
+// Address Mode: Absolute
+// A full 16-bit address is loaded and used
+uint8_t InstructionExecutor::ABS()
+{
+    uint16_t lo = read(registers().program_counter);
+    registers().program_counter++;
+    uint16_t hi = read(registers().program_counter);
+    registers().program_counter++;
+    _addr_abs = (hi << 8) | lo;
+
+    return 0;
+}
+
+// Address Mode: Absolute with X Offset
+// Fundamentally the same as absolute addressing, but the contents of the X Register
+// is added to the supplied two byte address. If the resulting address changes
+// the page, an additional clock cycle is required
+uint8_t InstructionExecutor::ABX()
+{
+    uint16_t lo = read(registers().program_counter);
+    registers().program_counter++;
+    uint16_t hi = read(registers().program_counter);
+    registers().program_counter++;
+
+    _addr_abs = (hi << 8) | lo;
+    _addr_abs += registers().x;
+
+    if ((_addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// Address Mode: Absolute with Y Offset
+// Fundamentally the same as absolute addressing, but the contents of the Y Register
+// is added to the supplied two byte address. If the resulting address changes
+// the page, an additional clock cycle is required
+uint8_t InstructionExecutor::ABY()
+
+{
+    uint16_t lo = read(registers().program_counter);
+    registers().program_counter++;
+    uint16_t hi = read(registers().program_counter);
+    registers().program_counter++;
+
+    _addr_abs = (hi << 8) | lo;
+
+    _addr_abs += registers().y;
+
+    if ((_addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// Note: The next 3 address modes use indirection (aka Pointers!)
+
+// Address Mode: Indirect
+// The supplied 16-bit address is read to get the actual 16-bit address. This is
+// instruction is unusual in that it has a bug in the hardware! To emulate its
+// function accurately, we also need to emulate this bug. If the low byte of the
+// supplied address is 0xFF, then to read the high byte of the actual address
+// we need to cross a page boundary. This doesnt actually work on the chip as
+// designed, instead it wraps back around in the same page, yielding an
+// invalid actual address. The 65C02 fixed it, at the cost of a cycle.
+template<typename Isa>
+uint8_t InstructionExecutor::IND()
+{
+    uint16_t ptr_lo = read(registers().program_counter);
+    registers().program_counter++;
+    uint16_t ptr_hi = read(registers().program_counter);
+    registers().program_counter++;
+
+    uint16_t ptr = (ptr_hi << 8) | ptr_lo;
+
+    if (Isa::indirect_jump_bug && (ptr_lo == 0x00FF)) // Simulate page boundary hardware bug
+    {
+        _addr_abs = (read(ptr & 0xFF00) << 8) | read(ptr + 0);
+    }
+    else // Behave normally
+    {
+        _addr_abs = (read(ptr + 1) << 8) | read(ptr + 0);
+    }
+    return 0;
+}
+
+// Address Mode: Indirect X
+// The supplied 8-bit address is offset by X Register to index
+// a location in page 0x00. The actual 16-bit address is read
+// from this location
+uint8_t InstructionExecutor::IZX()
+{
+    uint16_t t = read(registers().program_counter);
+    registers().program_counter++;
+
+    uint16_t lo = read((uint16_t)(t + (uint16_t)registers().x) & 0x00FF);
+    uint16_t hi = read((uint16_t)(t + (uint16_t)registers().x + 1) & 0x00FF);
+
+    _addr_abs = (hi << 8) | lo;
+
+    return 0;
+}
+
+// Address Mode: Indirect Y
+// The supplied 8-bit address indexes a location in page 0x00. From
+// here the actual 16-bit address is read, and the contents of
+// Y Register is added to it to offset it. If the offset causes a
+// change in page then an additional clock cycle is required.
+uint8_t InstructionExecutor::IZY()
+{
+    uint16_t t = read(registers().program_counter);
+    registers().program_counter++;
+
+    uint16_t lo = read(t & 0x00FF);
+    uint16_t hi = read((t + 1) & 0x00FF);
+
+    _addr_abs = (hi << 8) | lo;
+    _addr_abs += registers().y;
+
+    if ((_addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// Address Mode: Zero Page Indirect (65C02)
+// Like Indirect Y, without adding Y
+uint8_t InstructionExecutor::ZPI()
+{
+    uint16_t t = read(registers().program_counter);
+    registers().program_counter++;
+
+    uint16_t lo = read(t & 0x00FF);
+    uint16_t hi = read((t + 1) & 0x00FF);
+
+    _addr_abs = (hi << 8) | lo;
+    return 0;
+}
+
+// Address Mode: Absolute Indexed Indirect (65C02)
+// Only used by JMP. X is added to the supplied 16-bit address, and the
+// actual address is read from there, page boundary or not.
+uint8_t InstructionExecutor::IAX()
+{
+    uint16_t lo = read(registers().program_counter);
+    registers().program_counter++;
+    uint16_t hi = read(registers().program_counter);
+    registers().program_counter++;
+
+    uint16_t ptr = ((hi << 8) | lo) + registers().x;
+
+    _addr_abs = (read(ptr + 1) << 8) | read(ptr + 0);
+    return 0;
+}
+
+// Address Mode: Zero Page and Relative (65C02)
+// Only used by BBR and BBS, which test a bit of a zero page location and
+// branch on it, so both an address and a branch offset follow the opcode.
+uint8_t InstructionExecutor::ZPR()
+{
+    _addr_abs = read(registers().program_counter);
+    registers().program_counter++;
+    _addr_rel = read(registers().program_counter);
+    registers().program_counter++;
+    if (_addr_rel & 0x80)
+        _addr_rel |= 0xFF00;
+    return 0;
+}
+
+// This function sources the data used by the instruction into
+// a convenient numeric variable. Some instructions dont have to
+// fetch data as the source is implied by the instruction. For example
+// "INX" increments the X register. There is no additional data
+// required. For all other addressing modes, the data resides at
+// the location held within addr_abs, so it is read from there.
+// Immediate adress mode exploits this slightly, as that has
+// set addr_abs = pc + 1, so it fetches the data from the
+// next byte for example "LDA $FF" just loads the accumulator with
+// 256, i.e. no far reaching memory fetch is required. "fetched"
+// is a variable global to the CPU, and is set by calling this
+// function. It also returns it for convenience.
+uint8_t InstructionExecutor::fetch()
+{
+    if (!_implied)
+        _fetched = read(_addr_abs);
+    return _fetched;
+}
+
+// Plain memory pages are accessed directly through the host pointer. Only
+// the remaining pages (memory mapped devices) pay for the delegate call.
+uint8_t InstructionExecutor::read(addressType address, bool read_only)
+{
+    const uint8_t *page = _read_pages[address >> 8];
+
+    if (page)
+        return page[address & 0x00FF];
+    return (_read_delegate) ? _read_delegate(address, read_only) : 0x00;
+}
+
+void InstructionExecutor::write(addressType address, uint8_t data)
+{
+    uint8_t *page = _write_pages[address >> 8];
+
+    if (_code_bytes && _code_bytes->test(address))
+        invalidatePredecoded(address);
+
+    if (page)
+        page[address & 0x00FF] = data;
+    else if (_write_delegate)
+        _write_delegate(address, data);
+}
+
+void InstructionExecutor::mapPage(uint8_t page, const uint8_t *read_memory, uint8_t *write_memory)
+{
+    // Whatever was decoded from the page may not be there any more.
+    if (_code_bytes && (read_memory != _read_pages[page]))
+    {
+        for (size_t offset = 0; offset < 0x100; ++offset)
+            invalidatePredecoded(static_cast<addressType>((page << 8) + offset));
+    }
+    _read_pages[page]  = read_memory;
+    _write_pages[page] = write_memory;
+}
+
+// Forces the 6502 into a known state. This is hard-wired inside the CPU. The
+// registers are set to 0x00, the status register is cleared except for unused
+// bit which remains at 1. An absolute address is read from location 0xFFFC
+// which contains a second address that the program counter is set to. This
+// allows the programmer to jump to a known and programmable location in the
+// memory to start executing from. Typically the programmer would set the value
+// at location 0xFFFC at compile time.
+void InstructionExecutor::reset()
+{
+    // Get address to set program counter to
+    _addr_abs = 0xFFFC;
+    uint16_t lo = read(_addr_abs + 0);
+    uint16_t hi = read(_addr_abs + 1);
+
+    // Set it
+    registers().program_counter = (hi << 8) | lo;
+
+    // Reset internal registers
+    registers().a = 0;
+    registers().x = 0;
+    registers().y = 0;
+    registers().stack_pointer = 0xFD;
+    registers().status = 0x00 | U;
+    _pending_flags = 0;
+    _nmi_pending = false;
+    _waiting = false;
+    _stopped = false;
+
+    // Clear internal helper variables
+    _addr_rel = 0x0000;
+    _addr_abs = 0x0000;
+    _fetched = 0x00;
+
+    // Reset takes time
+    _cycles = 8;
+}
+
+void InstructionExecutor::irq()
+{
+    // If interrupts are allowed
+    if ((GetFlag(I) == 0) && !_stopped)
+    {
+        // A WAI is over, and returns past itself
+        if (_waiting)
+        {
+            registers().program_counter++;
+            _waiting = false;
+        }
+
+        // Push the program counter to the stack. It's 16-bits dont
+        // forget so that takes two pushes
+        write(0x0100 + registers().stack_pointer, (registers().program_counter >> 8) & 0x00FF);
+        registers().stack_pointer--;
+        write(0x0100 + registers().stack_pointer, registers().program_counter & 0x00FF);
+        registers().stack_pointer--;
+
+        // Then Push the status register to the stack, as it was before the
+        // interrupt, so RTI enables interrupts again
+        SetFlag(B, 0);
+        SetFlag(U, 1);
+        materializeFlags();
+        write(0x0100 + registers().stack_pointer, registers().status);
+        registers().stack_pointer--;
+        SetFlag(I, 1);
+        if (_dispatch->interrupts_clear_decimal)
+            SetFlag(D, 0);
+
+        // Read new program counter location from fixed address
+        _addr_abs = 0xFFFE;
+        uint16_t lo = read(_addr_abs + 0);
+        uint16_t hi = read(_addr_abs + 1);
+        registers().program_counter = (hi << 8) | lo;
+
+        // IRQs take time
+        _cycles = 7;
+    }
+}
+
+void InstructionExecutor::nmi()
+{
+    if (_stopped)
+        return;
+    if (_waiting)
+    {
+        registers().program_counter++;
+        _waiting = false;
+    }
+
+    write(0x0100 + registers().stack_pointer, (registers().program_counter >> 8) & 0x00FF);
+    registers().stack_pointer--;
+    write(0x0100 + registers().stack_pointer, registers().program_counter & 0x00FF);
+    registers().stack_pointer--;
+
+    SetFlag(B, 0);
+    SetFlag(U, 1);
+    materializeFlags();
+    write(0x0100 + registers().stack_pointer, registers().status);
+    registers().stack_pointer--;
+    SetFlag(I, 1);
+    if (_dispatch->interrupts_clear_decimal)
+        SetFlag(D, 0);
+
+    _addr_abs = 0xFFFA;
+    uint16_t lo = read(_addr_abs + 0);
+    uint16_t hi = read(_addr_abs + 1);
+    registers().program_counter = (hi << 8) | lo;
+
+    _cycles = 8;
+}
+
+void InstructionExecutor::clock()
+{
+    // Each instruction requires a variable number of clock cycles to execute.
+    // In my emulation, I only care about the final result and so I perform
+    // the entire computation in one hit. In hardware, each clock cycle would
+    // perform "microcode" style transformations of the CPUs state.
+    //
+    // To remain compliant with connected devices, it's important that the
+    // emulation also takes "time" in order to execute instructions, so I
+    // implement that delay by simply counting down the cycles required by
+    // the instruction. When it reaches 0, the instruction is complete, and
+    // the next one is ready to be executed.
+    if (complete() && atInstructionBoundary())
+    {
+        // An interrupt is being serviced instead of the next instruction
+        materializeFlags();
+        publishRegisterChanges();
+    }
+    else if (complete())
+    {
+        // Read next instruction byte. This 8-bit value is used to index
+        // the translation table to get the relevant information about
+        // how to implement the instruction
+        const PredecodedInstruction *instruction = _predecode ? predecodedAt(registers().program_counter) : nullptr;
+
+        if (instruction)
+            instruction->handler(*this, instruction->operand);
+        else
+            executeInstruction(read(registers().program_counter));
+
+        // Anyone may be looking at the status register between clock() calls
+        materializeFlags();
+
+        // Let whoever is listening know about what has changed
+        publishRegisterChanges();
+    }
+
+    // Increment global clock count - This is actually unused unless logging is enabled
+    // but I've kept it in because its a handy watch variable for debugging
+    clock_ticks++;
+
+    // Decrement the number of cycles remaining for this instruction
+    _cycles--;
+}
+
+bool InstructionExecutor::atInstructionBoundary()
+{
+    if (_scheduler && (_scheduler->nextEventCycle() <= clock_ticks))
+        _scheduler->runDue(clock_ticks);
+
+    // Nothing but reset() gets past STP
+    if (_stopped)
+        return false;
+
+    if (_nmi_pending)
+    {
+        _nmi_pending = false;
+        nmi();
+        return true;
+    }
+    if (_irq_sources && (GetFlag(I) == 0))
+    {
+        irq();
+        return true;
+    }
+    return false;
+}
+
+uint64_t InstructionExecutor::cyclesUntilNextEvent() const
+{
+    if (!_scheduler)
+        return UINT64_MAX;
+
+    const uint64_t next = _scheduler->nextEventCycle();
+
+    return (next > clock_ticks) ? (next - clock_ticks) : 0;
+}
+
+uint8_t InstructionExecutor::idleLoopCycles(addressType start, addressType end, uint8_t &instructions) const
+{
+    // Only plain memory is known not to change under the loop.
+    auto peek = [this](addressType address) -> int
+                {
+                    const uint8_t *page = _read_pages[address >> 8];
+
+                    return page ? page[address & 0xFF] : -1;
+                };
+
+    const int jump = peek(end);
+
+    if (jump < 0)
+        return 0;
+
+    const INSTRUCTION &closing = instruction(static_cast<uint8_t>(jump));
+    uint8_t            cycles;
+
+    if ((closing.operate == Operation::JMP) && (closing.addrmode == AddressingMode::ABS))
+        cycles = 3;
+    else if (closing.addrmode == AddressingMode::REL)
+        cycles = ((start & 0xFF00) == ((end + 2) & 0xFF00)) ? 3 : 4; // Taken, and maybe crossing a page
+    else if ((closing.operate == Operation::WAI) || (closing.operate == Operation::STP))
+        cycles = closing.cycles; // Executing itself over and over
+    else
+        return 0;
+
+    if (start == end)
+    {
+        instructions = 1;
+        return cycles;
+    }
+
+    const int body = peek(start);
+
+    if ((body < 0) || (start + instructionLength(static_cast<uint8_t>(body)) != end))
+        return 0;
+
+    const INSTRUCTION &entry = instruction(static_cast<uint8_t>(body));
+
+    switch (entry.operate)
+    {
+    case Operation::LDA: case Operation::LDX: case Operation::LDY:
+    case Operation::BIT: case Operation::CMP: case Operation::CPX:
+    case Operation::CPY: case Operation::AND: case Operation::ORA:
+        break;
+    default:
+        return 0;
+    }
+
+    // The memory it reads has to be plain memory too, so reading it has no side effects.
+    switch (entry.addrmode)
+    {
+    case AddressingMode::IMM:
+        break;
+    case AddressingMode::ZP0:
+        if (!_read_pages[0x00])
+            return 0;
+        break;
+    case AddressingMode::ABS:
+    {
+        const int page = peek(static_cast<addressType>(start + 2));
+
+        if ((page < 0) || !_read_pages[page])
+            return 0;
+        break;
+    }
+    default:
+        return 0;
+    }
+
+    instructions = 2;
+    return entry.cycles + cycles;
+}
+
+// The rest of the executor goes through here, to the copy of it for its
+// instruction set.
+template<typename Isa>
+void InstructionExecutor::interpret(uint8_t opcode)
+{
+    _opcode = opcode;
+
+#if 0
+    uint16_t log_pc = registers().program_counter; // For logging
+#endif
+
+    // Always set the unused status flag bit to 1
+    SetFlag(U, true);
+
+    // Increment program counter, we read the opcode byte
+    registers().program_counter++;
+
+#ifdef INSTRUCTIONEXECUTOR_SWITCH_DISPATCH
+    dispatch<Isa>(_opcode);
+#else
+    // Get Starting number of cycles
+    const INSTRUCTION &instruction = Isa::lookup[_opcode];
+
+    _cycles = instruction.cycles;
+    _implied = (instruction.addrmode == AddressingMode::IMP);
+
+    // Perform fetch of intermmediate data using the
+    // required addressing mode
+    uint8_t additional_cycle1 = (this->*addressingModeOf<Isa>(instruction))();
+
+    // Perform operation
+    uint8_t additional_cycle2 = (this->*operationOf<Isa>(instruction))();
+
+    // The addressmode and opcode may have altered the number
+    // of cycles this instruction requires before its completed
+    _cycles += (additional_cycle1 & additional_cycle2);
+#endif
+
+    // Always set the unused status flag bit to 1
+    SetFlag(U, true);
+
+#if 0
+    if (log())
+    {
+        // This logger dumps every cycle the entire processor state for analysis.
+        // This can be used for debugging the emulation, but has little utility
+        // during emulation. Its also very slow, so only use if you have to.
+        qDebug("%10d:%02d PC:%04X %s A:%02X X:%02X Y:%02X %s%s%s%s%s%s%s%s STKP:%02X\n",
+               clock_ticks, 0, log_pc, "XXX", registers().a, registers().x, registers().y,
+               GetFlag(N) ? "N" : ".",	GetFlag(V) ? "V" : ".",	GetFlag(U) ? "U" : ".",
+               GetFlag(B) ? "B" : ".",	GetFlag(D) ? "D" : ".",	GetFlag(I) ? "I" : ".",
+               GetFlag(Z) ? "Z" : ".",	GetFlag(C) ? "C" : ".",	registers().stack_pointer);
+    }
+#endif
+}
+
+void InstructionExecutor::materializeFlags()
+{
+    if (_pending_flags & Z)
+        _registers.SetFlag(Z, _nz_result == 0x00);
+    if (_pending_flags & N)
+        _registers.SetFlag(N, _nz_result & 0x80);
+    if (_pending_flags & V)
+        _registers.SetFlag(V, ~(_v_operand1 ^ _v_operand2) & (_v_operand1 ^ _v_result) & 0x80);
+    _pending_flags = 0;
+}
+
+void InstructionExecutor::setRegistersChangedDelegate(registersChangedDelegate registers_changed)
+{
+    _registers_changed = registers_changed;
+    _published = registers();
+}
+
+void InstructionExecutor::publishRegisterChanges()
+{
+    if (!_registers_changed)
+        return;
+
+    uint8_t changed = 0;
+
+    if (registers().a != _published.a)
+        changed |= REG_A;
+    if (registers().x != _published.x)
+        changed |= REG_X;
+    if (registers().y != _published.y)
+        changed |= REG_Y;
+    if (registers().stack_pointer != _published.stack_pointer)
+        changed |= REG_STKP;
+    if (registers().program_counter != _published.program_counter)
+        changed |= REG_PC;
+    if (registers().status != _published.status)
+        changed |= REG_STATUS;
+
+    if (changed)
+    {
+        _published = registers();
+        _registers_changed(_published, changed);
+    }
+}
+
+auto InstructionExecutor::runCycles(uint64_t cycle_budget) -> RunResult
+{
+    return run(cycle_budget, UINT64_MAX, nullptr);
+}
+
+auto InstructionExecutor::runInstructions(uint64_t instruction_budget) -> RunResult
+{
+    return run(UINT64_MAX, instruction_budget, nullptr);
+}
+
+auto InstructionExecutor::runUntil(const runPredicate &predicate, uint64_t cycle_budget) -> RunResult
+{
+    return run(cycle_budget, UINT64_MAX, &predicate);
+}
+
+// The batch loop. Instead of counting an instruction down one clock() call
+// at a time, the cycles of a whole instruction are consumed in one step,
+// and register changes are only published once at the very end.
+auto InstructionExecutor::run(uint64_t cycle_budget, uint64_t instruction_budget, const runPredicate *predicate) -> RunResult
+{
+    RunResult result;
+
+    // The instruction we start on is always executed, so that calling
+    // again after stopping at a breakpoint (or a BRK) makes progress.
+    bool check_stops = !complete();
+
+    // The last loop closed by jumping a short way back, and how many
+    // instructions ago.  Going round it again unchanged makes it an idle loop.
+    const bool  detect_idle       = _skip_idle_loops && !predicate && _breakpoints.empty();
+    const bool  fuse              = _fuse && !predicate && _breakpoints.empty();
+    bool        loop_known        = false;
+    addressType loop_start        = 0;
+    addressType loop_end          = 0;
+    uint64_t    loop_closed_at    = 0;
+    uint8_t     loop_cycles       = 0;
+    uint8_t     loop_instructions = 0;
+    bool        in_idle_loop      = false;
+
+    for (;;)
+    {
+        // Let the instruction in progress run down, within the budget.
+        if (!complete())
+        {
+            uint64_t cycles = std::min<uint64_t>(_cycles, cycle_budget - result.cycles);
+
+            _cycles -= static_cast<uint8_t>(cycles);
+            clock_ticks += cycles;
+            result.cycles += cycles;
+            if (!complete())
+                break;
+        }
+
+        if ((result.cycles >= cycle_budget) || (result.instructions >= instruction_budget))
+            break;
+
+        // What an event does may let the loop out, so it has to go round unchanged again first.
+        if (loop_known && (cyclesUntilNextEvent() == 0))
+        {
+            loop_known   = false;
+            in_idle_loop = false;
+        }
+
+        // The interrupt's cycles are run down at the top of the loop
+        if ((_scheduler || _nmi_pending || _irq_sources) && atInstructionBoundary())
+            continue;
+
+        if (predicate)
+        {
+            materializeFlags();
+            if ((*predicate)(registers()))
+            {
+                result.reason = StopReason::Condition;
+                break;
+            }
+        }
+
+        // Nothing can change until the next event, so skip whole passes up to it.
+        if (in_idle_loop && (registers().program_counter == loop_start))
+        {
+            const uint64_t span   = std::min(cycle_budget - result.cycles, cyclesUntilNextEvent());
+            uint64_t       passes = span / loop_cycles;
+
+            if (instruction_budget != UINT64_MAX)
+                passes = std::min<uint64_t>(passes, (instruction_budget - result.instructions) / loop_instructions);
+            if (passes > 0)
+            {
+                clock_ticks += passes * loop_cycles;
+                result.cycles += passes * loop_cycles;
+                result.instructions += passes * loop_instructions;
+                loop_closed_at += passes * loop_instructions;
+                check_stops = true;
+                continue;
+            }
+        }
+
+        // Whole blocks of compiled code are only entered where every one of
+        // their instructions would have passed the checks made here.  They
+        // leave straight after an instruction which raises an interrupt, so
+        // it is serviced at the next boundary, and must finish before the
+        // next event is due.
+        if (_recompiler && check_stops && !predicate && _breakpoints.empty() && !_nmi_pending && !_irq_sources)
+        {
+            const BlockRecompiler::Block *block       = _recompiler->blockAt(registers().program_counter);
+            const uint64_t                block_budget = std::min(cycle_budget - result.cycles, cyclesUntilNextEvent());
+
+            if (block &&
+                (block->worst_cycles <= block_budget) &&
+                (block->instructions <= instruction_budget - result.instructions))
+            {
+                // Looping within the block is only allowed while instructions aren't being counted.
+                uint64_t loop_budget = (instruction_budget == UINT64_MAX) ? block_budget : 0;
+                auto block_result = _recompiler->run(*block, loop_budget);
+
+                clock_ticks += block_result.cycles;
+                result.cycles += block_result.cycles;
+                result.instructions += block_result.instructions;
+                continue;
+            }
+        }
+
+        const PredecodedInstruction *predecoded = _predecode ? predecodedAt(registers().program_counter) : nullptr;
+        addressType                  address    = registers().program_counter;
+        const uint8_t                opcode     = predecoded ? predecoded->opcode : read(registers().program_counter);
+
+        if (check_stops)
+        {
+            if (!_breakpoints.empty() && hasBreakpoint(registers().program_counter))
+                result.reason = StopReason::Breakpoint;
+            else if (instruction(opcode).operate == Operation::BRK)
+                result.reason = StopReason::Break;
+            else if (instruction(opcode).operate == Operation::XXX)
+                result.reason = StopReason::IllegalOpcode;
+            if (result.reason != StopReason::BudgetSpent)
+                break;
+        }
+        check_stops = true;
+
+        // A fused pair is only run where nothing could have come between them.
+        if (predecoded && predecoded->fused && fuse &&
+            (instruction_budget - result.instructions >= 2) &&
+            (std::min(cycle_budget - result.cycles, cyclesUntilNextEvent()) > instruction(opcode).cycles + 1u))
+        {
+            if (predecoded->fused(*this, *predecoded) == 2)
+            {
+                result.instructions++;
+                address = static_cast<addressType>(address + predecoded->length);
+            }
+        }
+        else if (predecoded)
+            predecoded->handler(*this, predecoded->operand);
+        else
+            executeInstruction(opcode);
+        result.instructions++;
+
+        if (detect_idle)
+        {
+            const addressType pc = registers().program_counter;
+
+            if ((pc <= address) && (address - pc <= 3))
+            {
+                if (loop_known && (pc == loop_start) && (address == loop_end))
+                    in_idle_loop = (loop_cycles > 0) && (result.instructions - loop_closed_at == loop_instructions);
+                else
+                {
+                    loop_known   = true;
+                    loop_start   = pc;
+                    loop_end     = address;
+                    loop_cycles  = idleLoopCycles(pc, address, loop_instructions);
+                    in_idle_loop = false;
+                }
+                loop_closed_at = result.instructions;
+            }
+            else if ((pc < loop_start) || (pc > loop_end))
+            {
+                loop_known   = false;
+                in_idle_loop = false;
+            }
+        }
+    }
+
+    result.idle = in_idle_loop &&
+                  (registers().program_counter >= loop_start) && (registers().program_counter <= loop_end);
+    materializeFlags();
+    publishRegisterChanges();
+    return result;
+}
+
+auto InstructionExecutor::disassemble(addressType start, addressType stop) -> disassemblyType
+{
+    size_t  addr = start; // MUST be a value type that holds more values than start!
+    uint8_t value = 0x00, lo = 0x00, hi = 0x00;
+    size_t  line_addr = 0;
+    disassemblyType mapLines;
+
+    // A convenient utility to convert variables into
+    // hex strings because "modern C++"'s method with
+    // streams is atrocious
+    auto hex = [](size_t n, uint8_t d)
+    {
+        std::string s(d, '0');
+
+        for (; d > 0; --d, n >>= 4)
+            s[d - 1] = "0123456789ABCDEF"[n & 0xF];
+        return s;
+    };
+
+    // Starting at the specified address we read an instruction
+    // byte, which in turn yields information from the lookup table
+    // as to how many additional bytes we need to read and what the
+    // addressing mode is. I need this info to assemble human readable
+    // syntax, which is different depending upon the addressing mode
+
+    // As the instruction is decoded, a std::string is assembled
+    // with the readable output
+    while (addr <= stop)
+    {
+        line_addr = addr;
+
+        // Prefix line with instruction address
+        std::string sInst = "$" + hex(addr, 4) + ": ";
+
+        // Read instruction, and get its readable name
+        uint8_t opcode = _read_delegate(addr, true); addr++;
+        sInst += std::string(_dispatch->names[opcode]) + " ";
+
+        const AddressingMode mode = instruction(opcode).addrmode;
+
+        // Get oprands from desired locations, and form the
+        // instruction based upon its addressing mode. These
+        // routines mimmick the actual fetch routine of the
+        // 6502 in order to get accurate data as part of the
+        // instruction
+        if (mode == AddressingMode::IMP)
+        {
+            sInst += " {IMP}";
+        }
+        else if (mode == AddressingMode::IMM)
+        {
+            value = _read_delegate(addr, true); addr++;
+            sInst += "#$" + hex(value, 2) + " {IMM}";
+        }
+        else if (mode == AddressingMode::ZP0)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + " {ZP0}";
+        }
+        else if (mode == AddressingMode::ZPX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + ", X {ZPX}";
+        }
+        else if (mode == AddressingMode::ZPY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + ", Y {ZPY}";
+        }
+        else if (mode == AddressingMode::IZX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "($" + hex(lo, 2) + ", X) {IZX}";
+        }
+        else if (mode == AddressingMode::IZY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "($" + hex(lo, 2) + "), Y {IZY}";
+        }
+        else if (mode == AddressingMode::ABS)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + " {ABS}";
+        }
+        else if (mode == AddressingMode::ABX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + ", X {ABX}";
+        }
+        else if (mode == AddressingMode::ABY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + ", Y {ABY}";
+        }
+        else if (mode == AddressingMode::IND)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "($" + hex((uint16_t)(hi << 8) | lo, 4) + ") {IND}";
+        }
+        else if (mode == AddressingMode::REL)
+        {
+            value = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex(value, 2) + " [$" + hex(addr + value, 4) + "] {REL}";
+        }
+        else if (mode == AddressingMode::ZPI)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "($" + hex(lo, 2) + ") {ZPI}";
+        }
+        else if (mode == AddressingMode::IAX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "($" + hex((uint16_t)(hi << 8) | lo, 4) + ", X) {IAX}";
+        }
+        else if (mode == AddressingMode::ZPR)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            value = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex(lo, 2) + ", $" + hex(value, 2) + " [$" + hex(addr + (int8_t)value, 4) + "] {ZPR}";
+        }
+
+        // Add the formed string to a std::map, using the instruction's
+        // address as the key. This makes it convenient to look for later
+        // as the instructions are variable in length, so a straight up
+        // incremental index is not sufficient.
+        mapLines[line_addr] = sInst;
+    }
+
+    return mapLines;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+// INSTRUCTION IMPLEMENTATIONS
+
+// Note: Ive started with the two most complicated instructions to emulate, which
+// ironically is addition and subtraction! Ive tried to include a detailed
+// explanation as to why they are so complex, yet so fundamental. Im also NOT
+// going to do this through the explanation of 1 and 2's complement.
+
+// Instruction: Add with Carry In
+// Function:    A = A + M + C
+// Flags Out:   C, V, N, Z
+//
+// Explanation:
+// The purpose of this function is to add a value to the accumulator and a carry bit. If
+// the result is > 255 there is an overflow setting the carry bit. Ths allows you to
+// chain together ADC instructions to add numbers larger than 8-bits. This in itself is
+// simple, however the 6502 supports the concepts of Negativity/Positivity and Signed Overflow.
+//
+// 10000100 = 128 + 4 = 132 in normal circumstances, we know this as unsigned and it allows
+// us to represent numbers between 0 and 255 (given 8 bits). The 6502 can also interpret
+// this word as something else if we assume those 8 bits represent the range -128 to +127,
+// i.e. it has become signed.
+//
+// Since 132 > 127, it effectively wraps around, through -128, to -124. This wraparound is
+// called overflow, and this is a useful to know as it indicates that the calculation has
+// gone outside the permissable range, and therefore no longer makes numeric sense.
+//
+// Note the implementation of ADD is the same in binary, this is just about how the numbers
+// are represented, so the word 10000100 can be both -124 and 132 depending upon the
+// context the programming is using it in. We can prove this!
+//
+//  10000100 =  132  or  -124
+// +00010001 = + 17      + 17
+//  ========    ===       ===     See, both are valid additions, but our interpretation of
+//  10010101 =  149  or  -107     the context changes the value, not the hardware!
+//
+// In principle under the -128 to 127 range:
+// 10000000 = -128, 11111111 = -1, 00000000 = 0, 00000000 = +1, 01111111 = +127
+// therefore negative numbers have the most significant set, positive numbers do not
+//
+// To assist us, the 6502 can set the overflow flag, if the result of the addition has
+// wrapped around. V <- ~(A^M) & A^(A+M+C) :D lol, let's work out why!
+//
+// Let's suppose we have A = 30, M = 10 and C = 0
+//          A = 30 = 00011110
+//          M = 10 = 00001010+
+//     RESULT = 40 = 00101000
+//
+// Here we have not gone out of range. The resulting significant bit has not changed.
+// So let's make a truth table to understand when overflow has occurred. Here I take
+// the MSB of each component, where R is RESULT.
+//
+// A  M  R | V | A^R | A^M |~(A^M) |
+// 0  0  0 | 0 |  0  |  0  |   1   |
+// 0  0  1 | 1 |  1  |  0  |   1   |
+// 0  1  0 | 0 |  0  |  1  |   0   |
+// 0  1  1 | 0 |  1  |  1  |   0   |  so V = ~(A^M) & (A^R)
+// 1  0  0 | 0 |  1  |  1  |   0   |
+// 1  0  1 | 0 |  0  |  1  |   0   |
+// 1  1  0 | 1 |  1  |  0  |   1   |
+// 1  1  1 | 0 |  0  |  0  |   1   |
+//
+// We can see how the above equation calculates V, based on A, M and R. V was chosen
+// based on the following hypothesis:
+//       Positive Number + Positive Number = Negative Result -> Overflow
+//       Negative Number + Negative Number = Positive Result -> Overflow
+//       Positive Number + Negative Number = Either Result -> Cannot Overflow
+//       Positive Number + Positive Number = Positive Result -> OK! No Overflow
+//       Negative Number + Negative Number = Negative Result -> OK! NO Overflow
+
+//
+// In decimal mode, the 65C02 takes a cycle longer, and the 2A03 has no
+// decimal mode at all.
+template<typename Isa>
+uint8_t InstructionExecutor::ADC()
+{
+    // Grab the data that we are adding to the accumulator
+    fetch();
+
+#ifndef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+    if ((Isa::decimal != Decimal::None) && (registers().status & D))
+    {
+        if (Isa::decimal == Decimal::Cmos)
+        {
+            decimalResult(decimalAdd65C02(registers().a, _fetched, GetFlag(C)));
+            _cycles++;
+        }
+        else
+            decimalResult(decimalAdd(registers().a, _fetched, GetFlag(C)));
+        return 1;
+    }
+#endif
+
+    // Add is performed in 16-bit domain for emulation to capture any
+    // carry bit, which will exist in bit 8 of the 16-bit word
+    _temp = (uint16_t)registers().a + (uint16_t)_fetched + (uint16_t)GetFlag(C);
+
+    // The carry flag out exists in the high byte bit 0
+    SetFlag(C, _temp > 255);
+
+    // The Zero flag is set if the result is 0, and the negative flag is
+    // set to the most significant bit of the result
+    SetNZ(_temp & 0x00FF);
+
+    // The signed Overflow flag is set based on all that up there! :D
+    SetV(registers().a, _fetched, _temp & 0x00FF);
+
+    // Load the result into the accumulator (it's 8-bit dont forget!)
+    registers().a = _temp & 0x00FF;
+
+    // This instruction has the potential to require an additional clock cycle
+    return 1;
+}
+
+// Instruction: Subtraction with Borrow In
+// Function:    A = A - M - (1 - C)
+// Flags Out:   C, V, N, Z
+//
+// Explanation:
+// Given the explanation for ADC above, we can reorganise our data
+// to use the same computation for addition, for subtraction by multiplying
+// the data by -1, i.e. make it negative
+//
+// A = A - M - (1 - C)  ->  A = A + -1 * (M - (1 - C))  ->  A = A + (-M + 1 + C)
+//
+// To make a signed positive number negative, we can invert the bits and add 1
+// (OK, I lied, a little bit of 1 and 2s complement :P)
+//
+//  5 = 00000101
+// -5 = 11111010 + 00000001 = 11111011 (or 251 in our 0 to 255 range)
+//
+// The range is actually unimportant, because if I take the value 15, and add 251
+// to it, given we wrap around at 256, the result is 10, so it has effectively
+// subtracted 5, which was the original intention. (15 + 251) % 256 = 10
+//
+// Note that the equation above used (1-C), but this got converted to + 1 + C.
+// This means we already have the +1, so all we need to do is invert the bits
+// of M, the data(!) therfore we can simply add, exactly the same way we did
+// before.
+
+template<typename Isa>
+uint8_t InstructionExecutor::SBC()
+{
+    fetch();
+
+#ifndef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+    if ((Isa::decimal != Decimal::None) && (registers().status & D))
+    {
+        if (Isa::decimal == Decimal::Cmos)
+        {
+            decimalResult(decimalSubtract65C02(registers().a, _fetched, GetFlag(C)));
+            _cycles++;
+        }
+        else
+            decimalResult(decimalSubtract(registers().a, _fetched, GetFlag(C)));
+        return 1;
+    }
+#endif
+
+    // Operating in 16-bit domain to capture carry out
+
+    // We can invert the bottom 8 bits with bitwise xor
+    uint16_t value = ((uint16_t)_fetched) ^ 0x00FF;
+
+    // Notice this is exactly the same as addition from here!
+    _temp = (uint16_t)registers().a + value + (uint16_t)GetFlag(C);
+    SetFlag(C, _temp & 0xFF00);
+    SetNZ(_temp & 0x00FF);
+    SetV(registers().a, value & 0x00FF, _temp & 0x00FF);
+    registers().a = _temp & 0x00FF;
+    return 1;
+}
+
+// In decimal mode, ADC and SBC look their results up instead.
+void InstructionExecutor::decimalResult(const DecimalResult &result)
+{
+    registers().a = result.value;
+    SetFlag(C, result.status & C);
+    SetFlag(Z, result.status & Z);
+    SetFlag(V, result.status & V);
+    SetFlag(N, result.status & N);
+}
+
+// OK! Complicated operations are done! the following are much simpler
+// and conventional. The typical order of events is:
+// 1) Fetch the data you are working with
+// 2) Perform calculation
+// 3) Store the result in desired place
+// 4) Set Flags of the status register
+// 5) Return if instruction has potential to require additional
+//    clock cycle
+
+
+// Instruction: Bitwise Logic AND
+// Function:    A = A & M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::AND()
+{
+    fetch();
+    registers().a = registers().a & _fetched;
+    SetNZ(registers().a);
+    return 1;
+}
+
+
+// Instruction: Arithmetic Shift Left
+// Function:    A = C <- (A << 1) <- 0
+// Flags Out:   N, Z, C
+template<typename Isa>
+uint8_t InstructionExecutor::ASL()
+{
+    fetch();
+    _temp = (uint16_t)_fetched << 1;
+    SetFlag(C, (_temp & 0xFF00) > 0);
+    SetNZ(_temp & 0x00FF);
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    return Isa::shift_page_penalty ? 1 : 0;
+}
+
+
+// Instruction: Branch if Carry Clear
+// Function:    if(C == 0) pc = address
+uint8_t InstructionExecutor::BCC()
+{
+    if (GetFlag(C) == 0)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+
+// Instruction: Branch if Carry Set
+// Function:    if(C == 1) pc = address
+uint8_t InstructionExecutor::BCS()
+{
+    if (GetFlag(C) == 1)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Equal
+// Function:    if(Z == 1) pc = address
+uint8_t InstructionExecutor::BEQ()
+{
+    if (GetFlag(Z) == 1)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Test Bits
+// Function:    Z <- (A & M) == 0    N <- M bit 7    V <- M bit 6
+// Note:        The 65C02's BIT #imm only sets Z. Its BIT abs,X may take
+//              a cycle more across a page.
+uint8_t InstructionExecutor::BIT()
+{
+    fetch();
+    _temp = registers().a & _fetched;
+    SetFlag(Z, (_temp & 0x00FF) == 0x00);
+    if (_opcode != 0x89)
+    {
+        SetFlag(N, _fetched & (1 << 7));
+        SetFlag(V, _fetched & (1 << 6));
+    }
+    return 1;
+}
+
+// Instruction: Branch if Negative
+// Function:    if(N == 1) pc = address
+uint8_t InstructionExecutor::BMI()
+{
+    if (GetFlag(N) == 1)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+
+// Instruction: Branch if Not Equal
+// Function:    if(Z == 0) pc = address
+uint8_t InstructionExecutor::BNE()
+{
+    if (GetFlag(Z) == 0)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Positive
+// Function:    if(N == 0) pc = address
+uint8_t InstructionExecutor::BPL()
+{
+    if (GetFlag(N) == 0)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Break
+// Function:    Program Sourced Interrupt
+// Note:        The 65C02 clears D, as it does for any interrupt
+template<typename Isa>
+uint8_t InstructionExecutor::BRK()
+{
+    registers().program_counter++;
+
+    SetFlag(I, 1);
+    write(0x0100 + registers().stack_pointer, (registers().program_counter >> 8) & 0x00FF);
+    registers().stack_pointer--;
+    write(0x0100 + registers().stack_pointer, registers().program_counter & 0x00FF);
+    registers().stack_pointer--;
+
+    SetFlag(B, 1);
+    materializeFlags();
+    write(0x0100 + registers().stack_pointer, registers().status);
+    registers().stack_pointer--;
+    SetFlag(B, 0);
+    if (Isa::interrupts_clear_decimal)
+        SetFlag(D, 0);
+
+    registers().program_counter = (uint16_t)read(0xFFFE) | ((uint16_t)read(0xFFFF) << 8);
+    return 0;
+}
+
+// Instruction: Branch if Overflow Clear
+// Function:    if(V == 0) pc = address
+uint8_t InstructionExecutor::BVC()
+{
+    if (GetFlag(V) == 0)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Overflow Set
+// Function:    if(V == 1) pc = address
+uint8_t InstructionExecutor::BVS()
+{
+    if (GetFlag(V) == 1)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Clear Carry Flag
+// Function:    C = 0
+uint8_t InstructionExecutor::CLC()
+{
+    SetFlag(C, false);
+    return 0;
+}
+
+// Instruction: Clear Decimal Flag
+// Function:    D = 0
+uint8_t InstructionExecutor::CLD()
+{
+    SetFlag(D, false);
+    return 0;
+}
+
+// Instruction: Disable Interrupts / Clear Interrupt Flag
+// Function:    I = 0
+uint8_t InstructionExecutor::CLI()
+{
+    SetFlag(I, false);
+    return 0;
+}
+
+
+// Instruction: Clear Overflow Flag
+// Function:    V = 0
+uint8_t InstructionExecutor::CLV()
+{
+    SetFlag(V, false);
+    return 0;
+}
+
+// Instruction: Compare Accumulator
+// Function:    C <- A >= M      Z <- (A - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CMP()
+{
+    fetch();
+    _temp = (uint16_t)registers().a - (uint16_t)_fetched;
+    SetFlag(C, registers().a >= _fetched);
+    SetNZ(_temp & 0x00FF);
+    return 1;
+}
+
+
+// Instruction: Compare X Register
+// Function:    C <- X >= M      Z <- (X - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CPX()
+{
+    fetch();
+    _temp = (uint16_t)registers().x - (uint16_t)_fetched;
+    SetFlag(C, registers().x >= _fetched);
+    SetNZ(_temp & 0x00FF);
+    return 0;
+}
+
+// Instruction: Compare Y Register
+// Function:    C <- Y >= M      Z <- (Y - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CPY()
+{
+    fetch();
+    _temp = (uint16_t)registers().y - (uint16_t)_fetched;
+    SetFlag(C, registers().y >= _fetched);
+    SetNZ(_temp & 0x00FF);
+    return 0;
+}
+
+// Instruction: Decrement Value at Memory Location
+// Function:    M = M - 1
+// Flags Out:   N, Z
+// Note:        The 65C02 can decrement the accumulator too
+uint8_t InstructionExecutor::DEC()
+{
+    fetch();
+    _temp = _fetched - 1;
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    SetNZ(_temp & 0x00FF);
+    return 0;
+}
+
+// Instruction: Decrement X Register
+// Function:    X = X - 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::DEX()
+{
+    registers().x--;
+    SetNZ(registers().x);
+    return 0;
+}
+
+
+// Instruction: Decrement Y Register
+// Function:    Y = Y - 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::DEY()
+{
+    registers().y--;
+    SetNZ(registers().y);
+    return 0;
+}
+
+
+// Instruction: Bitwise Logic XOR
+// Function:    A = A xor M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::EOR()
+{
+    fetch();
+    registers().a = registers().a ^ _fetched;
+    SetNZ(registers().a);
+    return 1;
+}
+
+// Instruction: Increment Value at Memory Location
+// Function:    M = M + 1
+// Flags Out:   N, Z
+// Note:        The 65C02 can increment the accumulator too
+uint8_t InstructionExecutor::INC()
+{
+    fetch();
+    _temp = _fetched + 1;
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    SetNZ(_temp & 0x00FF);
+    return 0;
+}
+
+
+// Instruction: Increment X Register
+// Function:    X = X + 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::INX()
+{
+    registers().x++;
+    SetNZ(registers().x);
+    return 0;
+}
+
+
+// Instruction: Increment Y Register
+// Function:    Y = Y + 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::INY()
+{
+    registers().y++;
+    SetNZ(registers().y);
+    return 0;
+}
+
+
+// Instruction: Jump To Location
+// Function:    pc = address
+uint8_t InstructionExecutor::JMP()
+{
+    registers().program_counter = _addr_abs;
+    return 0;
+}
+
+
+// Instruction: Jump To Sub-Routine
+// Function:    Push current pc to stack, pc = address
+uint8_t InstructionExecutor::JSR()
+{
+    registers().program_counter--;
+
+    write(0x0100 + registers().stack_pointer, (registers().program_counter >> 8) & 0x00FF);
+    registers().stack_pointer--;
+    write(0x0100 + registers().stack_pointer, registers().program_counter & 0x00FF);
+    registers().stack_pointer--;
+
+    registers().program_counter = _addr_abs;
+    return 0;
+}
+
+// Instruction: Load The Accumulator
+// Function:    A = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDA()
+{
+    fetch();
+    registers().a = _fetched;
+    SetNZ(registers().a);
+    return 1;
+}
+
+
+// Instruction: Load The X Register
+// Function:    X = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDX()
+{
+    fetch();
+    registers().x = _fetched;
+    SetNZ(registers().x);
+    return 1;
+}
+
+
+// Instruction: Load The Y Register
+// Function:    Y = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDY()
+{
+    fetch();
+    registers().y = _fetched;
+    SetNZ(registers().y);
+    return 1;
+}
+
+template<typename Isa>
+uint8_t InstructionExecutor::LSR()
+{
+    fetch();
+    SetFlag(C, _fetched & 0x0001);
+    _temp = _fetched >> 1;
+    SetNZ(_temp & 0x00FF);
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    return Isa::shift_page_penalty ? 1 : 0;
+}
+
+uint8_t InstructionExecutor::NOP()
+{
+    // Sadly not all NOPs are equal, Ive added a few here
+    // based on https://wiki.nesdev.com/w/index.php/CPU_unofficial_opcodes
+    // and will add more based on game compatibility, and ultimately
+    // I'd like to cover all illegal opcodes too
+    switch (_opcode) {
+    case 0x1C:
+    case 0x3C:
+    case 0x5C:
+    case 0x7C:
+    case 0xDC:
+    case 0xFC:
+        return 1;
+        break;
+    }
+    return 0;
+}
+
+// Instruction: Bitwise Logic OR
+// Function:    A = A | M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::ORA()
+{
+    fetch();
+    registers().a = registers().a | _fetched;
+    SetNZ(registers().a);
+    return 1;
+}
+
+
+// Instruction: Push Accumulator to Stack
+// Function:    A -> stack
+uint8_t InstructionExecutor::PHA()
+{
+    write(0x0100 + registers().stack_pointer, registers().a);
+    registers().stack_pointer--;
+    return 0;
+}
+
+
+// Instruction: Push Status Register to Stack
+// Function:    status -> stack
+// Note:        Break flag is set to 1 before push
+uint8_t InstructionExecutor::PHP()
+{
+    materializeFlags();
+    write(0x0100 + registers().stack_pointer, registers().status | B | U);
+    SetFlag(B, 0);
+    SetFlag(U, 0);
+    registers().stack_pointer--;
+    return 0;
+}
+
+// Instruction: Pop Accumulator off Stack
+// Function:    A <- stack
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::PLA()
+{
+    registers().stack_pointer++;
+    registers().a = read(0x0100 + registers().stack_pointer);
+    SetNZ(registers().a);
+    return 0;
+}
+
+
+// Instruction: Pop Status Register off Stack
+// Function:    Status <- stack
+uint8_t InstructionExecutor::PLP()
+{
+    registers().stack_pointer++;
+    registers().status = read(0x0100 + registers().stack_pointer);
+    _pending_flags = 0;
+    SetFlag(U, 1);
+    return 0;
+}
+
+template<typename Isa>
+uint8_t InstructionExecutor::ROL()
+{
+    fetch();
+    _temp = (uint16_t)(_fetched << 1) | GetFlag(C);
+    SetFlag(C, _temp & 0xFF00);
+    SetNZ(_temp & 0x00FF);
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    return Isa::shift_page_penalty ? 1 : 0;
+}
+
+template<typename Isa>
+uint8_t InstructionExecutor::ROR()
+{
+    fetch();
+    _temp = (uint16_t)(GetFlag(C) << 7) | (_fetched >> 1);
+    SetFlag(C, _fetched & 0x01);
+    SetNZ(_temp & 0x00FF);
+    if (_implied)
+        registers().a = _temp & 0x00FF;
+    else
+        write(_addr_abs, _temp & 0x00FF);
+    return Isa::shift_page_penalty ? 1 : 0;
+}
+
+uint8_t InstructionExecutor::RTI()
+{
+    registers().stack_pointer++;
+    registers().status = read(0x0100 + registers().stack_pointer);
+    _pending_flags = 0;
+    registers().status &= ~B;
+    registers().status &= ~U;
+
+    registers().stack_pointer++;
+    registers().program_counter = (uint16_t)read(0x0100 + registers().stack_pointer);
+    registers().stack_pointer++;
+    registers().program_counter |= (uint16_t)read(0x0100 + registers().stack_pointer) << 8;
+    return 0;
+}
+
+uint8_t InstructionExecutor::RTS()
+{
+    registers().stack_pointer++;
+    registers().program_counter = (uint16_t)read(0x0100 + registers().stack_pointer);
+    registers().stack_pointer++;
+    registers().program_counter |= (uint16_t)read(0x0100 + registers().stack_pointer) << 8;
+
+    registers().program_counter++;
+    return 0;
+}
+
+// Instruction: Set Carry Flag
+// Function:    C = 1
+uint8_t InstructionExecutor::SEC()
+{
+    SetFlag(C, true);
+    return 0;
+}
+
+
+// Instruction: Set Decimal Flag
+// Function:    D = 1
+uint8_t InstructionExecutor::SED()
+{
+    SetFlag(D, true);
+    return 0;
+}
+
+
+// Instruction: Set Interrupt Flag / Enable Interrupts
+// Function:    I = 1
+uint8_t InstructionExecutor::SEI()
+{
+    SetFlag(I, true);
+    return 0;
+}
+
+
+// Instruction: Store Accumulator at Address
+// Function:    M = A
+uint8_t InstructionExecutor::STA()
+{
+    write(_addr_abs, registers().a);
+    return 0;
+}
+
+
+// Instruction: Store X Register at Address
+// Function:    M = X
+uint8_t InstructionExecutor::STX()
+{
+    write(_addr_abs, registers().x);
+    return 0;
+}
+
+
+// Instruction: Store Y Register at Address
+// Function:    M = Y
+uint8_t InstructionExecutor::STY()
+{
+    write(_addr_abs, registers().y);
+    return 0;
+}
+
+// Instruction: Transfer Accumulator to X Register
+// Function:    X = A
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TAX()
+{
+    registers().x = registers().a;
+    SetNZ(registers().x);
+    return 0;
+}
+
+
+// Instruction: Transfer Accumulator to Y Register
+// Function:    Y = A
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TAY()
+{
+    registers().y = registers().a;
+    SetNZ(registers().y);
+    return 0;
+}
+
+
+// Instruction: Transfer Stack Pointer to X Register
+// Function:    X = stack pointer
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TSX()
+{
+    registers().x = registers().stack_pointer;
+    SetNZ(registers().x);
+    return 0;
+}
+
+
+// Instruction: Transfer X Register to Accumulator
+// Function:    A = X
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TXA()
+{
+    registers().a = registers().x;
+    SetNZ(registers().a);
+    return 0;
+}
+
+
+// Instruction: Transfer X Register to Stack Pointer
+// Function:    stack pointer = X
+uint8_t InstructionExecutor::TXS()
+{
+    registers().stack_pointer = registers().x;
+    return 0;
+}
+
+// Instruction: Transfer Y Register to Accumulator
+// Function:    A = Y
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TYA()
+{
+    registers().a = registers().y;
+    SetNZ(registers().a);
+    return 0;
+}
+
+
+// This function captures illegal opcodes
+uint8_t InstructionExecutor::XXX()
+{
+    return 0;
+}
+
+
+// THE 65C02'S INSTRUCTIONS
+
+// Instruction: Branch on Bit Reset
+// Function:    if(M bit n == 0) pc = address, n being the top 3 bits of the opcode
+uint8_t InstructionExecutor::BBR()
+{
+    fetch();
+    if ((_fetched & (1 << ((_opcode >> 4) & 0x07))) == 0)
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch on Bit Set
+// Function:    if(M bit n == 1) pc = address
+uint8_t InstructionExecutor::BBS()
+{
+    fetch();
+    if (_fetched & (1 << ((_opcode >> 4) & 0x07)))
+    {
+        _cycles++;
+        _addr_abs = registers().program_counter + _addr_rel;
+
+        if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+            _cycles++;
+
+        registers().program_counter = _addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch Always
+// Function:    pc = address
+uint8_t InstructionExecutor::BRA()
+{
+    _cycles++;
+    _addr_abs = registers().program_counter + _addr_rel;
+
+    if ((_addr_abs & 0xFF00) != (registers().program_counter & 0xFF00))
+        _cycles++;
+
+    registers().program_counter = _addr_abs;
+    return 0;
+}
+
+// Instruction: Push X Register to Stack
+// Function:    X -> stack
+uint8_t InstructionExecutor::PHX()
+{
+    write(0x0100 + registers().stack_pointer, registers().x);
+    registers().stack_pointer--;
+    return 0;
+}
+
+// Instruction: Push Y Register to Stack
+// Function:    Y -> stack
+uint8_t InstructionExecutor::PHY()
+{
+    write(0x0100 + registers().stack_pointer, registers().y);
+    registers().stack_pointer--;
+    return 0;
+}
+
+// Instruction: Pop X Register off Stack
+// Function:    X <- stack
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::PLX()
+{
+    registers().stack_pointer++;
+    registers().x = read(0x0100 + registers().stack_pointer);
+    SetNZ(registers().x);
+    return 0;
+}
+
+// Instruction: Pop Y Register off Stack
+// Function:    Y <- stack
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::PLY()
+{
+    registers().stack_pointer++;
+    registers().y = read(0x0100 + registers().stack_pointer);
+    SetNZ(registers().y);
+    return 0;
+}
+
+// Instruction: Reset Memory Bit
+// Function:    M bit n = 0, n being the top 3 bits of the opcode
+uint8_t InstructionExecutor::RMB()
+{
+    fetch();
+    write(_addr_abs, _fetched & ~(1 << ((_opcode >> 4) & 0x07)));
+    return 0;
+}
+
+// Instruction: Set Memory Bit
+// Function:    M bit n = 1
+uint8_t InstructionExecutor::SMB()
+{
+    fetch();
+    write(_addr_abs, _fetched | (1 << ((_opcode >> 4) & 0x07)));
+    return 0;
+}
+
+// Instruction: Stop the Clock
+// Function:    Nothing more happens until reset()
+uint8_t InstructionExecutor::STP()
+{
+    registers().program_counter--;
+    _stopped = true;
+    return 0;
+}
+
+// Instruction: Store Zero at Address
+// Function:    M = 0
+uint8_t InstructionExecutor::STZ()
+{
+    write(_addr_abs, 0x00);
+    return 0;
+}
+
+// Instruction: Test and Reset Bits
+// Function:    Z <- (A & M) == 0    M = M & ~A
+uint8_t InstructionExecutor::TRB()
+{
+    fetch();
+    SetFlag(Z, (registers().a & _fetched) == 0x00);
+    write(_addr_abs, _fetched & ~registers().a);
+    return 0;
+}
+
+// Instruction: Test and Set Bits
+// Function:    Z <- (A & M) == 0    M = M | A
+uint8_t InstructionExecutor::TSB()
+{
+    fetch();
+    SetFlag(Z, (registers().a & _fetched) == 0x00);
+    write(_addr_abs, _fetched | registers().a);
+    return 0;
+}
+
+// Instruction: Wait for Interrupt
+// Function:    Nothing happens until an interrupt comes along
+// Note:        It executes itself until then. An interrupt taken while
+//              waiting returns past it, and an IRQ which is masked just
+//              lets it finish.
+uint8_t InstructionExecutor::WAI()
+{
+    _waiting = !_nmi_pending && !_irq_sources;
+    if (_waiting)
+        registers().program_counter--;
+    return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// SWITCH DISPATCH
+
+// This is the same as the body of executeInstruction() when it goes through
+// the translation table, but the opcode is a compile time constant. Its table
+// entry, and so the member functions it indexes, are known to the compiler,
+// which turns the calls through them into direct calls it is free to inline,
+// and folds away the check for implied addressing.
+template<typename Isa, uint8_t Opcode>
+void InstructionExecutor::execute()
+{
+    constexpr INSTRUCTION instruction = Isa::lookup[Opcode];
+
+    _cycles = instruction.cycles;
+    _implied = (instruction.addrmode == AddressingMode::IMP);
+
+    uint8_t additional_cycle1 = (this->*addressingModeOf<Isa>(instruction))();
+    uint8_t additional_cycle2 = (this->*operationOf<Isa>(instruction))();
+
+    _cycles += (additional_cycle1 & additional_cycle2);
+}
+
+// One case per opcode. Everything about each one comes from the translation
+// table, so the two can't get out of step.
+template<typename Isa>
+void InstructionExecutor::dispatch(uint8_t opcode)
+{
+    switch (opcode)
+    {
+    case 0x00: execute<Isa, 0x00>(); break; case 0x01: execute<Isa, 0x01>(); break; case 0x02: execute<Isa, 0x02>(); break; case 0x03: execute<Isa, 0x03>(); break;
+    case 0x04: execute<Isa, 0x04>(); break; case 0x05: execute<Isa, 0x05>(); break; case 0x06: execute<Isa, 0x06>(); break; case 0x07: execute<Isa, 0x07>(); break;
+    case 0x08: execute<Isa, 0x08>(); break; case 0x09: execute<Isa, 0x09>(); break; case 0x0A: execute<Isa, 0x0A>(); break; case 0x0B: execute<Isa, 0x0B>(); break;
+    case 0x0C: execute<Isa, 0x0C>(); break; case 0x0D: execute<Isa, 0x0D>(); break; case 0x0E: execute<Isa, 0x0E>(); break; case 0x0F: execute<Isa, 0x0F>(); break;
+    case 0x10: execute<Isa, 0x10>(); break; case 0x11: execute<Isa, 0x11>(); break; case 0x12: execute<Isa, 0x12>(); break; case 0x13: execute<Isa, 0x13>(); break;
+    case 0x14: execute<Isa, 0x14>(); break; case 0x15: execute<Isa, 0x15>(); break; case 0x16: execute<Isa, 0x16>(); break; case 0x17: execute<Isa, 0x17>(); break;
+    case 0x18: execute<Isa, 0x18>(); break; case 0x19: execute<Isa, 0x19>(); break; case 0x1A: execute<Isa, 0x1A>(); break; case 0x1B: execute<Isa, 0x1B>(); break;
+    case 0x1C: execute<Isa, 0x1C>(); break; case 0x1D: execute<Isa, 0x1D>(); break; case 0x1E: execute<Isa, 0x1E>(); break; case 0x1F: execute<Isa, 0x1F>(); break;
+    case 0x20: execute<Isa, 0x20>(); break; case 0x21: execute<Isa, 0x21>(); break; case 0x22: execute<Isa, 0x22>(); break; case 0x23: execute<Isa, 0x23>(); break;
+    case 0x24: execute<Isa, 0x24>(); break; case 0x25: execute<Isa, 0x25>(); break; case 0x26: execute<Isa, 0x26>(); break; case 0x27: execute<Isa, 0x27>(); break;
+    case 0x28: execute<Isa, 0x28>(); break; case 0x29: execute<Isa, 0x29>(); break; case 0x2A: execute<Isa, 0x2A>(); break; case 0x2B: execute<Isa, 0x2B>(); break;
+    case 0x2C: execute<Isa, 0x2C>(); break; case 0x2D: execute<Isa, 0x2D>(); break; case 0x2E: execute<Isa, 0x2E>(); break; case 0x2F: execute<Isa, 0x2F>(); break;
+    case 0x30: execute<Isa, 0x30>(); break; case 0x31: execute<Isa, 0x31>(); break; case 0x32: execute<Isa, 0x32>(); break; case 0x33: execute<Isa, 0x33>(); break;
+    case 0x34: execute<Isa, 0x34>(); break; case 0x35: execute<Isa, 0x35>(); break; case 0x36: execute<Isa, 0x36>(); break; case 0x37: execute<Isa, 0x37>(); break;
+    case 0x38: execute<Isa, 0x38>(); break; case 0x39: execute<Isa, 0x39>(); break; case 0x3A: execute<Isa, 0x3A>(); break; case 0x3B: execute<Isa, 0x3B>(); break;
+    case 0x3C: execute<Isa, 0x3C>(); break; case 0x3D: execute<Isa, 0x3D>(); break; case 0x3E: execute<Isa, 0x3E>(); break; case 0x3F: execute<Isa, 0x3F>(); break;
+    case 0x40: execute<Isa, 0x40>(); break; case 0x41: execute<Isa, 0x41>(); break; case 0x42: execute<Isa, 0x42>(); break; case 0x43: execute<Isa, 0x43>(); break;
+    case 0x44: execute<Isa, 0x44>(); break; case 0x45: execute<Isa, 0x45>(); break; case 0x46: execute<Isa, 0x46>(); break; case 0x47: execute<Isa, 0x47>(); break;
+    case 0x48: execute<Isa, 0x48>(); break; case 0x49: execute<Isa, 0x49>(); break; case 0x4A: execute<Isa, 0x4A>(); break; case 0x4B: execute<Isa, 0x4B>(); break;
+    case 0x4C: execute<Isa, 0x4C>(); break; case 0x4D: execute<Isa, 0x4D>(); break; case 0x4E: execute<Isa, 0x4E>(); break; case 0x4F: execute<Isa, 0x4F>(); break;
+    case 0x50: execute<Isa, 0x50>(); break; case 0x51: execute<Isa, 0x51>(); break; case 0x52: execute<Isa, 0x52>(); break; case 0x53: execute<Isa, 0x53>(); break;
+    case 0x54: execute<Isa, 0x54>(); break; case 0x55: execute<Isa, 0x55>(); break; case 0x56: execute<Isa, 0x56>(); break; case 0x57: execute<Isa, 0x57>(); break;
+    case 0x58: execute<Isa, 0x58>(); break; case 0x59: execute<Isa, 0x59>(); break; case 0x5A: execute<Isa, 0x5A>(); break; case 0x5B: execute<Isa, 0x5B>(); break;
+    case 0x5C: execute<Isa, 0x5C>(); break; case 0x5D: execute<Isa, 0x5D>(); break; case 0x5E: execute<Isa, 0x5E>(); break; case 0x5F: execute<Isa, 0x5F>(); break;
+    case 0x60: execute<Isa, 0x60>(); break; case 0x61: execute<Isa, 0x61>(); break; case 0x62: execute<Isa, 0x62>(); break; case 0x63: execute<Isa, 0x63>(); break;
+    case 0x64: execute<Isa, 0x64>(); break; case 0x65: execute<Isa, 0x65>(); break; case 0x66: execute<Isa, 0x66>(); break; case 0x67: execute<Isa, 0x67>(); break;
+    case 0x68: execute<Isa, 0x68>(); break; case 0x69: execute<Isa, 0x69>(); break; case 0x6A: execute<Isa, 0x6A>(); break; case 0x6B: execute<Isa, 0x6B>(); break;
+    case 0x6C: execute<Isa, 0x6C>(); break; case 0x6D: execute<Isa, 0x6D>(); break; case 0x6E: execute<Isa, 0x6E>(); break; case 0x6F: execute<Isa, 0x6F>(); break;
+    case 0x70: execute<Isa, 0x70>(); break; case 0x71: execute<Isa, 0x71>(); break; case 0x72: execute<Isa, 0x72>(); break; case 0x73: execute<Isa, 0x73>(); break;
+    case 0x74: execute<Isa, 0x74>(); break; case 0x75: execute<Isa, 0x75>(); break; case 0x76: execute<Isa, 0x76>(); break; case 0x77: execute<Isa, 0x77>(); break;
+    case 0x78: execute<Isa, 0x78>(); break; case 0x79: execute<Isa, 0x79>(); break; case 0x7A: execute<Isa, 0x7A>(); break; case 0x7B: execute<Isa, 0x7B>(); break;
+    case 0x7C: execute<Isa, 0x7C>(); break; case 0x7D: execute<Isa, 0x7D>(); break; case 0x7E: execute<Isa, 0x7E>(); break; case 0x7F: execute<Isa, 0x7F>(); break;
+    case 0x80: execute<Isa, 0x80>(); break; case 0x81: execute<Isa, 0x81>(); break; case 0x82: execute<Isa, 0x82>(); break; case 0x83: execute<Isa, 0x83>(); break;
+    case 0x84: execute<Isa, 0x84>(); break; case 0x85: execute<Isa, 0x85>(); break; case 0x86: execute<Isa, 0x86>(); break; case 0x87: execute<Isa, 0x87>(); break;
+    case 0x88: execute<Isa, 0x88>(); break; case 0x89: execute<Isa, 0x89>(); break; case 0x8A: execute<Isa, 0x8A>(); break; case 0x8B: execute<Isa, 0x8B>(); break;
+    case 0x8C: execute<Isa, 0x8C>(); break; case 0x8D: execute<Isa, 0x8D>(); break; case 0x8E: execute<Isa, 0x8E>(); break; case 0x8F: execute<Isa, 0x8F>(); break;
+    case 0x90: execute<Isa, 0x90>(); break; case 0x91: execute<Isa, 0x91>(); break; case 0x92: execute<Isa, 0x92>(); break; case 0x93: execute<Isa, 0x93>(); break;
+    case 0x94: execute<Isa, 0x94>(); break; case 0x95: execute<Isa, 0x95>(); break; case 0x96: execute<Isa, 0x96>(); break; case 0x97: execute<Isa, 0x97>(); break;
+    case 0x98: execute<Isa, 0x98>(); break; case 0x99: execute<Isa, 0x99>(); break; case 0x9A: execute<Isa, 0x9A>(); break; case 0x9B: execute<Isa, 0x9B>(); break;
+    case 0x9C: execute<Isa, 0x9C>(); break; case 0x9D: execute<Isa, 0x9D>(); break; case 0x9E: execute<Isa, 0x9E>(); break; case 0x9F: execute<Isa, 0x9F>(); break;
+    case 0xA0: execute<Isa, 0xA0>(); break; case 0xA1: execute<Isa, 0xA1>(); break; case 0xA2: execute<Isa, 0xA2>(); break; case 0xA3: execute<Isa, 0xA3>(); break;
+    case 0xA4: execute<Isa, 0xA4>(); break; case 0xA5: execute<Isa, 0xA5>(); break; case 0xA6: execute<Isa, 0xA6>(); break; case 0xA7: execute<Isa, 0xA7>(); break;
+    case 0xA8: execute<Isa, 0xA8>(); break; case 0xA9: execute<Isa, 0xA9>(); break; case 0xAA: execute<Isa, 0xAA>(); break; case 0xAB: execute<Isa, 0xAB>(); break;
+    case 0xAC: execute<Isa, 0xAC>(); break; case 0xAD: execute<Isa, 0xAD>(); break; case 0xAE: execute<Isa, 0xAE>(); break; case 0xAF: execute<Isa, 0xAF>(); break;
+    case 0xB0: execute<Isa, 0xB0>(); break; case 0xB1: execute<Isa, 0xB1>(); break; case 0xB2: execute<Isa, 0xB2>(); break; case 0xB3: execute<Isa, 0xB3>(); break;
+    case 0xB4: execute<Isa, 0xB4>(); break; case 0xB5: execute<Isa, 0xB5>(); break; case 0xB6: execute<Isa, 0xB6>(); break; case 0xB7: execute<Isa, 0xB7>(); break;
+    case 0xB8: execute<Isa, 0xB8>(); break; case 0xB9: execute<Isa, 0xB9>(); break; case 0xBA: execute<Isa, 0xBA>(); break; case 0xBB: execute<Isa, 0xBB>(); break;
+    case 0xBC: execute<Isa, 0xBC>(); break; case 0xBD: execute<Isa, 0xBD>(); break; case 0xBE: execute<Isa, 0xBE>(); break; case 0xBF: execute<Isa, 0xBF>(); break;
+    case 0xC0: execute<Isa, 0xC0>(); break; case 0xC1: execute<Isa, 0xC1>(); break; case 0xC2: execute<Isa, 0xC2>(); break; case 0xC3: execute<Isa, 0xC3>(); break;
+    case 0xC4: execute<Isa, 0xC4>(); break; case 0xC5: execute<Isa, 0xC5>(); break; case 0xC6: execute<Isa, 0xC6>(); break; case 0xC7: execute<Isa, 0xC7>(); break;
+    case 0xC8: execute<Isa, 0xC8>(); break; case 0xC9: execute<Isa, 0xC9>(); break; case 0xCA: execute<Isa, 0xCA>(); break; case 0xCB: execute<Isa, 0xCB>(); break;
+    case 0xCC: execute<Isa, 0xCC>(); break; case 0xCD: execute<Isa, 0xCD>(); break; case 0xCE: execute<Isa, 0xCE>(); break; case 0xCF: execute<Isa, 0xCF>(); break;
+    case 0xD0: execute<Isa, 0xD0>(); break; case 0xD1: execute<Isa, 0xD1>(); break; case 0xD2: execute<Isa, 0xD2>(); break; case 0xD3: execute<Isa, 0xD3>(); break;
+    case 0xD4: execute<Isa, 0xD4>(); break; case 0xD5: execute<Isa, 0xD5>(); break; case 0xD6: execute<Isa, 0xD6>(); break; case 0xD7: execute<Isa, 0xD7>(); break;
+    case 0xD8: execute<Isa, 0xD8>(); break; case 0xD9: execute<Isa, 0xD9>(); break; case 0xDA: execute<Isa, 0xDA>(); break; case 0xDB: execute<Isa, 0xDB>(); break;
+    case 0xDC: execute<Isa, 0xDC>(); break; case 0xDD: execute<Isa, 0xDD>(); break; case 0xDE: execute<Isa, 0xDE>(); break; case 0xDF: execute<Isa, 0xDF>(); break;
+    case 0xE0: execute<Isa, 0xE0>(); break; case 0xE1: execute<Isa, 0xE1>(); break; case 0xE2: execute<Isa, 0xE2>(); break; case 0xE3: execute<Isa, 0xE3>(); break;
+    case 0xE4: execute<Isa, 0xE4>(); break; case 0xE5: execute<Isa, 0xE5>(); break; case 0xE6: execute<Isa, 0xE6>(); break; case 0xE7: execute<Isa, 0xE7>(); break;
+    case 0xE8: execute<Isa, 0xE8>(); break; case 0xE9: execute<Isa, 0xE9>(); break; case 0xEA: execute<Isa, 0xEA>(); break; case 0xEB: execute<Isa, 0xEB>(); break;
+    case 0xEC: execute<Isa, 0xEC>(); break; case 0xED: execute<Isa, 0xED>(); break; case 0xEE: execute<Isa, 0xEE>(); break; case 0xEF: execute<Isa, 0xEF>(); break;
+    case 0xF0: execute<Isa, 0xF0>(); break; case 0xF1: execute<Isa, 0xF1>(); break; case 0xF2: execute<Isa, 0xF2>(); break; case 0xF3: execute<Isa, 0xF3>(); break;
+    case 0xF4: execute<Isa, 0xF4>(); break; case 0xF5: execute<Isa, 0xF5>(); break; case 0xF6: execute<Isa, 0xF6>(); break; case 0xF7: execute<Isa, 0xF7>(); break;
+    case 0xF8: execute<Isa, 0xF8>(); break; case 0xF9: execute<Isa, 0xF9>(); break; case 0xFA: execute<Isa, 0xFA>(); break; case 0xFB: execute<Isa, 0xFB>(); break;
+    case 0xFC: execute<Isa, 0xFC>(); break; case 0xFD: execute<Isa, 0xFD>(); break; case 0xFE: execute<Isa, 0xFE>(); break; case 0xFF: execute<Isa, 0xFF>(); break;
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PREDECODING
+
+template<typename Isa, size_t... Opcodes>
+constexpr std::array<InstructionExecutor::predecodedHandler, sizeof...(Opcodes)> InstructionExecutor::predecodedHandlers(std::index_sequence<Opcodes...>)
+{
+    return {{ &InstructionExecutor::executePredecoded<Isa, Opcodes>... }};
+}
+
+// Only plain memory is decoded, where reading ahead of time has no side
+// effects and nothing changes the code behind the executor's back. Code in
+// the other pages is read through the delegate every time it runs.
+auto InstructionExecutor::predecodedAt(addressType address) -> const PredecodedInstruction *
+{
+    const uint8_t *page = _read_pages[address >> 8];
+
+    if (!page)
+        return nullptr;
+
+    if (!_predecoded)
+        _predecoded.reset(new PredecodedInstruction[0x10000]);
+
+    PredecodedInstruction &instruction = _predecoded[address];
+
+    if (!instruction.handler)
+    {
+        const uint8_t        opcode = page[address & 0xFF];
+        const AddressingMode mode   = this->instruction(opcode).addrmode;
+        const uint8_t        length = instructionLength(opcode);
+        uint16_t             operand = 0;
+
+        for (uint8_t offset = 1; offset < length; ++offset)
+        {
+            const addressType operand_address = static_cast<addressType>(address + offset);
+            const uint8_t    *operand_page    = _read_pages[operand_address >> 8];
+
+            if (!operand_page)
+                return nullptr;
+            operand |= operand_page[operand_address & 0xFF] << (8 * (offset - 1));
+        }
+        if ((mode == AddressingMode::REL) && (operand & 0x80))
+            operand |= 0xFF00;
+
+        instruction.opcode  = opcode;
+        instruction.length  = length;
+        instruction.operand = operand;
+        markCode(address, instruction.length);
+        instruction.handler = predecodedHandlerFor(instruction.opcode);
+        fuse(address, instruction);
+    }
+    return &instruction;
+}
+
+void InstructionExecutor::fuse(addressType address, PredecodedInstruction &instruction)
+{
+    instruction.fused        = nullptr;
+    instruction.fused_length = 0;
+
+    // The next instruction is only looked at in plain memory, where reading
+    // it ahead of time has no side effects.
+    const addressType next = static_cast<addressType>(address + instruction.length);
+    auto              peek = [this](addressType address) -> int
+                             {
+                                 const uint8_t *page = _read_pages[address >> 8];
+
+                                 return page ? page[address & 0xFF] : -1;
+                             };
+
+    const int second = peek(next);
+
+    if (second < 0)
+        return;
+
+    const fusedHandler handler = _dispatch->fused_handler_for(instruction.opcode, static_cast<uint8_t>(second));
+
+    if (!handler)
+        return;
+
+    const uint8_t length  = instructionLength(static_cast<uint8_t>(second));
+    uint16_t      operand = 0;
+
+    for (uint8_t offset = 1; offset < length; ++offset)
+    {
+        const int byte = peek(static_cast<addressType>(next + offset));
+
+        if (byte < 0)
+            return;
+        operand |= byte << (8 * (offset - 1));
+    }
+    if ((this->instruction(static_cast<uint8_t>(second)).addrmode == AddressingMode::REL) && (operand & 0x80))
+        operand |= 0xFF00;
+
+    markCode(next, length);
+    instruction.fused        = handler;
+    instruction.next_operand = operand;
+    instruction.fused_length = static_cast<uint8_t>(instruction.length + length);
+}
+
+void InstructionExecutor::markCode(addressType address, uint8_t length)
+{
+    if (!_code_bytes)
+        _code_bytes.reset(new std::bitset<0x10000>);
+
+    for (uint8_t offset = 0; offset < length; ++offset)
+        _code_bytes->set(static_cast<addressType>(address + offset));
+}
+
+// The pairs are the same on every instruction set, but each has its own handlers for them.
+template<typename Isa>
+auto InstructionExecutor::fusedHandlerFor(uint8_t first, uint8_t second) -> fusedHandler
+{
+    struct Pair
+    {
+        uint8_t      first;
+        uint8_t      second;
+        fusedHandler handler;
+    };
+
+    static const Pair pairs[] =
+    {
+        // DEX, DEY, INX, INY or INC zero page, then BNE
+        { 0xCA, 0xD0, &executeFused<Isa, 0xCA, 0xD0> }, { 0x88, 0xD0, &executeFused<Isa, 0x88, 0xD0> }, { 0xE8, 0xD0, &executeFused<Isa, 0xE8, 0xD0> },
+        { 0xC8, 0xD0, &executeFused<Isa, 0xC8, 0xD0> }, { 0xE6, 0xD0, &executeFused<Isa, 0xE6, 0xD0> },
+        // CMP, CPX or CPY, then BEQ or BNE
+        { 0xC9, 0xF0, &executeFused<Isa, 0xC9, 0xF0> }, { 0xC9, 0xD0, &executeFused<Isa, 0xC9, 0xD0> }, { 0xC5, 0xF0, &executeFused<Isa, 0xC5, 0xF0> },
+        { 0xC5, 0xD0, &executeFused<Isa, 0xC5, 0xD0> }, { 0xCD, 0xF0, &executeFused<Isa, 0xCD, 0xF0> }, { 0xCD, 0xD0, &executeFused<Isa, 0xCD, 0xD0> },
+        { 0xDD, 0xF0, &executeFused<Isa, 0xDD, 0xF0> }, { 0xDD, 0xD0, &executeFused<Isa, 0xDD, 0xD0> }, { 0xD9, 0xF0, &executeFused<Isa, 0xD9, 0xF0> },
+        { 0xD9, 0xD0, &executeFused<Isa, 0xD9, 0xD0> }, { 0xE0, 0xF0, &executeFused<Isa, 0xE0, 0xF0> }, { 0xE0, 0xD0, &executeFused<Isa, 0xE0, 0xD0> },
+        { 0xE4, 0xF0, &executeFused<Isa, 0xE4, 0xF0> }, { 0xE4, 0xD0, &executeFused<Isa, 0xE4, 0xD0> }, { 0xEC, 0xF0, &executeFused<Isa, 0xEC, 0xF0> },
+        { 0xEC, 0xD0, &executeFused<Isa, 0xEC, 0xD0> }, { 0xC0, 0xF0, &executeFused<Isa, 0xC0, 0xF0> }, { 0xC0, 0xD0, &executeFused<Isa, 0xC0, 0xD0> },
+        { 0xC4, 0xF0, &executeFused<Isa, 0xC4, 0xF0> }, { 0xC4, 0xD0, &executeFused<Isa, 0xC4, 0xD0> }, { 0xCC, 0xF0, &executeFused<Isa, 0xCC, 0xF0> },
+        { 0xCC, 0xD0, &executeFused<Isa, 0xCC, 0xD0> },
+        // LDA, then STA
+        { 0xA9, 0x85, &executeFused<Isa, 0xA9, 0x85> }, { 0xA9, 0x8D, &executeFused<Isa, 0xA9, 0x8D> }, { 0xA9, 0x9D, &executeFused<Isa, 0xA9, 0x9D> },
+        { 0xA9, 0x99, &executeFused<Isa, 0xA9, 0x99> }, { 0xA9, 0x91, &executeFused<Isa, 0xA9, 0x91> }, { 0xA5, 0x85, &executeFused<Isa, 0xA5, 0x85> },
+        { 0xA5, 0x8D, &executeFused<Isa, 0xA5, 0x8D> }, { 0xA5, 0x9D, &executeFused<Isa, 0xA5, 0x9D> }, { 0xA5, 0x99, &executeFused<Isa, 0xA5, 0x99> },
+        { 0xA5, 0x91, &executeFused<Isa, 0xA5, 0x91> }, { 0xAD, 0x85, &executeFused<Isa, 0xAD, 0x85> }, { 0xAD, 0x8D, &executeFused<Isa, 0xAD, 0x8D> },
+        { 0xAD, 0x9D, &executeFused<Isa, 0xAD, 0x9D> }, { 0xAD, 0x99, &executeFused<Isa, 0xAD, 0x99> }, { 0xAD, 0x91, &executeFused<Isa, 0xAD, 0x91> },
+        { 0xBD, 0x85, &executeFused<Isa, 0xBD, 0x85> }, { 0xBD, 0x8D, &executeFused<Isa, 0xBD, 0x8D> }, { 0xBD, 0x9D, &executeFused<Isa, 0xBD, 0x9D> },
+        { 0xBD, 0x99, &executeFused<Isa, 0xBD, 0x99> }, { 0xBD, 0x91, &executeFused<Isa, 0xBD, 0x91> }, { 0xB9, 0x85, &executeFused<Isa, 0xB9, 0x85> },
+        { 0xB9, 0x8D, &executeFused<Isa, 0xB9, 0x8D> }, { 0xB9, 0x9D, &executeFused<Isa, 0xB9, 0x9D> }, { 0xB9, 0x99, &executeFused<Isa, 0xB9, 0x99> },
+        { 0xB9, 0x91, &executeFused<Isa, 0xB9, 0x91> }, { 0xB1, 0x85, &executeFused<Isa, 0xB1, 0x85> }, { 0xB1, 0x8D, &executeFused<Isa, 0xB1, 0x8D> },
+        { 0xB1, 0x9D, &executeFused<Isa, 0xB1, 0x9D> }, { 0xB1, 0x99, &executeFused<Isa, 0xB1, 0x99> }, { 0xB1, 0x91, &executeFused<Isa, 0xB1, 0x91> },
+        // CLC then ADC, or SEC then SBC
+        { 0x18, 0x69, &executeFused<Isa, 0x18, 0x69> }, { 0x18, 0x65, &executeFused<Isa, 0x18, 0x65> }, { 0x18, 0x6D, &executeFused<Isa, 0x18, 0x6D> },
+        { 0x18, 0x7D, &executeFused<Isa, 0x18, 0x7D> }, { 0x18, 0x79, &executeFused<Isa, 0x18, 0x79> }, { 0x38, 0xE9, &executeFused<Isa, 0x38, 0xE9> },
+        { 0x38, 0xE5, &executeFused<Isa, 0x38, 0xE5> }, { 0x38, 0xED, &executeFused<Isa, 0x38, 0xED> }, { 0x38, 0xFD, &executeFused<Isa, 0x38, 0xFD> },
+        { 0x38, 0xF9, &executeFused<Isa, 0x38, 0xF9> },
+    };
+
+    for (const Pair &pair : pairs)
+    {
+        if ((pair.first == first) && (pair.second == second))
+            return pair.handler;
+    }
+    return nullptr;
+}
+
+void InstructionExecutor::invalidatePredecoded(addressType address)
+{
+    if (!_code_bytes)
+        return;
+
+    if (_predecoded)
+    {
+        // Instructions are at most 3 bytes long, so only the ones starting at
+        // the address or the two before it can cover it, and a fused pair of
+        // them the five before it. A pair is decoded again from scratch.
+        for (uint8_t back = 0; back < 6; ++back)
+        {
+            PredecodedInstruction &instruction = _predecoded[static_cast<addressType>(address - back)];
+
+            if (instruction.handler && ((instruction.length > back) || (instruction.fused_length > back)))
+            {
+                instruction.handler = nullptr;
+                instruction.fused   = nullptr;
+            }
+        }
+    }
+    if (_recompiler)
+        _recompiler->invalidate(address);
+    _code_bytes->reset(address);
+}
+
+void InstructionExecutor::invalidatePredecoded()
+{
+    _predecoded.reset();
+    if (_recompiler)
+        _recompiler->invalidate();
+    _code_bytes.reset();
+}
+
+void InstructionExecutor::setRecompile(bool enabled)
+{
+    if (enabled && !_recompiler && BlockRecompiler::available())
+        _recompiler.reset(new BlockRecompiler(*this));
+    else if (!enabled)
+        _recompiler.reset();
+}
+
+// The same as each addressing mode function, except that the operand has
+// already been read from the instruction, and the program counter already
+// moved past it. Indirect addresses are still read, since what they point
+// at may have changed.
+template<typename Isa>
+uint8_t InstructionExecutor::resolveOperand(AddressingMode mode, uint16_t operand)
+{
+    switch (mode)
+    {
+    case AddressingMode::IMP:
+        _fetched = registers().a;
+        return 0;
+    case AddressingMode::IMM:
+        // The value is at hand, so fetch() must not read it again. No
+        // instruction with an immediate operand targets the accumulator.
+        _fetched = static_cast<uint8_t>(operand);
+        _implied = true;
+        return 0;
+    case AddressingMode::ZP0:
+        _addr_abs = operand & 0x00FF;
+        return 0;
+    case AddressingMode::ZPX:
+        _addr_abs = (operand + registers().x) & 0x00FF;
+        return 0;
+    case AddressingMode::ZPY:
+        _addr_abs = (operand + registers().y) & 0x00FF;
+        return 0;
+    case AddressingMode::REL:
+        _addr_rel = operand;
+        return 0;
+    case AddressingMode::ABS:
+        _addr_abs = operand;
+        return 0;
+    case AddressingMode::ABX:
+        _addr_abs = operand + registers().x;
+        return ((_addr_abs & 0xFF00) != (operand & 0xFF00)) ? 1 : 0;
+    case AddressingMode::ABY:
+        _addr_abs = operand + registers().y;
+        return ((_addr_abs & 0xFF00) != (operand & 0xFF00)) ? 1 : 0;
+    case AddressingMode::IND:
+        if (Isa::indirect_jump_bug && ((operand & 0x00FF) == 0x00FF)) // Simulate page boundary hardware bug
+            _addr_abs = (read(operand & 0xFF00) << 8) | read(operand);
+        else
+            _addr_abs = (read(operand + 1) << 8) | read(operand);
+        return 0;
+    case AddressingMode::IZX:
+    {
+        uint16_t lo = read((operand + registers().x) & 0x00FF);
+        uint16_t hi = read((operand + registers().x + 1) & 0x00FF);
+
+        _addr_abs = (hi << 8) | lo;
+        return 0;
+    }
+    case AddressingMode::IZY:
+    {
+        uint16_t lo = read(operand & 0x00FF);
+        uint16_t hi = read((operand + 1) & 0x00FF);
+
+        _addr_abs = ((hi << 8) | lo) + registers().y;
+        return ((_addr_abs & 0xFF00) != (hi << 8)) ? 1 : 0;
+    }
+    case AddressingMode::ZPI:
+    {
+        uint16_t lo = read(operand & 0x00FF);
+        uint16_t hi = read((operand + 1) & 0x00FF);
+
+        _addr_abs = (hi << 8) | lo;
+        return 0;
+    }
+    case AddressingMode::IAX:
+    {
+        uint16_t ptr = operand + registers().x;
+
+        _addr_abs = (read(ptr + 1) << 8) | read(ptr);
+        return 0;
+    }
+    case AddressingMode::ZPR:
+        // The zero page address is the low byte and the branch offset the high one
+        _addr_abs = operand & 0x00FF;
+        _addr_rel = static_cast<uint16_t>(static_cast<int8_t>(operand >> 8));
+        return 0;
+    }
+    return 0;
+}
+
+// executeInstruction() for an instruction taken from the cache.
+template<typename Isa, uint8_t Opcode>
+void InstructionExecutor::executePredecoded(InstructionExecutor &executor, uint16_t operand)
+{
+    constexpr INSTRUCTION instruction = Isa::lookup[Opcode];
+
+    executor._opcode = Opcode;
+    executor.SetFlag(U, true);
+    executor.registers().program_counter += 1 + operand_lengths[static_cast<size_t>(instruction.addrmode)];
+
+    executor._cycles = instruction.cycles;
+    executor._implied = (instruction.addrmode == AddressingMode::IMP);
+
+    uint8_t additional_cycle1 = executor.resolveOperand<Isa>(instruction.addrmode, operand);
+    uint8_t additional_cycle2 = (executor.*operationOf<Isa>(instruction))();
+
+    executor._cycles += (additional_cycle1 & additional_cycle2);
+    executor.SetFlag(U, true);
+}
+
+// Both instructions of a pair, with the cycles of both left in _cycles.
+template<typename Isa, uint8_t First, uint8_t Second>
+uint8_t InstructionExecutor::executeFused(InstructionExecutor &executor, const PredecodedInstruction &instruction)
+{
+    executePredecoded<Isa, First>(executor, instruction.operand);
+
+    const uint8_t first_cycles = executor._cycles;
+
+    // A device may have raised an interrupt, or scheduled an event, which
+    // has to be seen to before the second.
+    if (executor._nmi_pending || (executor._irq_sources && !executor.GetFlag(I)) ||
+        (executor.cyclesUntilNextEvent() <= first_cycles))
+        return 1;
+
+    // If the first wrote over the second, the pair is no longer decoded, and
+    // the second has to be read again.
+    if (instruction.fused)
+        executePredecoded<Isa, Second>(executor, instruction.next_operand);
+    else
+        executor.executeInstruction(executor.read(executor.registers().program_counter));
+    executor._cycles += first_cycles;
+    return 2;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+// INSTRUCTION SETS
+
+// Everything an instruction set needs, put together the first time an
+// executor asks for it.
+template<typename Isa>
+auto InstructionExecutor::dispatchFor() -> const Dispatch &
+{
+    static constexpr auto handlers = predecodedHandlers<Isa>(std::make_index_sequence<256>());
+    static const Dispatch dispatch
+    {
+        Isa::set, Isa::lookup, Isa::names, &InstructionExecutor::interpret<Isa>,
+        handlers.data(), &fusedHandlerFor<Isa>, Isa::interrupts_clear_decimal
+    };
+
+    return dispatch;
+}
+
+auto InstructionExecutor::dispatchFor(InstructionSet set) -> const Dispatch &
+{
+    switch (set)
+    {
+    case InstructionSet::Cmos65C02: return dispatchFor<Cmos65C02>();
+    case InstructionSet::Ricoh2A03: return dispatchFor<Ricoh2A03>();
+    case InstructionSet::Nmos6502:  break;
+    }
+    return dispatchFor<Nmos6502>();
+}
@@ -0,0 +1,715 @@
+#ifndef INSTRUCTIONEXECUTOR_HPP
+#define INSTRUCTIONEXECUTOR_HPP
+
+#include <array>
+#include <cassert>
+#include <bitset>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include "registers.hpp"
+
+class BlockRecompiler;
+class EventScheduler;
+struct DecimalResult;
+
+
+class InstructionExecutor
+{
+    friend class BlockRecompiler;
+public:
+    using addressType = uint16_t;
+    using registerType = uint8_t;
+    using readDelegate  = std::function<uint8_t (addressType, bool)>;
+    using writeDelegate = std::function<void (addressType, uint8_t)>;
+    using registersChangedDelegate = std::function<void (const Registers &, uint8_t changed)>;
+    using disassemblyType = std::map<addressType, std::string>;
+
+    /** The CPUs an executor can be.
+     *
+     *  Each has its own translation table, and its own copy of every handler
+     *  with what sets it apart compiled in, so none of them pays for the
+     *  others at run time.
+     */
+    enum class InstructionSet : uint8_t
+    {
+        Nmos6502,  ///< The original NMOS 6502, without its unofficial opcodes
+        Cmos65C02, ///< The WDC 65C02: the extra instructions, JMP ($xxFF) fixed, and WAI and STP
+        Ricoh2A03  ///< The NES's 6502, which has no decimal mode
+    };
+
+    // The addressing modes and operations an opcode can be made of. These are
+    // indices into tables of the member functions implementing them, so they
+    // fit in a byte instead of a 16 byte pointer to member function.
+    enum class AddressingMode : uint8_t
+    {
+        IMP, IMM, ZP0, ZPX, ZPY, REL, ABS, ABX, ABY, IND, IZX, IZY,
+        ZPI, IAX, ZPR // Only on the 65C02
+    };
+
+    enum class Operation : uint8_t
+    {
+        ADC, AND, ASL, BCC, BCS, BEQ, BIT, BMI, BNE, BPL, BRK, BVC, BVS, CLC,
+        CLD, CLI, CLV, CMP, CPX, CPY, DEC, DEX, DEY, EOR, INC, INX, INY, JMP,
+        JSR, LDA, LDX, LDY, LSR, NOP, ORA, PHA, PHP, PLA, PLP, ROL, ROR, RTI,
+        RTS, SBC, SEC, SED, SEI, STA, STX, STY, TAX, TAY, TSX, TXA, TXS, TYA,
+        BBR, BBS, BRA, PHX, PHY, PLX, PLY, RMB, SMB, STP, STZ, TRB, TSB, WAI, // Only on the 65C02
+        XXX
+    };
+
+    // This structure is used to store the opcode translation table. The 6502
+    // can effectively have 256 different instructions. Each of these are
+    // stored in a table in numerical order so they can be looked up easily,
+    // with no decoding required. There is one table for each instruction set,
+    // a compile time constant shared by every InstructionExecutor. Each table
+    // entry holds:
+
+    //	Opcode Function: Which operation implements the opcode
+    //	Opcode Address Mode : Which addressing mechanism is used by the instruction
+    //	Cycle Count : An integer that represents the base number of clock cycles the
+    //				  CPU requires to perform the instruction
+    //
+    // The pneumonics, a textual representation of each instruction, are only
+    // needed for disassembly, so they are kept in a separate table (see nameOf).
+    struct INSTRUCTION
+    {
+        Operation      operate;
+        AddressingMode addrmode;
+        uint8_t        cycles;
+    };
+
+    /** Looks up an opcode in the translation table.
+     *
+     *  @param opcode The opcode to look up
+     *  @param set    The instruction set whose table to look in
+     *
+     *  @return The table entry describing @p opcode
+     */
+    static const INSTRUCTION &instructionFor(uint8_t opcode, InstructionSet set = InstructionSet::Nmos6502);
+
+    /** Looks up the pneumonic of an opcode.
+     *
+     *  @param opcode The opcode to look up
+     *  @param set    The instruction set whose table to look in
+     *
+     *  @return The pneumonic, or "???" for unofficial opcodes
+     */
+    static const char *nameOf(uint8_t opcode, InstructionSet set = InstructionSet::Nmos6502);
+
+    /** Looks up how many bytes an instruction takes up.
+     *
+     *  @param opcode The opcode to look up
+     *  @param set    The instruction set whose table to look in
+     *
+     *  @return The length of the instruction, including the opcode
+     */
+    static uint8_t lengthOf(uint8_t opcode, InstructionSet set = InstructionSet::Nmos6502);
+
+    /** Why a batch run returned to the caller.
+     *
+     *  For every reason except @c BudgetSpent, the program counter is left
+     *  pointing at the instruction which caused the stop, which has not
+     *  been executed yet.
+     */
+    enum class StopReason : uint8_t
+    {
+        BudgetSpent,   ///< The cycle or instruction budget has been used up
+        Breakpoint,    ///< The next instruction is at a breakpoint
+        Break,         ///< The next instruction is a BRK
+        IllegalOpcode, ///< The next instruction is not a legal opcode
+        Condition      ///< The predicate passed to runUntil() was satisfied
+    };
+
+    /** The outcome of a batch run.
+     *
+     */
+    struct RunResult
+    {
+        uint64_t   cycles       = 0; ///< Clock cycles actually consumed
+        uint64_t   instructions = 0; ///< Instructions started
+        StopReason reason       = StopReason::BudgetSpent;
+        bool       idle         = false; ///< Ended up in an idle loop, which only an event or interrupt can break
+    };
+
+    using runPredicate = std::function<bool (const Registers &)>;
+
+    InstructionExecutor() = delete;
+    InstructionExecutor(Registers    &registers,
+                        readDelegate  read_signal,
+                        writeDelegate write_signal,
+                        registersChangedDelegate registers_changed_signal = nullptr);
+    InstructionExecutor(const InstructionExecutor &) = delete;
+    InstructionExecutor(InstructionExecutor &&) = delete;
+    ~InstructionExecutor();
+
+    // Addressing Modes =============================================
+    // The 6502 has a variety of addressing modes to access data in
+    // memory, some of which are direct and some are indirect (like
+    // pointers in C++). Each opcode contains information about which
+    // addressing mode should be employed to facilitate the
+    // instruction, in regards to where it reads/writes the data it
+    // uses. The address mode changes the number of bytes that
+    // makes up the full instruction, so we implement addressing
+    // before executing the instruction, to make sure the program
+    // counter is at the correct location, the instruction is
+    // primed with the addresses it needs, and the number of clock
+    // cycles the instruction requires is calculated. These functions
+    // may adjust the number of cycles required depending upon where
+    // and how the memory is accessed, so they return the required
+    // adjustment.
+
+    uint8_t IMP(); uint8_t IMM();
+    uint8_t ZP0(); uint8_t ZPX();
+    uint8_t ZPY(); uint8_t REL();
+    uint8_t ABS(); uint8_t ABX();
+    uint8_t ABY(); uint8_t IZX();
+    uint8_t IZY();
+
+    // The 65C02's own: (zp), (abs,X) and zp followed by a relative branch
+    uint8_t ZPI(); uint8_t IAX();
+    uint8_t ZPR();
+
+    // Only the NMOS chips have the page wrapping bug
+    template<typename Isa> uint8_t IND();
+
+    // Opcodes ======================================================
+    // There are 56 "legitimate" opcodes provided by the 6502 CPU. I
+    // have not modelled "unofficial" opcodes. As each opcode is
+    // defined by 1 byte, there are potentially 256 possible codes.
+    // Codes are not used in a "switch case" style on a processor,
+    // instead they are repsonisble for switching individual parts of
+    // CPU circuits on and off. The opcodes listed here are official,
+    // meaning that the functionality of the chip when provided with
+    // these codes is as the developers intended it to be. Unofficial
+    // codes will of course also influence the CPU circuitry in
+    // interesting ways, and can be exploited to gain additional
+    // functionality!
+    //
+    // These functions return 0 normally, but some are capable of
+    // requiring more clock cycles when executed under certain
+    // conditions combined with certain addressing modes. If that is
+    // the case, they return 1.
+    //
+    // I have included detailed explanations of each function in
+    // the class implementation file. Note they are listed in
+    // alphabetical order here for ease of finding.
+
+    uint8_t AND();	uint8_t BCC();
+    uint8_t BCS();	uint8_t BEQ();	uint8_t BIT();	uint8_t BMI();
+    uint8_t BNE();	uint8_t BPL();	uint8_t BVC();
+    uint8_t BVS();	uint8_t CLC();	uint8_t CLD();	uint8_t CLI();
+    uint8_t CLV();	uint8_t CMP();	uint8_t CPX();	uint8_t CPY();
+    uint8_t DEC();	uint8_t DEX();	uint8_t DEY();	uint8_t EOR();
+    uint8_t INC();	uint8_t INX();	uint8_t INY();	uint8_t JMP();
+    uint8_t JSR();	uint8_t LDA();	uint8_t LDX();	uint8_t LDY();
+    uint8_t NOP();	uint8_t ORA();	uint8_t PHA();
+    uint8_t PHP();	uint8_t PLA();	uint8_t PLP();
+    uint8_t RTI();	uint8_t RTS();
+    uint8_t SEC();	uint8_t SED();	uint8_t SEI();	uint8_t STA();
+    uint8_t STX();	uint8_t STY();	uint8_t TAX();	uint8_t TAY();
+    uint8_t TSX();	uint8_t TXA();	uint8_t TXS();	uint8_t TYA();
+
+    // Decimal mode differs from one instruction set to the next, the
+    // 65C02 clears D on a BRK, and its shifts by absolute,X only take the
+    // extra cycle when they cross a page, so there's one of these for each
+    // of them.
+    template<typename Isa> uint8_t ADC();
+    template<typename Isa> uint8_t SBC();
+    template<typename Isa> uint8_t BRK();
+    template<typename Isa> uint8_t ASL();	template<typename Isa> uint8_t LSR();
+    template<typename Isa> uint8_t ROL();	template<typename Isa> uint8_t ROR();
+
+    // The instructions the 65C02 adds
+    uint8_t BBR();	uint8_t BBS();	uint8_t BRA();	uint8_t PHX();
+    uint8_t PHY();	uint8_t PLX();	uint8_t PLY();	uint8_t RMB();
+    uint8_t SMB();	uint8_t STP();	uint8_t STZ();	uint8_t TRB();
+    uint8_t TSB();	uint8_t WAI();
+
+    // I capture all "unofficial" opcodes with this function. It is
+    // functionally identical to a NOP
+    uint8_t XXX();
+
+    // Indicates the current instruction has completed by returning true. This is
+    // a utility function to enable "step-by-step" execution, without manually
+    // clocking every cycle
+    bool complete() const { return remainingCyclesForInstruction() == 0; }
+
+    uint8_t remainingCyclesForInstruction() const { return _cycles; }
+
+    void reset();
+    void irq();
+    void nmi();
+
+    void clock(); ///< Executes one clock tick
+    uint64_t clock_ticks = 0; // The master clock: every cycle run. At 64 bits it never wraps.
+
+    // Interrupt lines and events ===================================
+    // irq() and nmi() act immediately. Devices should use the lines
+    // instead, which are sampled at each instruction boundary, by clock()
+    // and by the batch runs alike. The IRQ line is level sensitive: any
+    // number of sources may hold it, and it keeps interrupting for as long
+    // as one of them does and interrupts are enabled. NMI is edge
+    // triggered, as on the real chip, so raising it is latched until it
+    // has been serviced.
+    //
+    // Events posted to the scheduler are run at the first instruction
+    // boundary at or after their cycle, before the lines are sampled, so
+    // an event may raise a line and have it seen straight away. Nothing
+    // else is polled between events.
+
+    /** How many sources may hold the IRQ line.
+     */
+    static constexpr uint8_t numberOfIrqSources() { return 32; }
+
+    /** Holds the IRQ line on behalf of @p source, which is a number from 0 to 31.
+     *
+     *  @return false if @p source is out of range, and nothing was done
+     */
+    bool raiseIrq(uint8_t source = 0)
+    {
+        assert(source < numberOfIrqSources());
+        if (source >= numberOfIrqSources())
+            return false;
+        _irq_sources |= (1U << source);
+        _block_exit = 1;
+        return true;
+    }
+
+    /** Lets go of the IRQ line on behalf of @p source.
+     *
+     *  @return false if @p source is out of range, and nothing was done
+     */
+    bool lowerIrq(uint8_t source = 0)
+    {
+        assert(source < numberOfIrqSources());
+        if (source >= numberOfIrqSources())
+            return false;
+        _irq_sources &= ~(1U << source);
+        return true;
+    }
+
+    /** Whether any source is holding the IRQ line.
+     */
+    bool irqLine() const { return _irq_sources != 0; }
+
+    /** Latches a non-maskable interrupt, to be serviced at the next instruction boundary.
+     */
+    void raiseNmi() { _nmi_pending = true; _block_exit = 1; }
+
+    /** Runs the events of @p scheduler against clock_ticks, or none if it is @c nullptr.
+     *
+     *  The scheduler is not owned.
+     */
+    void setScheduler(EventScheduler *scheduler) { _scheduler = scheduler; }
+    EventScheduler *scheduler() const { return _scheduler; }
+
+    // Instruction sets =============================================
+    // An executor is an NMOS 6502 unless told otherwise. The instruction
+    // set picks the translation table and the handlers built for it once,
+    // so executing an instruction never asks which CPU it is.
+    //
+    // On the 65C02, WAI executes over and over, like a branch to itself,
+    // until an interrupt comes along, which returns to the instruction
+    // after it, or an IRQ is raised while interrupts are disabled, which
+    // just carries on after it. STP does the same until reset(), and
+    // ignores interrupts altogether. The batch runs see either as an idle
+    // loop.
+
+    /** Makes the executor a different CPU, forgetting any decoded or compiled code.
+     */
+    void setInstructionSet(InstructionSet set);
+    InstructionSet instructionSet() const { return _dispatch->set; }
+
+    // Snapshots ====================================================
+    // Besides the registers, the executor keeps the instruction in
+    // progress, the clock, the lazy flags and the interrupt lines between
+    // calls. Putting them back puts the executor back exactly where it
+    // was, even part way through an instruction. How it is set up to run,
+    // and what it is attached to, are not part of it.
+
+    /** Everything the executor itself carries from one instruction to the next.
+     */
+    struct State
+    {
+        uint64_t clock_ticks   = 0;
+        uint16_t temp          = 0;
+        uint16_t addr_abs      = 0;
+        uint16_t addr_rel      = 0;
+        uint8_t  fetched       = 0;
+        uint8_t  opcode        = 0;
+        uint8_t  cycles        = 0;
+        bool     implied       = false;
+        uint8_t  pending_flags = 0;
+        uint8_t  nz_result     = 0;
+        uint8_t  v_operand1    = 0;
+        uint8_t  v_operand2    = 0;
+        uint8_t  v_result      = 0;
+        uint32_t irq_sources   = 0;
+        bool     nmi_pending   = false;
+        bool     waiting       = false;
+        bool     stopped       = false;
+    };
+
+    State state() const;
+    void  setState(const State &state);
+
+    /** Sets this executor up to run the way @p other does.
+     *
+     *  It takes the instruction set, breakpoints, and whether to predecode,
+     *  fuse, compile and skip idle loops, but not the scheduler or any code
+     *  already decoded or compiled.
+     */
+    void copySettings(const InstructionExecutor &other);
+
+    // Batch execution ==============================================
+    // These run many instructions in one call, which is far cheaper than
+    // calling clock() once per cycle. The result is the same as calling
+    // clock() the same number of times, except that register changes are
+    // only reported once, at the end of the run. A run always executes
+    // the instruction it starts on, so calling it again after a stop makes
+    // progress. An instruction left in progress by clock() is finished first.
+
+    /** Executes until @p cycle_budget clock cycles have been consumed.
+     *
+     *  The last instruction may be left in progress, exactly as if clock()
+     *  had been called @p cycle_budget times.
+     */
+    RunResult runCycles(uint64_t cycle_budget);
+
+    /** Executes @p instruction_budget whole instructions.
+     */
+    RunResult runInstructions(uint64_t instruction_budget);
+
+    /** Executes until @p predicate returns true at an instruction boundary.
+     *
+     *  @param predicate    Checked before each instruction is started
+     *  @param cycle_budget Gives up after this many clock cycles
+     */
+    RunResult runUntil(const runPredicate &predicate, uint64_t cycle_budget = UINT64_MAX);
+
+    // Idle loops ===================================================
+    // Firmware spends much of its time in loops waiting for something to
+    // change, such as JMP to itself, or LDA $2002 / BPL back to the LDA.
+    // Once such a loop has gone round twice with nothing changing, the
+    // batch runs know it can't get out until an event runs or an interrupt
+    // arrives, so they skip whole passes of it up to the next event or the
+    // end of the budget, counting their cycles and instructions exactly.
+    //
+    // A loop is recognised when it is a single JMP or branch to itself, or
+    // one of LDA, LDX, LDY, BIT, CMP, CPX, CPY, AND or ORA followed by a
+    // JMP or branch back to it. Its code and the memory it reads must be
+    // in pages mapped with mapPage(), since only plain memory is known to
+    // stay put. Compiled code runs its loops natively instead, and nothing
+    // is skipped while breakpoints are set or runUntil() is running.
+
+    /** Turns skipping idle loops on or off.  It is on by default.
+     */
+    void setSkipIdleLoops(bool enabled) { _skip_idle_loops = enabled; }
+    bool skipIdleLoops() const { return _skip_idle_loops; }
+
+    void setBreakpoint(addressType address)   { _breakpoints.insert(address); }
+    void clearBreakpoint(addressType address) { _breakpoints.erase(address); }
+    void clearBreakpoints()                   { _breakpoints.clear(); }
+    bool hasBreakpoint(addressType address) const { return _breakpoints.count(address) > 0; }
+
+    const Registers &registers() const { return _registers; }
+          Registers &registers()       { return _registers; }
+
+    // Register change notification =================================
+    // Changes are not tracked while instructions execute. Instead, the
+    // registers are compared against the values last published, and
+    // whatever differs is reported through a single delegate call with a
+    // mask of REGISTERS6502 bits. This happens when clock() starts a new
+    // instruction and at the end of each batch run, and is skipped entirely
+    // when there is no subscriber.
+
+    /** Subscribes to register changes.
+     *
+     *  Only changes made after subscribing are reported.
+     *
+     *  @param registers_changed Called with the registers and the mask of the ones that changed, or @c nullptr to unsubscribe
+     */
+    void setRegistersChangedDelegate(registersChangedDelegate registers_changed);
+
+    /** Reports any registers changed since the last time to the subscriber.
+     *
+     *  Useful for a caller that modifies the registers outside of clock() or
+     *  the batch runs, such as once per displayed frame.
+     */
+    void publishRegisterChanges();
+
+    /** Maps host memory directly onto a page of the address space.
+     *
+     *  Accesses to a mapped page are served from host memory without going
+     *  through the read or write delegate.  Only pages backed by plain memory
+     *  may be mapped.  Pages whose accesses have side effects must be left
+     *  unmapped so they keep going through the delegates.
+     *
+     *  @param page         The page number (the high byte of the address)
+     *  @param read_memory  The 256 bytes to read from, or @c nullptr to use the read delegate
+     *  @param write_memory The 256 bytes to write to, or @c nullptr to use the write delegate
+     */
+    void mapPage(uint8_t page, const uint8_t *read_memory, uint8_t *write_memory);
+
+    /** Sends all accesses of a page back through the delegates.
+     *
+     *  @param page The page number (the high byte of the address)
+     */
+    void unmapPage(uint8_t page) { mapPage(page, nullptr, nullptr); }
+
+    /** Whether writes to a page go straight to host memory rather than through the write delegate.
+     *
+     *  @param page The page number (the high byte of the address)
+     */
+    bool writesDirectly(uint8_t page) const { return _write_pages[page] != nullptr; }
+
+    // Predecoding ==================================================
+    // Instead of reading the opcode and its operand bytes every time an
+    // instruction executes, each instruction can be decoded once into a
+    // cache indexed by its address, holding a handler specialised for the
+    // opcode along with the operand already read. Tight loops then run
+    // without touching the instruction stream at all. Every write made by
+    // the executor is checked against a bitmap of the addresses covered by
+    // cached instructions, so self-modifying code is decoded again. Only
+    // code in pages mapped with mapPage() is decoded, since reading a device
+    // ahead of time could have side effects, and what it returns may change
+    // at any time. Code anywhere else is read through the read delegate
+    // every time it runs.
+
+    /** Turns predecoding on or off.
+     *
+     *  It is on by default when built with INSTRUCTIONEXECUTOR_PREDECODE.
+     */
+    void setPredecode(bool enabled) { _predecode = enabled; }
+    bool predecode() const { return _predecode; }
+
+    // A few pairs of instructions turn up together far more often than any
+    // others: DEX or DEY and BNE closing a loop, a compare and the branch on
+    // its result, LDA then STA, CLC then ADC, INC and BNE. When predecoding,
+    // such a pair in plain memory is also decoded as one superinstruction,
+    // run by a single handler which does both and adds up their cycles.
+    //
+    // runCycles() and runInstructions() only run a pair together where they
+    // could not have stopped, or taken an event or an interrupt, between
+    // them. Anywhere else, including clock() and runUntil(), the two still
+    // run one at a time.
+
+    /** Turns running fused pairs of instructions on or off.  It is on by default.
+     */
+    void setFuseInstructions(bool enabled) { _fuse = enabled; }
+    bool fuseInstructions() const { return _fuse; }
+
+    /** Turns compiling hot code into native code on or off.
+     *
+     *  Compiled code is used by runCycles() and runInstructions() while no
+     *  breakpoints are set, for code in pages mapped with mapPage().  It is
+     *  only available where BlockRecompiler::available() is true, and
+     *  asking for it elsewhere has no effect.
+     *
+     *  @see BlockRecompiler
+     */
+    void setRecompile(bool enabled);
+    bool recompile() const { return static_cast<bool>(_recompiler); }
+
+    /** Forgets any instruction decoded or compiled from @p address.
+     *
+     *  Memory changed by anything other than the executor, such as a device or
+     *  a debugger poking at it, must be invalidated explicitly.
+     */
+    void invalidatePredecoded(addressType address);
+
+    /** Forgets every decoded or compiled instruction.
+     */
+    void invalidatePredecoded();
+
+    auto disassemble(addressType start, addressType stop) -> disassemblyType;
+
+    InstructionExecutor &operator =(const InstructionExecutor &) = delete;
+    InstructionExecutor &operator =(InstructionExecutor &&) = delete;
+protected:
+    uint8_t  _fetched = 0x00; // Represents the working input value to the ALU
+    uint16_t _temp = 0x0000; // A convenience variable used everywhere
+    uint16_t _addr_abs = 0x0000; // All used memory addresses end up in here
+    uint16_t _addr_rel = 0x0000; // Represents absolute address following a branch
+    uint8_t  _opcode = 0x00; // Is the instruction byte
+    uint8_t  _cycles = 0; // Counts how many cycles the instruction has remaining
+    bool     _implied = false; // The instruction's addressing mode is IMP, so it operates on the accumulator
+    uint8_t  _pending_flags = 0; // The flags not yet worked out into the status register
+    uint8_t  _nz_result = 0; // N and Z are worked out from this
+    uint8_t  _v_operand1 = 0, _v_operand2 = 0, _v_result = 0; // V is worked out from these
+    Registers    &_registers;
+    readDelegate  _read_delegate;
+    writeDelegate _write_delegate;
+    registersChangedDelegate _registers_changed;
+    Registers     _published; // The registers as the subscriber last saw them
+    std::array<const uint8_t *, 256> _read_pages {};  // Host memory backing each page, if any
+    std::array<uint8_t *, 256>       _write_pages {};
+    std::set<addressType>            _breakpoints;
+
+    struct PredecodedInstruction;
+
+    using predecodedHandler = void (*)(InstructionExecutor &, uint16_t operand);
+    using fusedHandler      = uint8_t (*)(InstructionExecutor &, const PredecodedInstruction &instruction); // Returns how many it ran
+
+    // Everything specialised for an instruction set, picked once by
+    // setInstructionSet(). Isa is one of the policies in the implementation
+    // file, and each has one of these.
+    struct Dispatch
+    {
+        InstructionSet           set;
+        const INSTRUCTION       *lookup;     // The translation table
+        const char *const       *names;      // The pneumonics
+        void (InstructionExecutor::*interpret)(uint8_t opcode);
+        const predecodedHandler *predecoded; // One handler for each opcode
+        fusedHandler           (*fused_handler_for)(uint8_t first, uint8_t second);
+        bool                     interrupts_clear_decimal;
+    };
+
+    template<typename Isa>
+    static const Dispatch &dispatchFor();
+    static const Dispatch &dispatchFor(InstructionSet set);
+
+    const Dispatch *_dispatch;
+
+    // The table entry and length of an opcode in this executor's instruction set
+    const INSTRUCTION &instruction(uint8_t opcode) const { return _dispatch->lookup[opcode]; }
+    uint8_t instructionLength(uint8_t opcode) const;
+
+    bool _waiting = false; // WAI is waiting for an interrupt
+    bool _stopped = false; // STP has stopped the clock until reset()
+
+    struct PredecodedInstruction
+    {
+        predecodedHandler handler = nullptr; // nullptr until decoded
+        fusedHandler      fused   = nullptr; // Runs this and the next instruction, if they make a pair
+        uint16_t          operand = 0;       // The operand bytes, with a relative branch already sign extended
+        uint16_t          next_operand = 0;  // The same for the next instruction, if fused
+        uint8_t           opcode  = 0;
+        uint8_t           length  = 0;       // Including the opcode
+        uint8_t           fused_length = 0;  // Of both instructions, if fused
+    };
+
+    bool _predecode; // Execute from the cache of decoded instructions
+    bool _fuse = true; // Run fused pairs of decoded instructions
+    std::unique_ptr<PredecodedInstruction[]>  _predecoded; // One per address, allocated when first needed
+    std::unique_ptr<std::bitset<0x10000>>     _code_bytes; // The addresses covered by decoded instructions
+
+    std::unique_ptr<BlockRecompiler>          _recompiler;
+    uint8_t _block_exit = 0; // Set when the code of a running compiled block is written to, or an interrupt is raised
+
+    uint32_t        _irq_sources = 0;       // One bit for each source holding the IRQ line
+    bool            _nmi_pending = false;   // Latched by raiseNmi() until serviced
+    EventScheduler *_scheduler   = nullptr;
+
+    // Runs the events which are due, then starts servicing an interrupt if
+    // one is pending. Returns true if it did, in place of the next instruction.
+    bool atInstructionBoundary();
+
+    // How many cycles can be run before the next event is due
+    uint64_t cyclesUntilNextEvent() const;
+
+    bool _skip_idle_loops = true;
+
+    // The cycles of one pass of the loop from start to the jump back at end,
+    // if it is an idle loop, otherwise 0. Its length in instructions is
+    // left in instructions.
+    uint8_t idleLoopCycles(addressType start, addressType end, uint8_t &instructions) const;
+
+    // Decodes the instruction at address, if it isn't already, or returns
+    // nullptr if it isn't all in pages mapped with mapPage()
+    const PredecodedInstruction *predecodedAt(addressType address);
+
+    // Marks the addresses as holding decoded or compiled code
+    void markCode(addressType address, uint8_t length);
+
+    predecodedHandler predecodedHandlerFor(uint8_t opcode) const { return _dispatch->predecoded[opcode]; }
+
+    template<typename Isa, uint8_t Opcode>
+    static void executePredecoded(InstructionExecutor &executor, uint16_t operand);
+
+    template<typename Isa, size_t... Opcodes>
+    static constexpr std::array<predecodedHandler, sizeof...(Opcodes)> predecodedHandlers(std::index_sequence<Opcodes...>);
+
+    // The handler running first then second as one, or nullptr if they aren't a pair
+    template<typename Isa>
+    static fusedHandler fusedHandlerFor(uint8_t first, uint8_t second);
+
+    template<typename Isa, uint8_t First, uint8_t Second>
+    static uint8_t executeFused(InstructionExecutor &executor, const PredecodedInstruction &instruction);
+
+    // Decodes the instruction after the one at address along with it, if they make a pair
+    void fuse(addressType address, PredecodedInstruction &instruction);
+
+    // What the addressing mode does, less reading the operand
+    template<typename Isa>
+    uint8_t resolveOperand(AddressingMode mode, uint16_t operand);
+
+    // Executes a whole instruction whose opcode has already been read from
+    // the program counter, leaving its cycle count in _cycles
+    void executeInstruction(uint8_t opcode) { (this->*_dispatch->interpret)(opcode); }
+
+    template<typename Isa>
+    void interpret(uint8_t opcode);
+
+    // The alternative to going through the translation table, selected at
+    // build time with INSTRUCTIONEXECUTOR_SWITCH_DISPATCH. Each opcode is a
+    // case of one big switch, calling execute() specialised for that opcode,
+    // so the compiler can inline its addressing mode and operation into a
+    // single handler.
+    template<typename Isa>
+    void dispatch(uint8_t opcode);
+
+    template<typename Isa, uint8_t Opcode>
+    void execute();
+
+    RunResult run(uint64_t cycle_budget, uint64_t instruction_budget, const runPredicate *predicate);
+
+    // The read location of data can come from two sources, a memory address, or
+    // its immediately available as part of the instruction. This function decides
+    // depending on address mode of instruction byte
+    uint8_t fetch();
+
+    uint8_t read(addressType address, bool read_only = false);
+    void    write(addressType address, uint8_t data);
+
+    // Convenience functions to access status register
+    uint8_t GetFlag(FLAGS6502 f)
+    {
+        if (_pending_flags & f)
+            materializeFlags();
+        return _registers.GetFlag(f);
+    }
+    void    SetFlag(FLAGS6502 f, bool v)
+    {
+        _pending_flags &= ~f;
+        _registers.SetFlag(f, v);
+    }
+
+    // Lazy flags. Most instructions set N and Z from their result, and ADC
+    // and SBC set V from their operands, yet those flags are rarely looked
+    // at before the next instruction overwrites them. So the result and
+    // operands are only kept, and the flags are worked out into the status
+    // register when something reads it: a branch, a push of the status
+    // register, or the end of clock() and of a batch run.
+    void SetNZ(uint8_t result)
+    {
+        _nz_result = result;
+        _pending_flags |= (N | Z);
+    }
+    void SetV(uint8_t operand1, uint8_t operand2, uint8_t result)
+    {
+        _v_operand1 = operand1;
+        _v_operand2 = operand2;
+        _v_result = result;
+        _pending_flags |= V;
+    }
+    void materializeFlags();
+
+    // Sets the accumulator and the flags from a decimal mode ADC or SBC
+    void decimalResult(const DecimalResult &result);
+};
+
+#endif // INSTRUCTIONEXECUTOR_HPP
@@ -0,0 +1,156 @@
+#include "machine.hpp"
+#include <algorithm>
+
+
+Machine::Machine()
+    :
+    _executor(_registers,
+              [this](addressType address, bool) { return static_cast<const PagedMemory &>(_memory)[address]; },
+              [this](addressType address, uint8_t data) { write(address, data); })
+{
+    // Pages shared with a copy, such as a snapshot's, aren't mapped for
+    // writing, so the first write to one comes through _memory, which
+    // copies it and has it mapped again.  _memory tells of the pages a copy
+    // comes to share as well as of those it copies.
+    _memory.setPageChanged([this](uint8_t page) { mapPage(page); });
+    for (unsigned page = 0; page < 0x100; ++page)
+        mapPage(static_cast<uint8_t>(page));
+}
+
+Machine::~Machine()
+{
+}
+
+void Machine::load(addressType address, const std::vector<uint8_t> &bytes)
+{
+    for (size_t index = 0; index < bytes.size(); ++index)
+        _memory.write(static_cast<addressType>(address + index), bytes[index]);
+
+    // Nothing but the executor itself is watched for writes to code
+    _executor.invalidatePredecoded();
+}
+
+void Machine::poke(addressType address, uint8_t value)
+{
+    _memory.write(address, value);
+    _executor.invalidatePredecoded(address);
+}
+
+void Machine::clear()
+{
+    _memory.fill(0x00);
+    _registers = Registers();
+    _executor.setState(InstructionExecutor::State());
+    _executor.invalidatePredecoded();
+}
+
+void Machine::start(addressType address)
+{
+    _registers.a = 0;
+    _registers.x = 0;
+    _registers.y = 0;
+    _registers.stack_pointer = 0xFD;
+    _registers.status = 0x00 | U;
+    _registers.program_counter = address;
+}
+
+auto Machine::run(uint64_t cycle_budget) -> RunResult
+{
+    RunResult result = _executor.runCycles(cycle_budget);
+
+    // Finish off the last instruction, so the next run starts afresh
+    if (!_executor.complete())
+        result.cycles += _executor.runCycles(_executor.remainingCyclesForInstruction()).cycles;
+    return result;
+}
+
+uint64_t Machine::memoryDigest() const
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (size_t page = 0; page < PagedMemory::numberOfPages(); ++page)
+    {
+        const uint8_t *bytes = _memory.readPage(static_cast<uint8_t>(page));
+
+        for (size_t offset = 0; offset < PagedMemory::pageSize(); ++offset)
+        {
+            hash ^= bytes[offset];
+            hash *= 0x100000001B3ULL;
+        }
+    }
+    return hash;
+}
+
+uint64_t Machine::stateHash()
+{
+    if (!_hash_writes)
+        setHashWrites(true);
+
+    const uint64_t registers = (static_cast<uint64_t>(_registers.a)               << 0)  |
+                               (static_cast<uint64_t>(_registers.x)               << 8)  |
+                               (static_cast<uint64_t>(_registers.y)               << 16) |
+                               (static_cast<uint64_t>(_registers.stack_pointer)   << 24) |
+                               (static_cast<uint64_t>(_registers.status)          << 32) |
+                               (static_cast<uint64_t>(_registers.program_counter) << 40);
+
+    // Mixed the same way as memory's keys, but with a bit none of them have
+    return _memory.hash() ^ PagedMemory::mix(registers | (1ULL << 63));
+}
+
+void Machine::setHashWrites(bool enabled)
+{
+    _hash_writes = enabled;
+    for (unsigned page = 0; page < 0x100; ++page)
+        mapPage(static_cast<uint8_t>(page));
+    if (enabled)
+        _memory.hashPages();
+}
+
+auto Machine::snapshot() -> Snapshot
+{
+    // Copying memory has every page mapped again, so writes go through
+    // _memory to copy them first.
+    return Snapshot { _registers, _executor.state(), _memory };
+}
+
+// Pages which are the same memory as the snapshot's can't have been written
+// since, so only the others are mapped again, which forgets the code decoded
+// from them.  The snapshot's pages may not have been hashed when it was
+// taken, so they are hashed now if writes are.
+void Machine::restore(const Snapshot &snapshot)
+{
+    _registers = snapshot.registers;
+    _executor.setState(snapshot.executor);
+    _memory = snapshot.memory;
+    if (_hash_writes)
+        _memory.hashPages();
+}
+
+std::unique_ptr<Machine> Machine::fork()
+{
+    std::unique_ptr<Machine> child(new Machine);
+
+    child->_executor.copySettings(_executor);
+    child->setHashWrites(_hash_writes);
+    child->restore(snapshot());
+    return child;
+}
+
+// A page only comes here while it isn't mapped for writing.  Once whatever
+// shared it has let go of it, nothing copies it any more, so it is mapped
+// for writing again here.
+void Machine::write(addressType address, uint8_t data)
+{
+    const uint8_t page = static_cast<uint8_t>(address >> 8);
+
+    _memory.write(address, data);
+    if (!_hash_writes && !_memory.shared(page))
+        mapPage(page);
+}
+
+void Machine::mapPage(uint8_t page)
+{
+    const bool writable = !_memory.shared(page) && !_hash_writes;
+
+    _executor.mapPage(page, _memory.readPage(page), writable ? _memory.writablePage(page) : nullptr);
+}
@@ -0,0 +1,145 @@
+#ifndef MACHINE_HPP
+#define MACHINE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "instructionexecutor.hpp"
+#include "pagedmemory.hpp"
+
+
+/** A 6502 with 64K of plain memory, and nothing to do with Qt.
+ *
+ *  Unlike an EmulationThread, which paces its CPU and takes commands, a Machine
+ *  is run explicitly and owns all of its state, so any number of them can
+ *  be run at once on different threads.  The memory is mapped straight into
+ *  the executor, so no bus is involved.
+ *
+ *  Its memory is a PagedMemory, so a snapshot shares every page with the
+ *  machine, and only the pages written to after it are ever copied.
+ *  Taking one every frame, or going back to one over and over, is cheap.
+ */
+class Machine
+{
+public:
+    using addressType = uint16_t;
+    using memoryType  = PagedMemory;
+    using RunResult   = InstructionExecutor::RunResult;
+
+    /** The whole state of a machine at one moment.
+     */
+    struct Snapshot
+    {
+        Registers                  registers;
+        InstructionExecutor::State executor;
+        PagedMemory                memory;
+    };
+
+    Machine();
+    Machine(const Machine &) = delete;
+    ~Machine();
+
+    Registers         &registers() { return _registers; }
+    const Registers   &registers() const { return _registers; }
+    InstructionExecutor &executor() { return _executor; }
+
+    /** Memory, which is only written through load(), poke() and the executor.
+     *
+     *  A copy of it shares every page with the machine, which goes on to
+     *  copy each page it writes to, just as it does after a snapshot.
+     */
+    const memoryType  &memory() const { return _memory; }
+
+    /** Copies @p bytes into memory, starting at @p address.
+     */
+    void load(addressType address, const std::vector<uint8_t> &bytes);
+
+    /** Writes @p value to @p address, as a device or a debugger would.
+     *
+     *  Anything decoded from the address is forgotten.
+     */
+    void poke(addressType address, uint8_t value);
+
+    /** Clears memory and the registers, ready for another program.
+     *
+     *  The executor starts afresh too, from a clock of 0, with nothing
+     *  holding the IRQ line, no NMI pending and no WAI or STP in effect.
+     */
+    void clear();
+
+    /** Puts the registers in their state after a reset, but starting at @p address.
+     */
+    void start(addressType address);
+
+    /** Runs whole instructions until at least @p cycle_budget clock cycles have been consumed.
+     *
+     *  It stops early in front of a BRK or an illegal opcode, as
+     *  InstructionExecutor::runCycles() does.
+     */
+    RunResult run(uint64_t cycle_budget);
+
+    /** A 64 bit FNV-1a hash of the whole of memory.
+     */
+    uint64_t memoryDigest() const;
+
+    /** A 64 bit hash of the registers and memory, for telling states apart.
+     *
+     *  Memory's part is kept up to date as it is written (see PagedMemory),
+     *  so this only works out the registers' part, and takes no time at
+     *  all.  The first call turns on setHashWrites() for that, which hashes
+     *  memory once, and from then on every write goes through memory.
+     *  Unlike memoryDigest(), the same state always gets the same hash,
+     *  however it was reached.
+     */
+    uint64_t stateHash();
+
+    /** Has every write go through memory, so its hash is kept up to date.
+     *
+     *  Writes are slower, as they can't go straight to memory, so this is
+     *  off until stateHash() is first called.  Turning it off makes writes
+     *  fast again, until the next stateHash() turns it back on.
+     */
+    void setHashWrites(bool enabled);
+    bool hashWrites() const { return _hash_writes; }
+
+    /** Captures the registers, the executor's state and memory.
+     *
+     *  It can be taken part way through an instruction.  Breakpoints, the
+     *  instruction set and the other settings of the executor aren't part
+     *  of it.
+     */
+    Snapshot snapshot();
+
+    /** Puts the machine back the way it was when @p snapshot was taken.
+     *
+     *  Only the pages which differ from the snapshot's are changed, and
+     *  code decoded from the others is kept.
+     */
+    void restore(const Snapshot &snapshot);
+
+    /** A new machine in the same state as this one, to go its own way from here.
+     *
+     *  The two share every page of memory until one of them writes to it,
+     *  so a fork costs little more than a snapshot, and any number of them
+     *  can be run on different threads.  The child's executor is set up the
+     *  same way (see InstructionExecutor::copySettings), but has no scheduler
+     *  and decodes its code afresh.
+     */
+    std::unique_ptr<Machine> fork();
+
+    Machine &operator =(const Machine &) = delete;
+private:
+    Registers           _registers;
+    memoryType          _memory {};
+    InstructionExecutor _executor;
+    bool                _hash_writes = false;
+
+    // Writes a byte for the executor, to a page it can't write to directly
+    void write(addressType address, uint8_t data);
+
+    // Maps a page into the executor, writable only while nothing shares it
+    // and writes needn't be hashed
+    void mapPage(uint8_t page);
+};
+
+#endif // MACHINE_HPP
@@ -0,0 +1,119 @@
+#include "memorybus.hpp"
+#include "busdevice.hpp"
+#include <algorithm>
+
+
+MemoryBus::MemoryBus()
+{
+}
+
+MemoryBus::~MemoryBus()
+{
+    _page_map_changed = nullptr;
+    while (!_devices.empty())
+        detach(_devices.back());
+}
+
+void MemoryBus::attach(BusDevice *device)
+{
+    if (!device || (std::find(std::begin(_devices), std::end(_devices), device) != std::end(_devices)))
+        return;
+
+    _devices.push_back(device);
+    device->_buses.push_back(this);
+    rebuildPageMap();
+}
+
+void MemoryBus::detach(BusDevice *device)
+{
+    auto location = std::find(std::begin(_devices), std::end(_devices), device);
+
+    if (location != std::end(_devices))
+    {
+        _devices.erase(location);
+        device->_buses.erase(std::find(std::begin(device->_buses), std::end(device->_buses), this));
+        rebuildPageMap();
+    }
+}
+
+BusDevice *MemoryBus::deviceAt(addressType address) const
+{
+    const auto page = pageOf(address);
+
+    if (!_shared_pages.test(page))
+        return _page_map[page];
+
+    // The page is split between devices, so ask each of them.
+    for (auto device = _devices.rbegin(); device != _devices.rend(); ++device)
+    {
+        if ((*device)->handlesAddress(address))
+            return *device;
+    }
+    return nullptr;
+}
+
+const uint8_t *MemoryBus::directReadPage(uint8_t page) const
+{
+    const BusDevice *device = _page_map[page];
+
+    if (_shared_pages.test(page) || !device || !device->readable())
+        return nullptr;
+    return device->directReadPage(static_cast<addressType>(page * pageSize()));
+}
+
+uint8_t *MemoryBus::directWritePage(uint8_t page)
+{
+    BusDevice *device = _page_map[page];
+
+    if (_shared_pages.test(page) || !device || !device->writable())
+        return nullptr;
+    return device->directWritePage(static_cast<addressType>(page * pageSize()));
+}
+
+void MemoryBus::write(addressType address, uint8_t data)
+{
+    BusDevice *device = deviceAt(address);
+
+    if (device)
+        device->write(address, data);
+}
+
+uint8_t MemoryBus::read(addressType address, bool read_only)
+{
+    BusDevice *device = deviceAt(address);
+
+    return (device) ? device->read(address, read_only) : 0x00;
+}
+
+void MemoryBus::rebuildPageMap()
+{
+    _page_map.fill(nullptr);
+    _shared_pages.reset();
+
+    for (size_t page = 0; page < numberOfPages(); ++page)
+    {
+        const auto first = static_cast<addressType>(page * pageSize());
+        const auto last  = static_cast<addressType>(first + pageSize() - 1);
+
+        // Only the most recently attached device touching the page matters.  If it
+        // covers the whole page, everything underneath is shadowed by it.
+        for (auto device = _devices.rbegin(); device != _devices.rend(); ++device)
+        {
+            if (((*device)->upperAddress() < first) || ((*device)->lowerAddress() > last))
+                continue;
+
+            if (((*device)->lowerAddress() <= first) && ((*device)->upperAddress() >= last))
+                _page_map[page] = *device;
+            else
+                _shared_pages.set(page);
+            break;
+        }
+    }
+    directPagesChanged();
+}
+
+void MemoryBus::directPagesChanged()
+{
+    if (_page_map_changed)
+        _page_map_changed();
+}
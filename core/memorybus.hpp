@@ -0,0 +1,97 @@
+#ifndef MEMORYBUS_HPP
+#define MEMORYBUS_HPP
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class BusDevice;
+
+
+/** Decodes CPU accesses onto the attached bus devices, without Qt.
+ *
+ *  The address space is split into 256 pages of 256 bytes each.  When a
+ *  device is attached, the pages it covers are recorded in a page map, so
+ *  that resolving an access to a device is a single table lookup.
+ *
+ *  Pages that are only partially covered by a device are flagged as shared
+ *  and are resolved by asking each attached device whether it handles the
+ *  address.  When devices overlap, the most recently attached one wins.
+ */
+class MemoryBus
+{
+public:
+    using addressType = uint16_t;
+    using pageMapChangedDelegate = std::function<void ()>;
+
+    MemoryBus();
+    MemoryBus(const MemoryBus &) = delete;
+    ~MemoryBus();
+
+    static constexpr addressType pageSize()      { return 0x0100; }
+    static constexpr size_t      numberOfPages() { return page_count; }
+    static constexpr uint8_t     pageOf(addressType address) { return static_cast<uint8_t>(address >> 8); }
+
+    /** Attaches a device to the bus.
+     *
+     *  The device's address range is registered in the page map.  Attaching
+     *  the same device twice has no effect.
+     *
+     *  @param device The device to attach
+     */
+    void attach(BusDevice *device);
+
+    /** Detaches a device from the bus.
+     *
+     *  @param device The device to detach
+     */
+    void detach(BusDevice *device);
+
+    /** Resolves an address to the device which handles it.
+     *
+     *  @param address The address to resolve
+     *
+     *  @return The device handling @p address, or @c nullptr if nothing is mapped there
+     */
+    BusDevice *deviceAt(addressType address) const;
+
+    /** Retrieves the host memory backing a whole page, if there is any.
+     *
+     *  This is only available when a single device owns the entire page
+     *  and that device is plain memory (see @c BusDevice::directReadPage).
+     *
+     *  @param page The page number (the high byte of the address)
+     *
+     *  @return The 256 bytes backing the page, or @c nullptr if the page must go through the bus
+     */
+    ///@{
+    const uint8_t *directReadPage(uint8_t page) const;
+          uint8_t *directWritePage(uint8_t page);
+    ///@}
+
+    void    write(addressType address, uint8_t data);
+    uint8_t read(addressType address, bool read_only);
+
+    /** Sets what to call when devices are attached or detached, or when a
+     *  device changes which of its pages are directly accessible.
+     */
+    void setPageMapChanged(pageMapChangedDelegate page_map_changed) { _page_map_changed = page_map_changed; }
+
+    MemoryBus &operator =(const MemoryBus &) = delete;
+private:
+    friend class BusDevice;
+
+    static constexpr size_t page_count = 0x0100;
+
+    std::vector<BusDevice *>             _devices;
+    std::array<BusDevice *, page_count>  _page_map {};
+    std::bitset<page_count>              _shared_pages;
+    pageMapChangedDelegate               _page_map_changed;
+
+    void rebuildPageMap();
+    void directPagesChanged();
+};
+
+#endif // MEMORYBUS_HPP
@@ -0,0 +1,128 @@
+#include "pagedmemory.hpp"
+
+
+PagedMemory::PagedMemory()
+{
+    fill(0x00);
+}
+
+// The pages other held alone can't be written in place any more, so it is
+// told of them.
+PagedMemory::PagedMemory(const PagedMemory &other)
+    :
+    _page_hashes(other._page_hashes),
+    _unhashed(other._unhashed),
+    _hash(other._hash)
+{
+    for (size_t index = 0; index < numberOfPages(); ++index)
+    {
+        const uint8_t page       = static_cast<uint8_t>(index);
+        const bool    was_unique = other._pages[page].unique();
+
+        _pages[page] = other._pages[page];
+        if (was_unique && other._page_changed)
+            other._page_changed(page);
+    }
+}
+
+PagedMemory::~PagedMemory()
+{
+}
+
+// Only the pages which are different memory have changed, and only those
+// can have come to be shared with other.
+PagedMemory &PagedMemory::operator =(const PagedMemory &other)
+{
+    for (size_t index = 0; index < numberOfPages(); ++index)
+    {
+        const uint8_t page = static_cast<uint8_t>(index);
+
+        if (_pages[page] == other._pages[page])
+            continue;
+
+        const bool was_unique = other._pages[page].unique();
+
+        if (!_unhashed.test(page))
+            _hash ^= _page_hashes[page];
+        _pages[page]       = other._pages[page];
+        _page_hashes[page] = other._page_hashes[page];
+        _unhashed[page]    = other._unhashed[page];
+        if (!_unhashed.test(page))
+            _hash ^= _page_hashes[page];
+
+        if (_page_changed)
+            _page_changed(page);
+        if (was_unique && other._page_changed)
+            other._page_changed(page);
+    }
+    return *this;
+}
+
+void PagedMemory::fill(uint8_t value)
+{
+    pageType contents;
+
+    contents.fill(value);
+
+    const PageRef filled(new Page(contents));
+
+    _unhashed.reset();
+    _hash = 0;
+    for (size_t index = 0; index < numberOfPages(); ++index)
+    {
+        const uint8_t page = static_cast<uint8_t>(index);
+
+        _pages[page]       = filled;
+        _page_hashes[page] = (value == 0) ? 0 : hashOf(page);
+        _hash             ^= _page_hashes[page];
+        if (_page_changed)
+            _page_changed(page);
+    }
+}
+
+uint64_t PagedMemory::hash() const
+{
+    uint64_t hash = _hash;
+
+    if (_unhashed.any())
+    {
+        for (size_t page = 0; page < numberOfPages(); ++page)
+        {
+            if (_unhashed.test(page))
+                hash ^= hashOf(static_cast<uint8_t>(page));
+        }
+    }
+    return hash;
+}
+
+void PagedMemory::hashPages()
+{
+    for (size_t index = 0; _unhashed.any() && (index < numberOfPages()); ++index)
+    {
+        const uint8_t page = static_cast<uint8_t>(index);
+
+        if (!_unhashed.test(page))
+            continue;
+
+        _page_hashes[page] = hashOf(page);
+        _hash             ^= _page_hashes[page];
+        _unhashed.reset(page);
+    }
+}
+
+void PagedMemory::unshare(uint8_t page)
+{
+    _pages[page] = PageRef(new Page(_pages[page]->bytes));
+    if (_page_changed)
+        _page_changed(page);
+}
+
+uint64_t PagedMemory::hashOf(uint8_t page) const
+{
+    const uint8_t *bytes = readPage(page);
+    uint64_t       hash  = 0;
+
+    for (size_t offset = 0; offset < pageSize(); ++offset)
+        hash ^= keyOf(static_cast<addressType>((page << 8) | offset), bytes[offset]);
+    return hash;
+}
@@ -0,0 +1,219 @@
+#ifndef PAGEDMEMORY_HPP
+#define PAGEDMEMORY_HPP
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+
+
+/** 64K of memory held as 256 reference counted pages of 256 bytes.
+ *
+ *  Copying one only copies the references, so the copy shares every page
+ *  with the original.  A shared page is copied the first time either side
+ *  writes to it, so keeping a copy costs nothing more than the pages
+ *  written to after it was taken.  Pages are never changed while they are
+ *  shared, so the same page is the same contents, whoever holds it.
+ *  Copies can be used on different threads, since a page is only written
+ *  in place once whatever the others did with it has been seen to finish.
+ *
+ *  A copy doesn't take the original's page changed delegate with it, but
+ *  the original's delegate is told of each page the copy now shares, as
+ *  nothing may write to those in place any more.
+ *
+ *  It also keeps a 64 bit hash of its contents up to date.  Each byte has
+ *  a pseudo-random key for each value it can hold, and a page's hash is
+ *  the XOR of the keys of its bytes, so writing a byte only has to XOR out
+ *  the old key and XOR in the new one.  The hash of the whole is the XOR
+ *  of the pages' hashes.  Bytes written through write() update the hash as
+ *  they go, but nothing can see writes through the pointers handed out by
+ *  writablePage(), so those pages are hashed afresh by hash() until
+ *  hashPages() says nothing writes through them any more.
+ */
+class PagedMemory
+{
+public:
+    using addressType = uint16_t;
+    using pageType    = std::array<uint8_t, 0x100>;
+    using pageChangedDelegate = std::function<void (uint8_t page)>;
+
+    static constexpr size_t numberOfPages() { return 0x100; }
+    static constexpr size_t pageSize()      { return 0x100; }
+
+    /** All zeros, with every page sharing the same memory until written to.
+     */
+    PagedMemory();
+    PagedMemory(const PagedMemory &other);
+    ~PagedMemory();
+
+    PagedMemory &operator =(const PagedMemory &other);
+
+    uint8_t operator [](addressType address) const { return _pages[address >> 8]->bytes[address & 0xFF]; }
+
+    /** Gives write access to a byte, copying its page first if it is shared.
+     *
+     *  The page is hashed afresh from then on, as with writablePage().
+     */
+    uint8_t &operator [](addressType address) { return writablePage(static_cast<uint8_t>(address >> 8))[address & 0xFF]; }
+
+    /** Writes a byte, copying its page first if it is shared, and updates the hash.
+     */
+    void write(addressType address, uint8_t value)
+    {
+        const uint8_t page = static_cast<uint8_t>(address >> 8);
+
+        if (!_pages[page].unique())
+            unshare(page);
+
+        uint8_t &byte = _pages[page]->bytes[address & 0xFF];
+
+        if (!_unhashed.test(page))
+        {
+            const uint64_t change = keyOf(address, byte) ^ keyOf(address, value);
+
+            _page_hashes[page] ^= change;
+            _hash              ^= change;
+        }
+        byte = value;
+    }
+
+    /** The memory backing @p page.  It is only valid until the page is next copied.
+     */
+    const uint8_t *readPage(uint8_t page) const { return _pages[page]->bytes.data(); }
+
+    /** Copies @p page first if it is shared, so it can be written to.
+     *
+     *  Whatever is written through the pointer isn't seen by the hash, so
+     *  the page is hashed afresh by hash() until hashPages() is called.
+     */
+    uint8_t *writablePage(uint8_t page)
+    {
+        if (!_pages[page].unique())
+            unshare(page);
+        if (!_unhashed.test(page))
+        {
+            _hash ^= _page_hashes[page];
+            _unhashed.set(page);
+        }
+        return _pages[page]->bytes.data();
+    }
+
+    /** Whether anything else holds @p page, so writing to it would copy it.
+     */
+    bool shared(uint8_t page) const { return !_pages[page].unique(); }
+
+    /** Whether @p page is the very same memory in both.
+     */
+    bool samePage(const PagedMemory &other, uint8_t page) const { return _pages[page] == other._pages[page]; }
+
+    /** Sets every byte to @p value.
+     */
+    void fill(uint8_t value);
+
+    /** The hash of the whole of memory.
+     *
+     *  It takes no time at all, besides hashing each page which could have
+     *  been written through a pointer from writablePage().
+     */
+    uint64_t hash() const;
+
+    /** Whether hash() takes no time at all, as no page has to be hashed afresh.
+     */
+    bool hashed() const { return _unhashed.none(); }
+
+    /** Hashes the pages handed out by writablePage() once and for all, so
+     *  hash() doesn't have to.  Only call it once nothing writes through
+     *  those pointers any more.
+     */
+    void hashPages();
+
+    /** The key of @p address holding @p value, which is 0 for a value of 0,
+     *  so that memory which is all zeros hashes to 0.
+     */
+    static uint64_t keyOf(addressType address, uint8_t value)
+    {
+        return (value == 0) ? 0 : mix((static_cast<uint64_t>(address) << 8) | value);
+    }
+
+    /** SplitMix64, which scatters @p number over all 64 bits.
+     */
+    static uint64_t mix(uint64_t number)
+    {
+        number += 0x9E3779B97F4A7C15ULL;
+        number  = (number ^ (number >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        number  = (number ^ (number >> 27)) * 0x94D049BB133111EBULL;
+        return number ^ (number >> 31);
+    }
+
+    /** Sets what to call when the memory backing a page has changed, after
+     *  the page was copied or filled, or when a copy has come to share it.
+     *  Anything pointing at the old memory, or writing to a page which is
+     *  now shared, must look it up again with readPage() or writablePage().
+     */
+    void setPageChanged(pageChangedDelegate page_changed) { _page_changed = page_changed; }
+
+private:
+    struct Page
+    {
+        explicit Page(const pageType &contents) : bytes(contents) { }
+
+        pageType              bytes;
+        std::atomic<unsigned> holders { 1 };
+    };
+
+    // Holds a Page, and lets go of it when done.  Letting go releases, and
+    // unique() acquires, so once a holder finds itself the only one left,
+    // everything the others did with the page happened before it writes.
+    class PageRef
+    {
+    public:
+        PageRef() { }
+        explicit PageRef(Page *page) : _page(page) { }
+        PageRef(const PageRef &other) : _page(other._page) { hold(); }
+        ~PageRef() { release(); }
+
+        PageRef &operator =(const PageRef &other)
+        {
+            if (other._page != _page)
+            {
+                other.hold();
+                release();
+                _page = other._page;
+            }
+            return *this;
+        }
+
+        Page *operator ->() const { return _page; }
+        bool operator ==(const PageRef &other) const { return _page == other._page; }
+
+        bool unique() const { return _page->holders.load(std::memory_order_acquire) == 1; }
+
+    private:
+        Page *_page = nullptr;
+
+        void hold() const
+        {
+            if (_page)
+                _page->holders.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void release()
+        {
+            if (_page && (_page->holders.fetch_sub(1, std::memory_order_acq_rel) == 1))
+                delete _page;
+        }
+    };
+
+    std::array<PageRef, 0x100>  _pages;
+    std::array<uint64_t, 0x100> _page_hashes {}; // Only kept up to date for the hashed pages
+    std::bitset<0x100>          _unhashed;       // The pages handed out by writablePage()
+    uint64_t                    _hash = 0;       // Of the hashed pages
+    pageChangedDelegate         _page_changed;
+
+    void unshare(uint8_t page);
+
+    uint64_t hashOf(uint8_t page) const;
+};
+
+#endif // PAGEDMEMORY_HPP
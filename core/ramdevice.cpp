@@ -0,0 +1,32 @@
+#include "ramdevice.hpp"
+
+
+RamDevice::RamDevice(addressType lower_address, addressType upper_address)
+    :
+    BusDevice(lower_address, upper_address, true, true)
+{
+}
+
+RamDevice::~RamDevice()
+{
+}
+
+const uint8_t *RamDevice::directReadPage(addressType page_address) const
+{
+    return _data.data() + (page_address & 0xFF00);
+}
+
+uint8_t *RamDevice::directWritePage(addressType page_address)
+{
+    return _data.data() + (page_address & 0xFF00);
+}
+
+void RamDevice::writeImplementation(addressType address, uint8_t data)
+{
+    _data[address] = data;
+}
+
+uint8_t RamDevice::readImplementation(addressType address, bool)
+{
+    return _data[address];
+}
@@ -0,0 +1,38 @@
+#ifndef RAMDEVICE_HPP
+#define RAMDEVICE_HPP
+
+#include "busdevice.hpp"
+#include <array>
+
+
+/** A contiguous block of RAM on a MemoryBus.
+ *
+ *  The whole address space is backed, so every page it covers can be
+ *  accessed directly.
+ *
+ *  @see RamBusDevice, which QML sees, and which only signals
+ *       @c memoryRefreshed() once per refresh from an EmulationThread
+ */
+class RamDevice : public BusDevice
+{
+public:
+    using memory_type = std::array<uint8_t, 64 * 1024>;
+
+    explicit RamDevice(addressType lower_address = 0x0000, addressType upper_address = 0xFFFF);
+    ~RamDevice() override;
+
+    memory_type       &memory() { return _data; }
+    const memory_type &memory() const { return _data; }
+
+    const uint8_t *directReadPage(addressType page_address) const override;
+          uint8_t *directWritePage(addressType page_address) override;
+
+protected:
+    void    writeImplementation(addressType address, uint8_t data) override;
+    uint8_t readImplementation(addressType address, bool read_only) override;
+
+private:
+    memory_type _data {};
+};
+
+#endif // RAMDEVICE_HPP
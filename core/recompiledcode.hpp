@@ -0,0 +1,236 @@
+#ifndef RECOMPILEDCODE_HPP
+#define RECOMPILEDCODE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include "decimalmode.hpp"
+#include "registers.hpp"
+
+class RecompiledRunner;
+
+// Everything the C++ written out by StaticRecompiler is built on. Each basic
+// block of the program becomes a function taking a RecompiledState, which
+// unpacks the registers into a RecompiledCpu held in locals, works on them
+// and on the memory array, and packs them back up along with the address to
+// carry on from when it returns. The operations mirror InstructionExecutor
+// exactly, cycle counts included.
+
+/** What a block of recompiled code runs against.
+ */
+struct RecompiledState
+{
+    Registers        &registers;
+    uint8_t          *memory;           ///< All 64K of the address space
+    const uint8_t    *code;             ///< Non-zero for each address holding recompiled code
+    RecompiledRunner *runner;
+    uint64_t          cycles = 0;       ///< Clock cycles consumed, running total
+    uint64_t          instructions = 0; ///< Instructions executed, running total
+    bool              stop = false;     ///< Set when recompiled code has been written to
+};
+
+using recompiledBlockFunction = void (*)(RecompiledState &state);
+
+/** A basic block of a recompiled program.
+ */
+struct RecompiledBlock
+{
+    uint16_t                start;
+    uint16_t                length;  ///< In bytes of guest code
+    const uint8_t          *bytes;   ///< The guest code the block was compiled from
+    recompiledBlockFunction code;
+};
+
+/** The table of blocks written out for a program.
+ */
+struct RecompiledProgram
+{
+    const RecompiledBlock *blocks;
+    size_t                 block_count;
+};
+
+/** Called when recompiled code writes to an address holding recompiled code.
+ */
+void recompiledCodeWritten(RecompiledState &state, uint16_t address);
+
+
+class RecompiledCpu
+{
+public:
+    uint8_t  a, x, y, stack_pointer;
+    bool     carry, zero, interrupt, decimal, brk, overflow, negative;
+    uint32_t cycles = 0;
+    uint32_t instructions = 0;
+
+    explicit RecompiledCpu(RecompiledState &state)
+        :
+        a(state.registers.a),
+        x(state.registers.x),
+        y(state.registers.y),
+        stack_pointer(state.registers.stack_pointer),
+        _memory(state.memory),
+        _code(state.code),
+        _state(state)
+    {
+        setStatus(state.registers.status);
+    }
+
+    void leave(RecompiledState &state, uint16_t pc)
+    {
+        state.registers.a = a;
+        state.registers.x = x;
+        state.registers.y = y;
+        state.registers.stack_pointer = stack_pointer;
+        state.registers.program_counter = pc;
+        state.registers.status = status();
+        state.cycles += cycles;
+        state.instructions += instructions;
+    }
+
+    // Accounts for an instruction taking some cycles
+    void tick(uint32_t instruction_cycles)
+    {
+        cycles += instruction_cycles;
+        ++instructions;
+    }
+
+    // The unused bit always reads back set, as every instruction sets it.
+    uint8_t status() const
+    {
+        return static_cast<uint8_t>((carry ? C : 0) | (zero ? Z : 0) | (interrupt ? I : 0) | (decimal ? D : 0) |
+                                    (brk ? B : 0) | U | (overflow ? V : 0) | (negative ? N : 0));
+    }
+    void setStatus(uint8_t status)
+    {
+        carry     = status & C;
+        zero      = status & Z;
+        interrupt = status & I;
+        decimal   = status & D;
+        brk       = status & B;
+        overflow  = status & V;
+        negative  = status & N;
+    }
+
+    // Memory. Writes that may land on recompiled code are checked, and
+    // stopped() says whether one did.
+    uint8_t read(uint16_t address) const { return _memory[address]; }
+    void    writeData(uint16_t address, uint8_t value) { _memory[address] = value; }
+    void    write(uint16_t address, uint8_t value)
+    {
+        _memory[address] = value;
+        if (_code[address])
+            recompiledCodeWritten(_state, address);
+    }
+    bool    stopped() const { return _state.stop; }
+
+    void    push(uint8_t value)     { write(0x0100 + stack_pointer--, value); }
+    void    pushData(uint8_t value) { writeData(0x0100 + stack_pointer--, value); }
+    uint8_t pull()                  { return read(0x0100 + ++stack_pointer); }
+
+    // Addressing modes, where they need working out at run time
+    uint16_t zeroPageX(uint8_t base) const { return (base + x) & 0x00FF; }
+    uint16_t zeroPageY(uint8_t base) const { return (base + y) & 0x00FF; }
+    uint16_t absoluteX(uint16_t base, bool extra_cycle) { return indexed(base, x, extra_cycle); }
+    uint16_t absoluteY(uint16_t base, bool extra_cycle) { return indexed(base, y, extra_cycle); }
+    uint16_t indirect(uint16_t pointer) const
+    {
+        // The page boundary hardware bug
+        const uint16_t high = ((pointer & 0x00FF) == 0x00FF) ? (pointer & 0xFF00) : static_cast<uint16_t>(pointer + 1);
+
+        return static_cast<uint16_t>((read(high) << 8) | read(pointer));
+    }
+    uint16_t indirectX(uint8_t base) const
+    {
+        return static_cast<uint16_t>((read((base + x + 1) & 0x00FF) << 8) | read((base + x) & 0x00FF));
+    }
+    uint16_t indirectY(uint8_t base, bool extra_cycle)
+    {
+        return indexed(static_cast<uint16_t>((read((base + 1) & 0x00FF) << 8) | read(base)), y, extra_cycle);
+    }
+
+    // Operations, where there is more to them than a line
+    uint8_t nz(uint8_t result)
+    {
+        zero = (result == 0x00);
+        negative = result & 0x80;
+        return result;
+    }
+    void adc(uint8_t value)
+    {
+#ifndef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+        if (decimal)
+            return decimalResult(decimalAdd(a, value, carry));
+#endif
+        const uint16_t sum = a + value + (carry ? 1 : 0);
+
+        carry = sum > 0xFF;
+        overflow = (~(a ^ value) & (a ^ sum)) & 0x80;
+        a = nz(sum & 0x00FF);
+    }
+    void sbc(uint8_t value)
+    {
+#ifndef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+        if (decimal)
+            return decimalResult(decimalSubtract(a, value, carry));
+#endif
+        adc(value ^ 0xFF);
+    }
+    void decimalResult(const DecimalResult &result)
+    {
+        a        = result.value;
+        carry    = result.status & C;
+        zero     = result.status & Z;
+        overflow = result.status & V;
+        negative = result.status & N;
+    }
+    void compare(uint8_t reg, uint8_t value)
+    {
+        carry = reg >= value;
+        nz((reg - value) & 0x00FF);
+    }
+    void bit(uint8_t value)
+    {
+        zero = (a & value) == 0x00;
+        negative = value & N;
+        overflow = value & V;
+    }
+    uint8_t asl(uint8_t value)
+    {
+        carry = value & 0x80;
+        return nz((value << 1) & 0x00FF);
+    }
+    uint8_t lsr(uint8_t value)
+    {
+        carry = value & 0x01;
+        return nz(value >> 1);
+    }
+    uint8_t rol(uint8_t value)
+    {
+        const bool carry_in = carry;
+
+        carry = value & 0x80;
+        return nz(((value << 1) | (carry_in ? 0x01 : 0x00)) & 0x00FF);
+    }
+    uint8_t ror(uint8_t value)
+    {
+        const bool carry_in = carry;
+
+        carry = value & 0x01;
+        return nz((value >> 1) | (carry_in ? 0x80 : 0x00));
+    }
+
+private:
+    uint8_t         *_memory;
+    const uint8_t   *_code;
+    RecompiledState &_state;
+
+    uint16_t indexed(uint16_t base, uint8_t index, bool extra_cycle)
+    {
+        const uint16_t address = static_cast<uint16_t>(base + index);
+
+        if (extra_cycle && ((address & 0xFF00) != (base & 0xFF00)))
+            ++cycles;
+        return address;
+    }
+};
+
+#endif // RECOMPILEDCODE_HPP
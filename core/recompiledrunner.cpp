@@ -0,0 +1,139 @@
+#include "recompiledrunner.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+void recompiledCodeWritten(RecompiledState &state, uint16_t address)
+{
+    state.runner->invalidate(address);
+    state.stop = true;
+}
+
+RecompiledRunner::RecompiledRunner(const RecompiledProgram &program, Registers &registers, uint8_t *memory)
+    :
+    _program(program),
+    _memory(memory),
+    _entries(new const RecompiledBlock *[0x10000]()),
+    _code(new uint8_t[0x10000]()),
+    _state { registers, memory, nullptr, this },
+    _interpreter(registers,
+                 [this](addressType address, bool) { return _memory[address]; },
+                 [this](addressType address, uint8_t data)
+                 {
+                     _memory[address] = data;
+                     if (_code[address])
+                         invalidate(address);
+                 })
+{
+    _state.code = _code.get();
+
+    for (size_t index = 0; index < program.block_count; ++index)
+    {
+        const RecompiledBlock &block = program.blocks[index];
+
+        if ((block.start + block.length > 0x10000) ||
+            (std::memcmp(memory + block.start, block.bytes, block.length) != 0))
+            continue;
+
+        _entries[block.start] = &block;
+        std::fill(_code.get() + block.start, _code.get() + block.start + block.length, 1);
+    }
+
+    // Only writes that may land on recompiled code need watching.
+    for (unsigned page = 0; page < 0x100; ++page)
+    {
+        uint8_t *host = memory + page * 0x100;
+        bool     code = std::any_of(_code.get() + page * 0x100, _code.get() + (page + 1) * 0x100,
+                                    [](uint8_t covered) { return covered != 0; });
+
+        _interpreter.mapPage(static_cast<uint8_t>(page), host, code ? nullptr : host);
+    }
+}
+
+RecompiledRunner::~RecompiledRunner()
+{
+}
+
+auto RecompiledRunner::run(uint64_t cycle_budget) -> RunResult
+{
+    RunResult result;
+    const uint64_t start_cycles = _state.cycles;
+    const uint64_t start_instructions = _state.instructions;
+    const InstructionExecutor::runPredicate recompiled = [this](const Registers &registers)
+    {
+        return recompiledAt(registers.program_counter);
+    };
+
+    while (_state.cycles - start_cycles < cycle_budget)
+    {
+        const RecompiledBlock *block = _entries[_state.registers.program_counter];
+
+        if (block)
+        {
+            _state.stop = false;
+            block->code(_state);
+            continue;
+        }
+
+        const RunResult interpreted = _interpreter.runUntil(recompiled, cycle_budget - (_state.cycles - start_cycles));
+
+        // Blocks only start on instruction boundaries, so finish off any
+        // instruction the budget ran out in.
+        if (!_interpreter.complete())
+            _state.cycles += _interpreter.runCycles(_interpreter.remainingCyclesForInstruction()).cycles;
+
+        _state.cycles += interpreted.cycles;
+        _state.instructions += interpreted.instructions;
+        if ((interpreted.reason != StopReason::Condition) && (interpreted.reason != StopReason::BudgetSpent))
+        {
+            result.reason = interpreted.reason;
+            break;
+        }
+    }
+
+    result.cycles = _state.cycles - start_cycles;
+    result.instructions = _state.instructions - start_instructions;
+    return result;
+}
+
+void RecompiledRunner::invalidate(addressType address)
+{
+    if (!_code[address])
+        return;
+
+    // Blocks don't often overlap, but an instruction's operand can be the
+    // start of another one, so every block covering the address goes.
+    uint32_t first = 0x10000;
+    uint32_t last  = 0;
+
+    for (size_t index = 0; index < _program.block_count; ++index)
+    {
+        const RecompiledBlock &block = _program.blocks[index];
+
+        if ((_entries[block.start] == &block) && (static_cast<addressType>(address - block.start) < block.length))
+        {
+            _entries[block.start] = nullptr;
+            first = std::min<uint32_t>(first, block.start);
+            last  = std::max<uint32_t>(last, block.start + block.length);
+        }
+    }
+
+    if (first >= last)
+        return;
+
+    // Writes to the bytes they covered needn't come here again, unless a
+    // block which is still in use covers them too.
+    std::fill(_code.get() + first, _code.get() + last, 0);
+    for (size_t index = 0; index < _program.block_count; ++index)
+    {
+        const RecompiledBlock &block = _program.blocks[index];
+
+        if ((_entries[block.start] == &block) && (block.start < last) && (block.start + block.length > first))
+        {
+            const uint32_t from = std::max<uint32_t>(first, block.start);
+            const uint32_t to   = std::min<uint32_t>(last, block.start + block.length);
+
+            std::fill(_code.get() + from, _code.get() + to, 1);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef RECOMPILEDRUNNER_HPP
+#define RECOMPILEDRUNNER_HPP
+
+#include <cstdint>
+#include <memory>
+#include "instructionexecutor.hpp"
+#include "recompiledcode.hpp"
+
+
+/** Runs a program recompiled ahead of time by StaticRecompiler.
+ *
+ *  Execution goes from block to block of recompiled code, looking each one up
+ *  by the program counter.  Wherever there is no recompiled block, such as
+ *  code reached through a computed jump the recompiler could not follow, or
+ *  code loaded into RAM at run time, an InstructionExecutor takes over until
+ *  the program counter lands on a recompiled block again.
+ *
+ *  A block is only used while memory still holds the code it was compiled
+ *  from.  Blocks whose code does not match when the runner is created, or is
+ *  written to later on, are left to the interpreter from then on.
+ */
+class RecompiledRunner
+{
+public:
+    using addressType = uint16_t;
+    using RunResult   = InstructionExecutor::RunResult;
+    using StopReason  = InstructionExecutor::StopReason;
+
+    /** Creates a runner.
+     *
+     *  @param program   The recompiled program
+     *  @param registers The registers to run with
+     *  @param memory    All 64K of the address space, as plain memory
+     */
+    RecompiledRunner(const RecompiledProgram &program, Registers &registers, uint8_t *memory);
+    RecompiledRunner(const RecompiledRunner &) = delete;
+    ~RecompiledRunner();
+
+    /** Executes until at least @p cycle_budget clock cycles have been consumed.
+     *
+     *  Budgets are only checked between blocks, so a run may go over by up
+     *  to the length of a block.  It stops early if the interpreter stops
+     *  on a BRK or an illegal opcode.
+     */
+    RunResult run(uint64_t cycle_budget);
+
+    /** Indicates whether the code at @p address runs recompiled.
+     */
+    bool recompiledAt(addressType address) const { return _entries[address] != nullptr; }
+
+    /** Indicates whether @p address is part of a block in use, so writing to it invalidates the block.
+     */
+    bool watchesWritesTo(addressType address) const { return _code[address] != 0; }
+
+    /** Stops using any block compiled from @p address.
+     *
+     *  Memory changed by anything other than the program itself must be
+     *  invalidated explicitly.
+     */
+    void invalidate(addressType address);
+
+    /** The interpreter used wherever there is no recompiled code.
+     */
+    InstructionExecutor &interpreter() { return _interpreter; }
+
+    RecompiledRunner &operator =(const RecompiledRunner &) = delete;
+private:
+    const RecompiledProgram              &_program;
+    uint8_t                              *_memory;
+    std::unique_ptr<const RecompiledBlock *[]> _entries; // The block starting at each address, if any
+    std::unique_ptr<uint8_t[]>            _code;    // Non-zero for each address covered by a block
+    RecompiledState                       _state;
+    InstructionExecutor                   _interpreter;
+};
+
+#endif // RECOMPILEDRUNNER_HPP
@@ -3,6 +3,17 @@
 
 #include "flags.hpp"
 
+// Identifies each register in a mask of the ones that have changed
+enum REGISTERS6502 : uint8_t
+{
+    REG_A      = (1 << 0),
+    REG_X      = (1 << 1),
+    REG_Y      = (1 << 2),
+    REG_STKP   = (1 << 3),
+    REG_PC     = (1 << 4),
+    REG_STATUS = (1 << 5),
+};
+
 struct Registers
 {
     uint8_t  a = 0x00;
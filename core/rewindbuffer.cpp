@@ -0,0 +1,184 @@
+#include "rewindbuffer.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+// The differences in a page are encoded as a run of bytes which are the
+// same, then a run of bytes which aren't, given as the XOR of the two, and
+// so on to the end of the page. Each run starts with its length, which is
+// at most 255, and either may be empty. The page number comes first.
+void encodePage(std::vector<uint8_t> &delta, uint8_t page, const uint8_t *older, const uint8_t *newer)
+{
+    delta.push_back(page);
+
+    size_t offset = 0;
+
+    while (offset < PagedMemory::pageSize())
+    {
+        size_t same = 0;
+        size_t different = 0;
+
+        while ((offset + same < PagedMemory::pageSize()) && (same < 0xFF) && (older[offset + same] == newer[offset + same]))
+            ++same;
+        offset += same;
+        while ((offset + different < PagedMemory::pageSize()) && (different < 0xFF) && (older[offset + different] != newer[offset + different]))
+            ++different;
+
+        delta.push_back(static_cast<uint8_t>(same));
+        delta.push_back(static_cast<uint8_t>(different));
+        for (size_t index = 0; index < different; ++index)
+            delta.push_back(older[offset + index] ^ newer[offset + index]);
+        offset += different;
+    }
+}
+
+// XORs the differences back into memory, which changes either page into the other
+void applyDelta(const std::vector<uint8_t> &delta, PagedMemory &memory)
+{
+    const uint8_t *encoded = delta.data();
+    const uint8_t *end     = encoded + delta.size();
+
+    while (encoded < end)
+    {
+        uint8_t *page   = memory.writablePage(*encoded++);
+        size_t   offset = 0;
+
+        while (offset < PagedMemory::pageSize())
+        {
+            const size_t same      = *encoded++;
+            const size_t different = *encoded++;
+
+            offset += same;
+            for (size_t index = 0; index < different; ++index)
+                page[offset++] ^= *encoded++;
+        }
+    }
+}
+}
+
+RewindBuffer::RewindBuffer(uint64_t interval, size_t budget)
+    :
+    _interval(std::max<uint64_t>(interval, 1)),
+    _budget(budget)
+{
+}
+
+RewindBuffer::~RewindBuffer()
+{
+}
+
+// The machine's memory and _newest share the pages which haven't been
+// written to since the last checkpoint, so those are skipped without
+// looking at them.
+void RewindBuffer::capture(Machine &machine)
+{
+    Machine::Snapshot snapshot = machine.snapshot();
+    Checkpoint        checkpoint { machine.executor().clock_ticks, snapshot.registers, snapshot.executor, {} };
+
+    if (!_checkpoints.empty())
+    {
+        for (size_t index = 0; index < PagedMemory::numberOfPages(); ++index)
+        {
+            const uint8_t  page  = static_cast<uint8_t>(index);
+            const uint8_t *older = _newest.readPage(page);
+            const uint8_t *newer = snapshot.memory.readPage(page);
+
+            if (_newest.samePage(snapshot.memory, page) || (std::memcmp(older, newer, PagedMemory::pageSize()) == 0))
+                continue;
+            encodePage(checkpoint.delta, page, older, newer);
+        }
+        checkpoint.delta.shrink_to_fit();
+    }
+
+    _newest = snapshot.memory;
+    _size  += sizeOf(checkpoint);
+    _checkpoints.push_back(std::move(checkpoint));
+    trim();
+}
+
+auto RewindBuffer::run(Machine &machine, uint64_t cycle_budget) -> RunResult
+{
+    RunResult result;
+
+    if (_checkpoints.empty())
+        capture(machine);
+
+    while (result.cycles < cycle_budget)
+    {
+        const uint64_t due = newest() + _interval;
+
+        if (machine.executor().clock_ticks >= due)
+        {
+            capture(machine);
+            continue;
+        }
+
+        const RunResult part = machine.run(std::min(cycle_budget - result.cycles, due - machine.executor().clock_ticks));
+
+        result.cycles       += part.cycles;
+        result.instructions += part.instructions;
+        result.reason        = part.reason;
+        result.idle          = part.idle;
+        if (part.reason != InstructionExecutor::StopReason::BudgetSpent)
+            break;
+    }
+
+    if (machine.executor().clock_ticks >= newest() + _interval)
+        capture(machine);
+    return result;
+}
+
+bool RewindBuffer::rewindTo(Machine &machine, uint64_t clock_ticks)
+{
+    if (_checkpoints.empty() || (clock_ticks < oldest()) || (clock_ticks > machine.executor().clock_ticks))
+        return false;
+
+    while (newest() > clock_ticks)
+        dropNewest();
+
+    const Checkpoint &checkpoint = _checkpoints.back();
+
+    machine.restore({ checkpoint.registers, checkpoint.executor, _newest });
+
+    // A run always executes the instruction it starts on, so one stopping
+    // in front of a BRK or a breakpoint doesn't hold this up.
+    while (machine.executor().clock_ticks < clock_ticks)
+        machine.executor().runCycles(clock_ticks - machine.executor().clock_ticks);
+    return true;
+}
+
+bool RewindBuffer::stepBack(Machine &machine, uint64_t cycles)
+{
+    const uint64_t now = machine.executor().clock_ticks;
+
+    return (cycles <= now) && rewindTo(machine, now - cycles);
+}
+
+void RewindBuffer::clear()
+{
+    _checkpoints.clear();
+    _newest = PagedMemory();
+    _size   = 0;
+}
+
+void RewindBuffer::dropNewest()
+{
+    applyDelta(_checkpoints.back().delta, _newest);
+    _size -= sizeOf(_checkpoints.back());
+    _checkpoints.pop_back();
+}
+
+// Nothing is ever rewound past the oldest checkpoint, so its own changes
+// aren't needed either.
+void RewindBuffer::trim()
+{
+    while ((_size > _budget) && (_checkpoints.size() > 1))
+    {
+        _size -= sizeOf(_checkpoints.front());
+        _checkpoints.pop_front();
+        _size -= _checkpoints.front().delta.size();
+        _checkpoints.front().delta = std::vector<uint8_t>();
+    }
+}
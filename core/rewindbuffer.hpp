@@ -0,0 +1,108 @@
+#ifndef REWINDBUFFER_HPP
+#define REWINDBUFFER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "machine.hpp"
+
+
+/** Checkpoints of a Machine taken every so many cycles, to go back in time.
+ *
+ *  Only the newest checkpoint's memory is kept whole, and it shares its
+ *  pages with the machine (see PagedMemory).  Every other checkpoint keeps
+ *  just the pages which changed between it and the one after it, each
+ *  XORed with the newer page and run length encoded.  As a guest rarely
+ *  changes more than a few bytes of a page, a checkpoint takes up tens of
+ *  bytes rather than kilobytes.  When the checkpoints outgrow the budget,
+ *  the oldest are forgotten.
+ *
+ *  Going back to a cycle restores the newest checkpoint at or before it,
+ *  then runs the machine forward to it.  That reproduces exactly what
+ *  happened, so long as nothing from outside the machine, such as an
+ *  event or an interrupt, played a part since the checkpoint.
+ */
+class RewindBuffer
+{
+public:
+    using RunResult = Machine::RunResult;
+
+    /** @param interval The cycles between checkpoints taken by run()
+     *  @param budget   The bytes the checkpoints may take up
+     */
+    RewindBuffer(uint64_t interval, size_t budget);
+    RewindBuffer(const RewindBuffer &) = delete;
+    ~RewindBuffer();
+
+    uint64_t interval() const { return _interval; }
+    size_t   budget() const { return _budget; }
+
+    /** The bytes taken up by the checkpoints, which never exceeds budget()
+     *  unless the newest checkpoint alone does.
+     */
+    size_t size() const { return _size; }
+
+    size_t checkpoints() const { return _checkpoints.size(); }
+
+    /** The clock_ticks of the oldest and newest checkpoints.
+     */
+    ///@{
+    uint64_t oldest() const { return _checkpoints.empty() ? 0 : _checkpoints.front().clock_ticks; }
+    uint64_t newest() const { return _checkpoints.empty() ? 0 : _checkpoints.back().clock_ticks; }
+    ///@}
+
+    /** Adds a checkpoint of @p machine as it is now.
+     */
+    void capture(Machine &machine);
+
+    /** Runs @p machine as Machine::run() does, taking a checkpoint whenever
+     *  interval() cycles have passed since the last one.
+     */
+    RunResult run(Machine &machine, uint64_t cycle_budget);
+
+    /** Puts @p machine back the way it was when its clock_ticks were @p clock_ticks.
+     *
+     *  The checkpoints after it are forgotten, as what happens next may be
+     *  different.
+     *
+     *  @return false if @p clock_ticks is before the oldest checkpoint or
+     *          after the machine's clock, and nothing was done
+     */
+    bool rewindTo(Machine &machine, uint64_t clock_ticks);
+
+    /** Goes back @p cycles from where @p machine is now.
+     *
+     *  @see rewindTo
+     */
+    bool stepBack(Machine &machine, uint64_t cycles);
+
+    /** Forgets every checkpoint.
+     */
+    void clear();
+
+    RewindBuffer &operator =(const RewindBuffer &) = delete;
+private:
+    struct Checkpoint
+    {
+        uint64_t                   clock_ticks;
+        Registers                  registers;
+        InstructionExecutor::State executor;
+        std::vector<uint8_t>       delta; // The pages which changed since the checkpoint before
+    };
+
+    uint64_t               _interval;
+    size_t                 _budget;
+    size_t                 _size = 0;
+    std::deque<Checkpoint> _checkpoints;
+    PagedMemory            _newest;      // The memory of the newest checkpoint
+
+    static size_t sizeOf(const Checkpoint &checkpoint) { return sizeof(Checkpoint) + checkpoint.delta.size(); }
+
+    // Takes the newest checkpoint's changes back out of _newest, and forgets it
+    void dropNewest();
+
+    // Forgets the oldest checkpoints until the rest fit the budget
+    void trim();
+};
+
+#endif // REWINDBUFFER_HPP
@@ -0,0 +1,69 @@
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+
+/** A fixed size queue between exactly one producer thread and one consumer thread.
+ *
+ *  Neither side ever blocks or takes a lock: @c push() fails when the queue
+ *  is full, and @c pop() fails when it is empty.  Each index is only ever
+ *  written by one side, and they live on separate cache lines so the two
+ *  threads don't fight over them.
+ *
+ *  @tparam T        What is queued.  It is copied in and out.
+ *  @tparam Capacity How many entries fit, which must be a power of two
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity > 0) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of two");
+public:
+    static constexpr size_t capacity() { return Capacity; }
+
+    /** Adds @p value to the back of the queue.  Only the producer may call this.
+     *
+     *  @return false if the queue is full, in which case nothing is added
+     */
+    bool push(const T &value)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        _entries[tail & (Capacity - 1)] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Takes the front of the queue into @p value.  Only the consumer may call this.
+     *
+     *  @return false if the queue is empty, in which case @p value is untouched
+     */
+    bool pop(T &value)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        value = _entries[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Whether the queue is empty.  This is only a hint while the producer is running.
+     */
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> _head { 0 }; // Next entry to pop, written by the consumer
+    alignas(64) std::atomic<size_t> _tail { 0 }; // Next entry to push, written by the producer
+    alignas(64) std::array<T, Capacity> _entries {};
+};
+
+#endif // SPSCQUEUE_HPP
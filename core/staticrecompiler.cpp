@@ -0,0 +1,538 @@
+#include "staticrecompiler.hpp"
+#include "instructionexecutor.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <ostream>
+#include <set>
+
+
+namespace
+{
+using Operation      = InstructionExecutor::Operation;
+using AddressingMode = InstructionExecutor::AddressingMode;
+using addressType    = StaticRecompiler::addressType;
+
+std::string hex(unsigned value, int digits)
+{
+    char text[8];
+
+    std::snprintf(text, sizeof(text), "0x%0*X", digits, value);
+    return text;
+}
+
+std::string hex8(unsigned value)  { return hex(value & 0xFF, 2); }
+std::string hex16(unsigned value) { return hex(value & 0xFFFF, 4); }
+
+const InstructionExecutor::INSTRUCTION &entryFor(const StaticRecompiler::Instruction &instruction)
+{
+    return InstructionExecutor::instructionFor(instruction.opcode);
+}
+
+bool isBranch(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::BCC: case Operation::BCS: case Operation::BEQ: case Operation::BMI:
+    case Operation::BNE: case Operation::BPL: case Operation::BVC: case Operation::BVS:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool endsBlock(Operation operation)
+{
+    return isBranch(operation) ||
+           (operation == Operation::JMP) || (operation == Operation::JSR) ||
+           (operation == Operation::RTS) || (operation == Operation::RTI);
+}
+
+// The operations which take an extra cycle when their addressing mode
+// crosses a page
+bool takesExtraCycle(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::ADC: case Operation::AND: case Operation::CMP: case Operation::EOR:
+    case Operation::LDA: case Operation::LDX: case Operation::LDY: case Operation::ORA:
+    case Operation::SBC:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The condition a branch is taken on
+const char *branchCondition(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::BCC: return "!cpu.carry";
+    case Operation::BCS: return "cpu.carry";
+    case Operation::BNE: return "!cpu.zero";
+    case Operation::BEQ: return "cpu.zero";
+    case Operation::BPL: return "!cpu.negative";
+    case Operation::BMI: return "cpu.negative";
+    case Operation::BVC: return "!cpu.overflow";
+    default:             return "cpu.overflow";
+    }
+}
+
+addressType nextAddress(const StaticRecompiler::Instruction &instruction)
+{
+    return static_cast<addressType>(instruction.address + instruction.length);
+}
+
+addressType branchTarget(const StaticRecompiler::Instruction &instruction)
+{
+    return static_cast<addressType>(nextAddress(instruction) + instruction.operand);
+}
+
+std::string disassemble(const StaticRecompiler::Instruction &instruction)
+{
+    const std::string name = InstructionExecutor::nameOf(instruction.opcode);
+    char operand[16] = "";
+
+    switch (entryFor(instruction).addrmode)
+    {
+    case AddressingMode::IMP: break;
+    case AddressingMode::IMM: std::snprintf(operand, sizeof(operand), " #$%02X", instruction.operand & 0xFF); break;
+    case AddressingMode::ZP0: std::snprintf(operand, sizeof(operand), " $%02X", instruction.operand & 0xFF); break;
+    case AddressingMode::ZPX: std::snprintf(operand, sizeof(operand), " $%02X,X", instruction.operand & 0xFF); break;
+    case AddressingMode::ZPY: std::snprintf(operand, sizeof(operand), " $%02X,Y", instruction.operand & 0xFF); break;
+    case AddressingMode::REL: std::snprintf(operand, sizeof(operand), " $%04X", branchTarget(instruction)); break;
+    case AddressingMode::ABS: std::snprintf(operand, sizeof(operand), " $%04X", instruction.operand); break;
+    case AddressingMode::ABX: std::snprintf(operand, sizeof(operand), " $%04X,X", instruction.operand); break;
+    case AddressingMode::ABY: std::snprintf(operand, sizeof(operand), " $%04X,Y", instruction.operand); break;
+    case AddressingMode::IND: std::snprintf(operand, sizeof(operand), " ($%04X)", instruction.operand); break;
+    case AddressingMode::IZX: std::snprintf(operand, sizeof(operand), " ($%02X,X)", instruction.operand & 0xFF); break;
+    case AddressingMode::IZY: std::snprintf(operand, sizeof(operand), " ($%02X),Y", instruction.operand & 0xFF); break;
+    case AddressingMode::ZPI: case AddressingMode::IAX: case AddressingMode::ZPR: break; // Only on the 65C02
+    }
+    return name + operand;
+}
+}
+
+
+StaticRecompiler::StaticRecompiler(std::vector<uint8_t> image, addressType load_address)
+    :
+    _image(std::move(image)),
+    _load_address(load_address)
+{
+    if (_image.size() > 0x10000)
+        _image.resize(0x10000);
+}
+
+void StaticRecompiler::addEntryPoint(addressType address)
+{
+    _entry_points.push_back(address);
+    _analysed = false;
+}
+
+int StaticRecompiler::addVectorEntryPoints()
+{
+    int found = 0;
+
+    for (addressType vector : { 0xFFFA, 0xFFFC, 0xFFFE })
+    {
+        if (inImage(vector, 2))
+        {
+            addEntryPoint(static_cast<addressType>(byteAt(vector) | (byteAt(vector + 1) << 8)));
+            ++found;
+        }
+    }
+    return found;
+}
+
+bool StaticRecompiler::inImage(addressType address, unsigned length) const
+{
+    const unsigned offset = static_cast<addressType>(address - _load_address);
+
+    return offset + length <= _image.size();
+}
+
+bool StaticRecompiler::decode(addressType address, Instruction &instruction) const
+{
+    if (!inImage(address, 1))
+        return false;
+
+    instruction.address = address;
+    instruction.opcode  = byteAt(address);
+    instruction.length  = InstructionExecutor::lengthOf(instruction.opcode);
+    instruction.operand = 0;
+
+    const auto &entry = InstructionExecutor::instructionFor(instruction.opcode);
+
+    // These are left for the interpreter to stop on.
+    if ((entry.operate == Operation::BRK) || (entry.operate == Operation::XXX))
+        return false;
+    if (!inImage(address, instruction.length))
+        return false;
+
+    for (uint8_t offset = 1; offset < instruction.length; ++offset)
+        instruction.operand |= byteAt(static_cast<addressType>(address + offset)) << (8 * (offset - 1));
+    if ((entry.addrmode == AddressingMode::REL) && (instruction.operand & 0x80))
+        instruction.operand |= 0xFF00;
+    return true;
+}
+
+auto StaticRecompiler::analyse() -> const std::vector<Block> &
+{
+    if (_analysed)
+        return _blocks;
+
+    // Follow every path through the code, noting where each instruction
+    // starts and where blocks have to start: wherever control can arrive
+    // other than by falling through.
+    std::bitset<0x10000>    instruction_starts;
+    std::set<addressType>   leaders(_entry_points.begin(), _entry_points.end());
+    std::vector<addressType> pending(_entry_points.begin(), _entry_points.end());
+    Instruction             instruction;
+
+    const auto follow = [&](addressType address)
+    {
+        leaders.insert(address);
+        pending.push_back(address);
+    };
+
+    while (!pending.empty())
+    {
+        addressType address = pending.back();
+
+        pending.pop_back();
+        while (!instruction_starts.test(address) && decode(address, instruction))
+        {
+            const Operation operation = entryFor(instruction).operate;
+
+            instruction_starts.set(address);
+            address = nextAddress(instruction);
+
+            if (isBranch(operation))
+            {
+                follow(branchTarget(instruction));
+                follow(address);
+            }
+            else if (operation == Operation::JSR)
+            {
+                follow(instruction.operand);
+                follow(address);
+            }
+            else if ((operation == Operation::JMP) && (entryFor(instruction).addrmode == AddressingMode::ABS))
+                follow(instruction.operand);
+
+            if (endsBlock(operation))
+                break;
+        }
+    }
+
+    // Then gather the blocks, each running from a leader up to the
+    // instruction ending it or the next leader.
+    _blocks.clear();
+    _code.reset();
+    for (addressType leader : leaders)
+    {
+        if (!instruction_starts.test(leader))
+            continue;
+
+        Block       block { leader, 0, {} };
+        addressType address = leader;
+
+        do
+        {
+            decode(address, instruction);
+            block.instructions.push_back(instruction);
+            block.length += instruction.length;
+            address = nextAddress(instruction);
+        }
+        while (!endsBlock(entryFor(instruction).operate) &&
+               instruction_starts.test(address) && !leaders.count(address));
+
+        for (unsigned offset = 0; offset < block.length; ++offset)
+            _code.set(static_cast<addressType>(block.start + offset));
+        _blocks.push_back(std::move(block));
+    }
+    _analysed = true;
+    return _blocks;
+}
+
+// Whether writing somewhere in the range could change recompiled code
+bool StaticRecompiler::mayWriteCode(addressType first, unsigned count) const
+{
+    for (unsigned offset = 0; offset < count; ++offset)
+    {
+        if (_code.test(static_cast<addressType>(first + offset)))
+            return true;
+    }
+    return false;
+}
+
+void StaticRecompiler::generate(std::ostream &out, const std::string &name, const std::string &source)
+{
+    analyse();
+
+    out << "// Recompiled from " << source << " by recompile6502. Do not edit.\n"
+        << "\n"
+        << "#include \"recompiledcode.hpp\"\n"
+        << "\n";
+
+    if (_blocks.empty())
+    {
+        out << "extern const RecompiledProgram " << name << " = { nullptr, 0 };\n";
+        return;
+    }
+
+    out << "namespace\n"
+        << "{\n"
+        << "// The code each block was recompiled from, so it can be checked for at run time\n"
+        << "const uint8_t code[] =\n"
+        << "{";
+
+    size_t count = 0;
+
+    for (const Block &block : _blocks)
+    {
+        for (unsigned offset = 0; offset < block.length; ++offset, ++count)
+        {
+            out << ((count % 16) ? " " : "\n    ")
+                << hex8(byteAt(static_cast<addressType>(block.start + offset))) << ",";
+        }
+    }
+    out << "\n"
+        << "};\n";
+
+    for (const Block &block : _blocks)
+        generateBlock(out, block);
+
+    out << "\n"
+        << "const RecompiledBlock blocks[] =\n"
+        << "{\n";
+
+    size_t offset = 0;
+
+    for (const Block &block : _blocks)
+    {
+        out << "    { " << hex16(block.start) << ", " << block.length << ", code + " << offset
+            << ", &block_" << hex16(block.start).substr(2) << " },\n";
+        offset += block.length;
+    }
+    out << "};\n"
+        << "}\n"
+        << "\n"
+        << "extern const RecompiledProgram " << name << " = { blocks, " << _blocks.size() << " };\n";
+}
+
+void StaticRecompiler::generateBlock(std::ostream &out, const Block &block) const
+{
+    out << "\n"
+        << "void block_" << hex16(block.start).substr(2) << "(RecompiledState &state)\n"
+        << "{\n"
+        << "    RecompiledCpu cpu(state);\n";
+
+    for (const Instruction &instruction : block.instructions)
+        generateInstruction(out, instruction, &instruction == &block.instructions.back());
+
+    out << "}\n";
+}
+
+void StaticRecompiler::generateInstruction(std::ostream &out, const Instruction &instruction, bool last) const
+{
+    const auto       &entry = entryFor(instruction);
+    const std::string next = hex16(nextAddress(instruction));
+    const std::string extra_cycle = takesExtraCycle(entry.operate) ? "true" : "false";
+    bool              checked = false; // Whether the instruction may write to recompiled code
+
+    // Where the operand is, and whether writing to it might change code
+    std::string address;
+
+    switch (entry.addrmode)
+    {
+    case AddressingMode::IMP:
+    case AddressingMode::IMM:
+    case AddressingMode::REL:
+        break;
+    case AddressingMode::ZP0:
+        address = hex16(instruction.operand & 0xFF);
+        checked = mayWriteCode(instruction.operand & 0xFF, 1);
+        break;
+    case AddressingMode::ABS:
+        address = hex16(instruction.operand);
+        checked = mayWriteCode(instruction.operand, 1);
+        break;
+    case AddressingMode::ZPX:
+    case AddressingMode::ZPY:
+        address = std::string((entry.addrmode == AddressingMode::ZPX) ? "cpu.zeroPageX(" : "cpu.zeroPageY(") +
+                  hex8(instruction.operand) + ")";
+        checked = mayWriteCode(0x0000, 0x100);
+        break;
+    case AddressingMode::ABX:
+    case AddressingMode::ABY:
+        address = std::string((entry.addrmode == AddressingMode::ABX) ? "cpu.absoluteX(" : "cpu.absoluteY(") +
+                  hex16(instruction.operand) + ", " + extra_cycle + ")";
+        checked = mayWriteCode(instruction.operand, 0x100);
+        break;
+    case AddressingMode::IND:
+        address = "cpu.indirect(" + hex16(instruction.operand) + ")";
+        checked = true;
+        break;
+    case AddressingMode::IZX:
+        address = "cpu.indirectX(" + hex8(instruction.operand) + ")";
+        checked = true;
+        break;
+    case AddressingMode::IZY:
+        address = "cpu.indirectY(" + hex8(instruction.operand) + ", " + extra_cycle + ")";
+        checked = true;
+        break;
+    case AddressingMode::ZPI:
+    case AddressingMode::IAX:
+    case AddressingMode::ZPR:
+        break;
+    }
+
+    const bool        computed = (address.find('(') != std::string::npos);
+    const std::string value = (entry.addrmode == AddressingMode::IMP) ? "cpu.a" :
+                              (entry.addrmode == AddressingMode::IMM) ? hex8(instruction.operand) :
+                              "cpu.read(" + address + ")";
+    const std::string write = checked ? "cpu.write(" : "cpu.writeData(";
+    const bool        stack_checked = mayWriteCode(0x0100, 0x100);
+    const std::string push = stack_checked ? "cpu.push(" : "cpu.pushData(";
+
+    // Read, modify, write. A computed address is only worked out once.
+    const auto modify = [&](const std::string &before, const std::string &after)
+    {
+        if (entry.addrmode == AddressingMode::IMP)
+            return "    cpu.a = " + before + "cpu.a" + after + ";\n";
+        if (computed)
+        {
+            return "    {\n"
+                   "        const uint16_t address = " + address + ";\n"
+                   "\n"
+                   "        " + write + "address, " + before + "cpu.read(address)" + after + ");\n"
+                   "    }\n";
+        }
+        return "    " + write + address + ", " + before + "cpu.read(" + address + ")" + after + ");\n";
+    };
+
+    out << "\n"
+        << "    // $" << hex16(instruction.address).substr(2) << "  " << disassemble(instruction) << "\n"
+        << "    cpu.tick(" << static_cast<unsigned>(entry.cycles) << ");\n";
+
+    switch (entry.operate)
+    {
+    case Operation::ADC: out << "    cpu.adc(" << value << ");\n"; break;
+    case Operation::SBC: out << "    cpu.sbc(" << value << ");\n"; break;
+    case Operation::AND: out << "    cpu.a = cpu.nz(cpu.a & " << value << ");\n"; break;
+    case Operation::ORA: out << "    cpu.a = cpu.nz(cpu.a | " << value << ");\n"; break;
+    case Operation::EOR: out << "    cpu.a = cpu.nz(cpu.a ^ " << value << ");\n"; break;
+    case Operation::BIT: out << "    cpu.bit(" << value << ");\n"; break;
+    case Operation::CMP: out << "    cpu.compare(cpu.a, " << value << ");\n"; break;
+    case Operation::CPX: out << "    cpu.compare(cpu.x, " << value << ");\n"; break;
+    case Operation::CPY: out << "    cpu.compare(cpu.y, " << value << ");\n"; break;
+    case Operation::LDA: out << "    cpu.a = cpu.nz(" << value << ");\n"; break;
+    case Operation::LDX: out << "    cpu.x = cpu.nz(" << value << ");\n"; break;
+    case Operation::LDY: out << "    cpu.y = cpu.nz(" << value << ");\n"; break;
+    case Operation::STA: out << "    " << write << address << ", cpu.a);\n"; break;
+    case Operation::STX: out << "    " << write << address << ", cpu.x);\n"; break;
+    case Operation::STY: out << "    " << write << address << ", cpu.y);\n"; break;
+    case Operation::ASL: out << modify("cpu.asl(", ")"); break;
+    case Operation::LSR: out << modify("cpu.lsr(", ")"); break;
+    case Operation::ROL: out << modify("cpu.rol(", ")"); break;
+    case Operation::ROR: out << modify("cpu.ror(", ")"); break;
+    case Operation::INC: out << modify("cpu.nz(", " + 1)"); break;
+    case Operation::DEC: out << modify("cpu.nz(", " - 1)"); break;
+    case Operation::INX: out << "    cpu.x = cpu.nz(cpu.x + 1);\n"; break;
+    case Operation::INY: out << "    cpu.y = cpu.nz(cpu.y + 1);\n"; break;
+    case Operation::DEX: out << "    cpu.x = cpu.nz(cpu.x - 1);\n"; break;
+    case Operation::DEY: out << "    cpu.y = cpu.nz(cpu.y - 1);\n"; break;
+    case Operation::TAX: out << "    cpu.x = cpu.nz(cpu.a);\n"; break;
+    case Operation::TAY: out << "    cpu.y = cpu.nz(cpu.a);\n"; break;
+    case Operation::TSX: out << "    cpu.x = cpu.nz(cpu.stack_pointer);\n"; break;
+    case Operation::TXA: out << "    cpu.a = cpu.nz(cpu.x);\n"; break;
+    case Operation::TYA: out << "    cpu.a = cpu.nz(cpu.y);\n"; break;
+    case Operation::TXS: out << "    cpu.stack_pointer = cpu.x;\n"; break;
+    case Operation::CLC: out << "    cpu.carry = false;\n"; break;
+    case Operation::SEC: out << "    cpu.carry = true;\n"; break;
+    case Operation::CLD: out << "    cpu.decimal = false;\n"; break;
+    case Operation::SED: out << "    cpu.decimal = true;\n"; break;
+    case Operation::CLI: out << "    cpu.interrupt = false;\n"; break;
+    case Operation::SEI: out << "    cpu.interrupt = true;\n"; break;
+    case Operation::CLV: out << "    cpu.overflow = false;\n"; break;
+    case Operation::PHA: out << "    " << push << "cpu.a);\n"; break;
+    case Operation::PHP: out << "    " << push << "cpu.status() | B);\n"
+                             << "    cpu.brk = false;\n"; break;
+    case Operation::PLA: out << "    cpu.a = cpu.nz(cpu.pull());\n"; break;
+    case Operation::PLP: out << "    cpu.setStatus(cpu.pull());\n"; break;
+    case Operation::NOP: break;
+
+    // The ones ending a block
+    case Operation::JMP:
+        out << "    return cpu.leave(state, " << ((entry.addrmode == AddressingMode::IND) ? address : hex16(instruction.operand)) << ");\n";
+        return;
+    case Operation::JSR:
+        {
+            const addressType return_address = static_cast<addressType>(instruction.address + 2);
+
+            out << "    " << push << hex8(return_address >> 8) << ");\n"
+                << "    " << push << hex8(return_address) << ");\n"
+                << "    return cpu.leave(state, " << hex16(instruction.operand) << ");\n";
+        }
+        return;
+    case Operation::RTS:
+        out << "    {\n"
+            << "        const uint16_t low = cpu.pull();\n"
+            << "\n"
+            << "        return cpu.leave(state, static_cast<uint16_t>(((cpu.pull() << 8) | low) + 1));\n"
+            << "    }\n";
+        return;
+    case Operation::RTI:
+        out << "    cpu.setStatus(cpu.pull() & ~B);\n"
+            << "    {\n"
+            << "        const uint16_t low = cpu.pull();\n"
+            << "\n"
+            << "        return cpu.leave(state, static_cast<uint16_t>((cpu.pull() << 8) | low));\n"
+            << "    }\n";
+        return;
+    case Operation::BCC: case Operation::BCS: case Operation::BEQ: case Operation::BMI:
+    case Operation::BNE: case Operation::BPL: case Operation::BVC: case Operation::BVS:
+        {
+            const addressType target = branchTarget(instruction);
+            const bool        crosses_page = (target & 0xFF00) != (nextAddress(instruction) & 0xFF00);
+
+            out << "    if (" << branchCondition(entry.operate) << ")\n"
+                << "    {\n"
+                << "        cpu.cycles += " << (crosses_page ? 2 : 1) << ";\n"
+                << "        return cpu.leave(state, " << hex16(target) << ");\n"
+                << "    }\n"
+                << "    return cpu.leave(state, " << next << ");\n";
+        }
+        return;
+
+    case Operation::BRK:
+    case Operation::XXX:
+        break;
+
+    // Images are decoded as NMOS 6502 code, so the 65C02's never turn up.
+    case Operation::BBR: case Operation::BBS: case Operation::BRA: case Operation::PHX:
+    case Operation::PHY: case Operation::PLX: case Operation::PLY: case Operation::RMB:
+    case Operation::SMB: case Operation::STP: case Operation::STZ: case Operation::TRB:
+    case Operation::TSB: case Operation::WAI:
+        break;
+    }
+
+    const bool writes = checked && ((entry.operate == Operation::STA) || (entry.operate == Operation::STX) ||
+                                    (entry.operate == Operation::STY) || (entry.operate == Operation::INC) ||
+                                    (entry.operate == Operation::DEC) ||
+                                    (((entry.operate == Operation::ASL) || (entry.operate == Operation::LSR) ||
+                                      (entry.operate == Operation::ROL) || (entry.operate == Operation::ROR)) &&
+                                     (entry.addrmode != AddressingMode::IMP)));
+    const bool pushes = stack_checked && ((entry.operate == Operation::PHA) || (entry.operate == Operation::PHP));
+
+    if (last)
+        out << "    return cpu.leave(state, " << next << ");\n";
+    else if (writes || pushes)
+    {
+        // The rest of the block may just have been written over.
+        out << "    if (cpu.stopped())\n"
+            << "        return cpu.leave(state, " << next << ");\n";
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef STATICRECOMPILER_HPP
+#define STATICRECOMPILER_HPP
+
+#include <bitset>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+/** Recompiles a binary image into C++ ahead of time.
+ *
+ *  The code reachable from the entry points is found by following every
+ *  branch, jump and subroutine call, and split into basic blocks.  Each block
+ *  is written out as a C++ function over the registers and the memory array
+ *  (see recompiledcode.hpp), to be built into the program that runs it with a
+ *  RecompiledRunner.
+ *
+ *  Whatever cannot be worked out from the image alone is left to the
+ *  interpreter at run time: the targets of indirect jumps and returns are
+ *  looked up when they are reached, code outside the image is interpreted,
+ *  as are BRK and unofficial opcodes, and blocks whose code gets written to
+ *  are dropped.
+ */
+class StaticRecompiler
+{
+public:
+    using addressType = uint16_t;
+
+    struct Instruction
+    {
+        addressType address;
+        uint8_t     opcode;
+        uint8_t     length;  ///< Including the opcode
+        uint16_t    operand; ///< The operand bytes, with a relative branch already sign extended
+    };
+
+    struct Block
+    {
+        addressType              start;
+        uint16_t                 length; ///< In bytes
+        std::vector<Instruction> instructions;
+    };
+
+    /** Creates a recompiler for an image.
+     *
+     *  @param image        The bytes of the image
+     *  @param load_address Where the image starts in the address space
+     */
+    StaticRecompiler(std::vector<uint8_t> image, addressType load_address);
+
+    /** Adds an address execution can start from.
+     */
+    void addEntryPoint(addressType address);
+
+    /** Adds the addresses in the NMI, reset and IRQ vectors as entry points.
+     *
+     *  Only the vectors the image covers are used.
+     *
+     *  @return The number of vectors found
+     */
+    int addVectorEntryPoints();
+
+    /** Finds the code reachable from the entry points and splits it into blocks.
+     *
+     *  @return The blocks, in order of address
+     */
+    const std::vector<Block> &analyse();
+
+    /** Writes out the blocks as a C++ translation unit.
+     *
+     *  It defines a RecompiledProgram called @p name with external linkage.
+     *
+     *  @param out    Where to write it
+     *  @param name   The name of the RecompiledProgram
+     *  @param source What to say the code was recompiled from
+     */
+    void generate(std::ostream &out, const std::string &name, const std::string &source);
+
+private:
+    std::vector<uint8_t>     _image;
+    addressType              _load_address;
+    std::vector<addressType> _entry_points;
+    std::vector<Block>       _blocks;
+    std::bitset<0x10000>     _code; // The addresses covered by blocks
+    bool                     _analysed = false;
+
+    bool inImage(addressType address, unsigned length) const;
+    uint8_t byteAt(addressType address) const { return _image[static_cast<addressType>(address - _load_address)]; }
+    bool decode(addressType address, Instruction &instruction) const;
+    bool mayWriteCode(addressType first, unsigned count) const;
+
+    void generateBlock(std::ostream &out, const Block &block) const;
+    void generateInstruction(std::ostream &out, const Instruction &instruction, bool last) const;
+};
+
+#endif // STATICRECOMPILER_HPP
@@ -8,42 +8,83 @@
 
 Computer::Computer(QObject *parent) : QObject(parent)
 {
-    // Read signals
-    QObject::connect(&_cpu, &olc6502::readSignal,
-                     &_bus, &Bus::read);
-    QObject::connect(&_bus,    &Bus::busRead,
+    // The copy of the CPU only reads memory, to disassemble it.
+    QObject::connect(&_cpu,    &olc6502::readSignal,
                      &_memory, &RamBusDevice::read);
 
-    // Write signals
-    QObject::connect(&_cpu, &olc6502::writeSignal,
-                     &_bus, &Bus::write);
-    QObject::connect(&_bus,    &Bus::busWritten,
-                     &_memory, &RamBusDevice::write);
-    _clock.setInterval(16);
-    _clock.setSingleShot(false);
-    QObject::connect(&_clock, &QTimer::timeout,
-                     this,    &Computer::timerTimeout);
+    _refresh.setInterval(16);
+    _refresh.setSingleShot(false);
+    QObject::connect(&_refresh, &QTimer::timeout,
+                     this,      &Computer::refreshTimeout);
+    _refresh.start();
     loadProgram();
 }
 
 void Computer::startClock()
 {
-    _clock.start();
+    _emulation.start();
 }
 
 void Computer::stopClock()
 {
-    _clock.stop();
+    _emulation.stop();
 }
 
 void Computer::stepClock()
 {
-    _cpu.clock();
+    _emulation.step();
 }
 
-void Computer::timerTimeout()
+void Computer::stepBackClock()
 {
-    stepClock();
+    _emulation.stepBack();
+}
+
+void Computer::setFrequencyMHz(double frequency)
+{
+    if (frequency > 0.0 && frequency != _frequency_mhz)
+    {
+        _frequency_mhz = frequency;
+        _emulation.setFrequency(frequency * 1000000.0);
+        emit frequencyMHzChanged();
+    }
+}
+
+void Computer::setSpeedMultiplier(double multiplier)
+{
+    if (multiplier > 0.0 && multiplier != _speed_multiplier)
+    {
+        _speed_multiplier = multiplier;
+        _emulation.setSpeedMultiplier(multiplier);
+        emit speedMultiplierChanged();
+    }
+}
+
+void Computer::setTurbo(bool turbo)
+{
+    if (turbo != _turbo)
+    {
+        _turbo = turbo;
+        _emulation.setTurbo(turbo);
+        emit turboChanged();
+    }
+}
+
+void Computer::refreshTimeout()
+{
+    _emulation.readSnapshot([this](const EmulationSnapshot &snapshot)
+                            {
+                                _memory.refresh(snapshot);
+                                _cpu.setRegisters(snapshot.registers);
+
+                                const double effective_mhz = snapshot.effective_frequency / 1000000.0;
+
+                                if (effective_mhz != _effective_mhz)
+                                {
+                                    _effective_mhz = effective_mhz;
+                                    emit effectiveMHzChanged();
+                                }
+                            });
 }
 
 void Computer::loadProgram()
@@ -78,15 +119,15 @@ void Computer::loadProgram()
         std::string b;
 
         ss >> b;
-        _memory.write(nOffset, (uint8_t)std::stoul(b, nullptr, 16));
+        _emulation.poke(nOffset, (uint8_t)std::stoul(b, nullptr, 16));
     }
 
     // Set Reset Vector
-    _memory.write(0xFFFC, 0x00);
-    _memory.write(0xFFFD, 0x80);
+    _emulation.poke(0xFFFC, 0x00);
+    _emulation.poke(0xFFFD, 0x80);
 
     // Reset
-    _cpu.reset();
+    _emulation.reset();
 }
 
 void Computer::RegisterType()
@@ -4,39 +4,80 @@
 #include <QObject>
 #include <QTimer>
 #include "olc6502.hpp"
-#include "bus.hpp"
+#include "emulationthread.hpp"
 #include "rambusdevice.hpp"
 
 
+/** The machine shown by the user interface.
+ *
+ *  The CPU and its memory run on an EmulationThread.  What QML sees through
+ *  @c cpu and @c ram are copies, brought up to date from the latest snapshot
+ *  at the display's refresh rate, so neither side holds up the other.
+ */
 class Computer : public QObject
 {
     Q_OBJECT
 
     Q_PROPERTY(olc6502      *cpu READ cpu CONSTANT FINAL)
     Q_PROPERTY(RamBusDevice *ram READ ram CONSTANT FINAL)
+
+    Q_PROPERTY(double frequencyMHz    READ frequencyMHz    WRITE setFrequencyMHz    NOTIFY frequencyMHzChanged)
+    Q_PROPERTY(double speedMultiplier READ speedMultiplier WRITE setSpeedMultiplier NOTIFY speedMultiplierChanged)
+    Q_PROPERTY(bool   turbo           READ turbo           WRITE setTurbo           NOTIFY turboChanged)
+    Q_PROPERTY(double effectiveMHz    READ effectiveMHz                             NOTIFY effectiveMHzChanged)
 public:
     explicit Computer(QObject *parent = nullptr);
 
     static void RegisterType();
 
+    /** The frequency the CPU is run at, in MHz.
+     *
+     *  @see ClockPacer
+     */
+    double frequencyMHz() const { return _frequency_mhz; }
+    void   setFrequencyMHz(double frequency);
+
+    /** Scales @c frequencyMHz, so 2.0 runs at twice the speed.
+     */
+    double speedMultiplier() const { return _speed_multiplier; }
+    void   setSpeedMultiplier(double multiplier);
+
+    /** Runs the CPU as fast as the host can, ignoring @c frequencyMHz.
+     */
+    bool turbo() const { return _turbo; }
+    void setTurbo(bool turbo);
+
+    /** The frequency the CPU actually ran at lately, in MHz.
+     */
+    double effectiveMHz() const { return _effective_mhz; }
+
 public slots:
     void startClock();
     void stopClock();
     void stepClock();
+    void stepBackClock();
 
     olc6502      *cpu() { return &_cpu; }
     RamBusDevice *ram() { return &_memory; }
 
 signals:
+    void frequencyMHzChanged();
+    void speedMultiplierChanged();
+    void turboChanged();
+    void effectiveMHzChanged();
 
 private slots:
-    void timerTimeout();
+    void refreshTimeout();
 
 private:
-    olc6502 _cpu;
-    Bus     _bus;
-    RamBusDevice _memory;
-    QTimer       _clock;
+    EmulationThread _emulation;
+    olc6502         _cpu;
+    RamBusDevice    _memory;
+    QTimer          _refresh;
+    double          _frequency_mhz    = 1.0;
+    double          _speed_multiplier = 1.0;
+    bool            _turbo            = false;
+    double          _effective_mhz    = 0.0;
 
     void loadProgram();
 
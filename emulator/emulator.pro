@@ -18,10 +18,8 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
-    bus.cpp \
     computer.cpp \
     ibusdevice.cpp \
-    instructionexecutor.cpp \
     olc6502.cpp \
     rambusdevice.cpp \
     rambusdevicedisassemblymodel.cpp \
@@ -29,19 +27,17 @@ SOURCES += \
     rambusdeviceview.cpp
 
 HEADERS += \
-    bus.hpp \
     computer.hpp \
-    flags.hpp \
     ibusdevice.hpp \
-    instructionexecutor.hpp \
-    instructions.hpp \
     olc6502.hpp \
-    opcodes.hpp \
     rambusdevice.hpp \
     rambusdevicedisassemblymodel.hpp \
     rambusdevicetablemodel.hpp \
-    rambusdeviceview.hpp \
-    registers.hpp
+    rambusdeviceview.hpp
+
+# The QObject classes here are adapters over the Qt-free core library.
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
 
 # Default rules for deployment.
 unix {
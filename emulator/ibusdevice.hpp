@@ -2,12 +2,19 @@
 #define IBUSDEVICE_HPP
 
 #include <QObject>
+#include "busdevice.hpp"
 
-class IBusDevice : public QObject
+
+/** The QObject face of a BusDevice, for devices which QML can see.
+ *
+ *  All the decoding is done by BusDevice.  This adds the signals, and
+ *  makes reads and writes available as slots.
+ */
+class IBusDevice : public QObject, public BusDevice
 {
     Q_OBJECT
 public:
-    using addressType = uint16_t;
+    using addressType = BusDevice::addressType;
 
     explicit IBusDevice(addressType lower_address,
                         addressType upper_address,
@@ -16,29 +23,15 @@ public:
                         QObject *parent = nullptr);
     virtual ~IBusDevice() = 0;
 
-    bool writable() const { return _writable; }
-    bool readable() const { return _readable; }
-
-    addressType lowerAddress() const { return _lower_address_range; }
-    addressType upperAddress() const { return _upper_address_range; }
-
-    bool handlesAddress(addressType address) const;
-
 signals:
+    /** Emitted when the pointers returned by @c directReadPage() or
+     *  @c directWritePage() are no longer valid, or may now be available.
+     */
+    void directPagesChanged();
 
 public slots:
-    void    write(addressType address, uint8_t data);
-    uint8_t read(addressType address, bool read_only);
-
-protected:
-    virtual void    writeImplementation(addressType address, uint8_t data) = 0;
-    virtual uint8_t readImplementation(addressType address, bool read_only) = 0;
-
-private:
-    addressType _lower_address_range = 0;
-    addressType _upper_address_range = 0;
-    bool        _writable = false;
-    bool        _readable = false;
+    void    write(addressType address, uint8_t data) { BusDevice::write(address, data); }
+    uint8_t read(addressType address, bool read_only) { return BusDevice::read(address, read_only); }
 };
 
 #endif // IBUSDEVICE_HPP
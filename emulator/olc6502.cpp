@@ -85,33 +85,8 @@ olc6502::olc6502(QObject *parent)
              {
                  return read(address, read_only);
              },
-             [this](InstructionExecutor::addressType address, uint8_t value)
+             [](InstructionExecutor::addressType, uint8_t)
              {
-                 return write(address, value);
-             },
-             [this](InstructionExecutor::registerType new_value)
-             {
-                 emit aChanged(new_value);
-             },
-             [this](InstructionExecutor::registerType new_value)
-             {
-                 emit xChanged(new_value);
-             },
-             [this](InstructionExecutor::registerType new_value)
-             {
-                 emit yChanged(new_value);
-             },
-             [this](InstructionExecutor::addressType new_value)
-             {
-                 emit pcChanged(new_value);
-             },
-             [this](InstructionExecutor::registerType new_value)
-             {
-                 emit stackPointerChanged(new_value);
-             },
-             [this](InstructionExecutor::registerType new_value)
-             {
-                 emit statusChanged(new_value);
              }
            }
 {
@@ -127,59 +102,24 @@ uint8_t olc6502::read(addressType address, bool read_only)
     return emit readSignal(address, read_only);
 }
 
-void olc6502::write(addressType address, uint8_t data)
-{
-    emit writeSignal(address, data);
-}
-
-// Forces the 6502 into a known state. This is hard-wired inside the CPU. The
-// registers are set to 0x00, the status register is cleared except for unused
-// bit which remains at 1. An absolute address is read from location 0xFFFC
-// which contains a second address that the program counter is set to. This
-// allows the programmer to jump to a known and programmable location in the
-// memory to start executing from. Typically the programmer would set the value
-// at location 0xFFFC at compile time.
-void olc6502::reset()
-{
-    _executor.reset();
-}
-
-// Interrupt requests are a complex operation and only happen if the
-// "disable interrupt" flag is 0. IRQs can happen at any time, but
-// you dont want them to be destructive to the operation of the running
-// program. Therefore the current instruction is allowed to finish
-// (which I facilitate by doing the whole thing when cycles == 0) and
-// then the current program counter is stored on the stack. Then the
-// current status register is stored on the stack. When the routine
-// that services the interrupt has finished, the status register
-// and program counter can be restored to how they where before it
-// occurred. This is impemented by the "RTI" instruction. Once the IRQ
-// has happened, in a similar way to a reset, a programmable address
-// is read form hard coded location 0xFFFE, which is subsequently
-// set to the program counter.
-void olc6502::irq()
-{
-    _executor.irq();
-}
-
-
-// A Non-Maskable Interrupt cannot be ignored. It behaves in exactly the
-// same way as a regular IRQ, but reads the new program counter address
-// form location 0xFFFA.
-void olc6502::nmi()
-{
-    _executor.nmi();
-}
-
-// Perform one clock cycles worth of emulation
-void olc6502::clock()
-{
-    _executor.clock();
-}
-
-bool olc6502::complete() const
+void olc6502::setRegisters(const Registers &registers)
 {
-    return _executor.complete();
+    const Registers previous = _registers;
+
+    _registers = registers;
+
+    if (registers.program_counter != previous.program_counter)
+        emit pcChanged(registers.program_counter);
+    if (registers.status != previous.status)
+        emit statusChanged(registers.status);
+    if (registers.stack_pointer != previous.stack_pointer)
+        emit stackPointerChanged(registers.stack_pointer);
+    if (registers.a != previous.a)
+        emit aChanged(registers.a);
+    if (registers.x != previous.x)
+        emit xChanged(registers.x);
+    if (registers.y != previous.y)
+        emit yChanged(registers.y);
 }
 
 void olc6502::setLog(bool value)
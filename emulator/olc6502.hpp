@@ -85,6 +85,13 @@
 #include "instructionexecutor.hpp"
 
 
+/** What the user interface shows of the CPU.
+ *
+ *  The CPU itself runs on an EmulationThread; this only holds the registers
+ *  of its latest snapshot, and disassembles memory read through
+ *  @c readSignal().  Anything that changes the machine is a command to the
+ *  EmulationThread.
+ */
 class olc6502 : public QObject
 {
     Q_OBJECT
@@ -107,16 +114,6 @@ public:
 
     static void RegisterType();
 
-    void reset();
-
-    void irq();
-    void nmi();
-
-    // Indicates the current instruction has completed by returning true. This is
-    // a utility function to enable "step-by-step" execution, without manually
-    // clocking every cycle
-    bool complete() const;
-
     uint8_t a() const { return _registers.a; }
     uint8_t x() const { return _registers.x; }
     uint8_t y() const { return _registers.y; }
@@ -126,23 +123,24 @@ public:
     uint8_t  status() const { return _registers.status; }
 
     const Registers &registers() const { return _registers; }
-          Registers &registers()       { return _registers; }
 
-    uint32_t clockTicks() const { return _executor.clock_ticks; }
+    /** Shows registers from the CPU running on the EmulationThread.
+     *
+     *  A change signal is emitted for each register which differs.
+     *
+     *  @see EmulationThread
+     */
+    void setRegisters(const Registers &registers);
 
     bool log() const { return _log; }
     void setLog(bool value);
 
     auto disassemble(addressType start, addressType stop) -> disassemblyType;
 public slots:
-    void clock(); ///< Executes one clock tick
-
     uint8_t read(addressType address, bool read_only = false);
-    void    write(addressType address, uint8_t data);
 
 signals:
     uint8_t readSignal(addressType address, bool read_only);
-    void    writeSignal(addressType address, uint8_t data);
 
     void aChanged(uint8_t new_value);
     void xChanged(uint8_t new_value);
@@ -154,9 +152,8 @@ signals:
     void logChanged();
 
 private:
-    // Assisstive variables to facilitate emulation
     Registers _registers;
-    InstructionExecutor _executor;
+    InstructionExecutor _executor; ///< Only used to disassemble
     bool     _log = false;
 
     // These only exist to get around the QML type system.  It only really knows about
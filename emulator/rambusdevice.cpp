@@ -25,7 +25,6 @@ void RamBusDevice::RegisterType()
 void RamBusDevice::writeImplementation(uint16_t address, uint8_t data)
 {
     _data[address] = data;
-    emit memoryChanged(address, data);
 }
 
 uint8_t RamBusDevice::readImplementation(uint16_t address, bool read_only)
@@ -34,3 +33,31 @@ uint8_t RamBusDevice::readImplementation(uint16_t address, bool read_only)
 
     return _data[address];
 }
+
+const uint8_t *RamBusDevice::directReadPage(addressType page_address) const
+{
+    return _data.data() + (page_address & 0xFF00);
+}
+
+uint8_t *RamBusDevice::directWritePage(addressType page_address)
+{
+    return _data.data() + (page_address & 0xFF00);
+}
+
+void RamBusDevice::refresh(const EmulationSnapshot &snapshot)
+{
+    const size_t page_size = 0x100;
+
+    for (size_t page = 0; page < snapshot.dirty_pages.size(); ++page)
+    {
+        if (snapshot.dirty_pages.test(page))
+        {
+            std::copy_n(std::begin(snapshot.memory) + page * page_size,
+                        page_size,
+                        std::begin(_data) + page * page_size);
+        }
+    }
+    _refreshed_pages = snapshot.dirty_pages;
+    if (_refreshed_pages.any())
+        emit memoryRefreshed();
+}
@@ -2,11 +2,15 @@
 #define RAMBUSDEVICE_HPP
 
 #include "ibusdevice.hpp"
+#include "emulationthread.hpp"
 #include <array>
 
 
 /** Represents a contiguous block of RAM.
  *
+ *  It also serves as the user interface's copy of the memory of an
+ *  EmulationThread, which is brought up to date a page at a time by
+ *  @c refresh().
  */
 class RamBusDevice : public IBusDevice
 {
@@ -28,28 +32,44 @@ public:
     */
    const memory_type &memory() const { return _data; }
 
+   /** Gives the CPU direct access to the memory.
+    *
+    *  @see BusDevice::directReadPage
+    */
+   ///@{
+   const uint8_t *directReadPage(addressType page_address) const override;
+         uint8_t *directWritePage(addressType page_address) override;
+   ///@}
+
+   /** Copies the pages of memory which changed into this one.
+    *
+    *  @param snapshot The latest snapshot of the emulation
+    */
+   void refresh(const EmulationSnapshot &snapshot);
+
+   /** The pages which changed in the last @c refresh().
+    */
+   const EmulationSnapshot::pagesType &refreshedPages() const { return _refreshed_pages; }
+
 public slots:
 
 signals:
-    /** A signal representing what data was just written.
-     *
-     *  This is a pass-through of the @c write() method.
-     *  It's main purpose is to allow for another entity
-     *  to know when the underlying memory has changed.
+    /** Emitted once by @c refresh(), however many pages changed.
      *
-     *  @param address The address to write to
-     *  @param data    The byte of data to write
+     *  This replaces hearing about every write, which can't keep up with
+     *  a CPU running on another thread.
      *
-     *  @see write
+     *  @see refreshedPages
      */
-    void memoryChanged(addressType address, uint8_t data);
+    void memoryRefreshed();
 
 protected:
     void    writeImplementation(addressType address, uint8_t data) override;
     uint8_t readImplementation(addressType address, bool read_only) override;
 
 private:
-    memory_type _data;
+    memory_type                  _data;
+    EmulationSnapshot::pagesType _refreshed_pages;
 };
 
 #endif // RAMBUSDEVICE_HPP
@@ -1,5 +1,6 @@
 #include "rambusdevicedisassemblymodel.hpp"
 #include <QtQml>
+#include <algorithm>
 
 
 RamBusDeviceDisassemblyModel::RamBusDeviceDisassemblyModel(QObject *parent)
@@ -22,16 +23,15 @@ void RamBusDeviceDisassemblyModel::setMemoryModel(RamBusDevice *new_model)
     {
         if (_memory_model)
         {
-//            _memory_model->disconnect(_memory_model, &RamBusDevice::memoryChanged,
-//                                      this,          &RamBusDeviceDisassemblyModel::onMemoryChanged);
+            _memory_model->disconnect(_memory_model, &RamBusDevice::memoryRefreshed,
+                                      this,          &RamBusDeviceDisassemblyModel::onMemoryRefreshed);
         }
         _memory_model = new_model;
 
         if (new_model)
         {
-//               new_model->connect(new_model, &RamBusDevice::memoryChanged,
-//                                  this,      &RamBusDeviceDisassemblyModel::onMemoryChanged);
-
+            new_model->connect(new_model, &RamBusDevice::memoryRefreshed,
+                               this,      &RamBusDeviceDisassemblyModel::onMemoryRefreshed);
         }
         emit memoryModelChanged();
 
@@ -110,6 +110,48 @@ void RamBusDeviceDisassemblyModel::onCpuProgramCounterChanged(uint16_t address)
     calculateVisibleDisassembly();
 }
 
+void RamBusDeviceDisassemblyModel::onMemoryRefreshed()
+{
+    if (!(startAddress() < endAddress()) || !memoryModel() || !cpuModel())
+        return;
+
+    const auto &pages = memoryModel()->refreshedPages();
+
+    for (size_t first = 0; first < pages.size(); ++first)
+    {
+        if (!pages.test(first))
+            continue;
+
+        size_t last = first;
+
+        while ((last + 1 < pages.size()) && pages.test(last + 1))
+            ++last;
+
+        int start = std::max<int>(static_cast<int>(first << 8), memoryModel()->lowerAddress());
+        int stop  = std::min<int>(static_cast<int>((last << 8) | 0xFF), memoryModel()->upperAddress());
+
+        // Start from the instruction which runs into the first page, so
+        // the new lines stay in step with the ones before them.
+        auto line = _cpu_disassembly.lower_bound(static_cast<olc6502::addressType>(start));
+
+        if (line != std::begin(_cpu_disassembly))
+            start = (--line)->first;
+
+        if (start <= stop)
+        {
+            _cpu_disassembly.erase(_cpu_disassembly.lower_bound(static_cast<olc6502::addressType>(start)),
+                                   _cpu_disassembly.upper_bound(static_cast<olc6502::addressType>(stop)));
+
+            auto lines = cpuModel()->disassemble(static_cast<olc6502::addressType>(start),
+                                                 static_cast<olc6502::addressType>(stop));
+
+            _cpu_disassembly.insert(std::begin(lines), std::end(lines));
+        }
+        first = last;
+    }
+    calculateVisibleDisassembly();
+}
+
 void RamBusDeviceDisassemblyModel::retrieveDisassembly()
 {
     if (memoryModel() && cpuModel())
@@ -102,6 +102,10 @@ public slots:
 private slots:
     void onCpuProgramCounterChanged(uint16_t address);
 
+    /** Disassembles again just the pages of memory which changed.
+     */
+    void onMemoryRefreshed();
+
 private:
     RamBusDevice             *_memory_model = nullptr;
     olc6502                  *_cpu_model = nullptr;
@@ -104,34 +104,28 @@ void RamBusDeviceTableModel::setMemoryModel(RamBusDevice *new_model)
         // Disconnect old model if we had one
         if (_model)
         {
-            _model->disconnect(_model, &RamBusDevice::memoryChanged,
-                               this,   &RamBusDeviceTableModel::onMemoryChanged);
+            _model->disconnect(_model, &RamBusDevice::memoryRefreshed,
+                               this,   &RamBusDeviceTableModel::onMemoryRefreshed);
         }
         _model = new_model;
 
         // Connect new model... if we have one
         if (new_model)
         {
-            new_model->connect(new_model, &RamBusDevice::memoryChanged,
-                               this,      &RamBusDeviceTableModel::onMemoryChanged);
+            new_model->connect(new_model, &RamBusDevice::memoryRefreshed,
+                               this,      &RamBusDeviceTableModel::onMemoryRefreshed);
         }
         fill();
         emit memoryModelChanged();
     }
 }
 
-void RamBusDeviceTableModel::onMemoryChanged(RamBusDevice::addressType address, uint8_t value)
+void RamBusDeviceTableModel::onMemoryRefreshed()
 {
-    Q_UNUSED(address)
-    Q_UNUSED(value)
-
-    if (memoryModel() && isDisplayableAddress(address))
+    if (memoryModel() && memoryModel()->refreshedPages().test(static_cast<size_t>(page() & 0xFF)))
     {
-        auto        address_index = addressToIndex(address);
-        QModelIndex model_index   = index(std::get<0>(address_index), std::get<1>(address_index));
-
-        // Change ONLY the address that changed
-        emit dataChanged(model_index, model_index, { MemoryRole });
+        // Refresh the whole page at once, however many bytes of it changed
+        emit dataChanged(index(0, 0), index(lines_high - 1, cells_wide - 1), { MemoryRole });
     }
 }
 
@@ -171,18 +165,3 @@ void RamBusDeviceTableModel::fill()
         return;
     emit dataChanged(index(0, 0), index(lines_high, cells_wide)); // Include headers
 }
-
-bool RamBusDeviceTableModel::isDisplayableAddress(uint16_t address) const
-{
-    uint16_t lower_limit = static_cast<uint16_t>(page() << 8);
-    uint16_t upper_limit = lower_limit + 255;
-
-    return (address >= lower_limit) && (address <= upper_limit);
-}
-
-std::tuple<int, int> RamBusDeviceTableModel::addressToIndex(uint16_t address) const
-{
-    Q_ASSERT(isDisplayableAddress(address));
-
-    return std::make_tuple( (address >> 8) - (static_cast<uint16_t>(page()) ), address & 0x00FF);
-}
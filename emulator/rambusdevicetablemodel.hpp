@@ -4,7 +4,6 @@
 #include <QAbstractTableModel>
 #include <QString>
 #include "rambusdevice.hpp"
-#include <tuple>
 
 
 class RamBusDeviceTableModel : public QAbstractTableModel
@@ -88,12 +87,11 @@ private:
     static constexpr int lines_high = 16;
 
 private slots:
-    /** Catched the memoryChanged signal from @c RamBusDevice
+    /** Catches the memoryRefreshed signal from @c RamBusDevice
      *
-     *  @param address The address that was changed
-     *  @param value   The value it was changed to
+     *  The rows are only refreshed when the page being viewed changed.
      */
-    void onMemoryChanged(RamBusDevice::addressType address, uint8_t value);
+    void onMemoryRefreshed();
 
 private:
     /** Converts a view's row number to an address within the underlying model.
@@ -114,17 +112,6 @@ private:
      */
     uint16_t indexToAddress(const QModelIndex &index) const;
 
-    /** Converts an address into components used for retrieving data to display.
-     *
-     *  @param address
-     *  @return A tuple, where tuple<0> is the address to display
-     *          in the view, and tuple<1> is the byte number
-     *          within the page.
-     *
-     *  @pre isDisplayableAddress(address) == true
-     */
-    std::tuple<int, int> addressToIndex(uint16_t address) const;
-
     /** Generates the text to display for the Address role.
      *
      *  @param address The memory address
@@ -140,7 +127,6 @@ private:
     QString  generateMemoryLine(uint16_t address) const;
 
     void     fill();
-    bool     isDisplayableAddress(uint16_t address) const;
 };
 
 #endif // RAMBUSDEVICETABLEMODEL_HPP
@@ -88,15 +88,15 @@ void RamBusDeviceView::setModel(RamBusDevice *new_model)
     {
         if (_model)
         {
-            _model->disconnect(_model, &RamBusDevice::memoryChanged,
-                               this,   &RamBusDeviceView::onMemoryChanged);
+            _model->disconnect(_model, &RamBusDevice::memoryRefreshed,
+                               this,   &RamBusDeviceView::onMemoryRefreshed);
         }
         _model = new_model;
 
         if (new_model)
         {
-            new_model->connect(new_model, &RamBusDevice::memoryChanged,
-                               this,      &RamBusDeviceView::onMemoryChanged);
+            new_model->connect(new_model, &RamBusDevice::memoryRefreshed,
+                               this,      &RamBusDeviceView::onMemoryRefreshed);
 
             // Let's go ahead and fill in the content to display...
             _content = generatePageOfText(model()->memory(), page());
@@ -114,10 +114,10 @@ void RamBusDeviceView::setPage(int new_page)
     }
 }
 
-void RamBusDeviceView::onMemoryChanged(RamBusDevice::addressType address, uint8_t value)
+void RamBusDeviceView::onMemoryRefreshed()
 {
-    Q_UNUSED(address);
-    Q_UNUSED(value);
+    if (!model()->refreshedPages().test(static_cast<size_t>(page() & 0xFF)))
+        return;
 
     _content = generatePageOfText(model()->memory(), page());
     QQuickPaintedItem::update();
@@ -72,12 +72,11 @@ private:
     QString       _content;
 
 private slots:
-    /** Catched the memoryChanged signal from @c RamBusDevice
+    /** Catches the memoryRefreshed signal from @c RamBusDevice
      *
-     *  @param address The address that was changed
-     *  @param value   The value it was changed to
+     *  The text is only regenerated when the page being viewed changed.
      */
-    void onMemoryChanged(RamBusDevice::addressType address, uint8_t value);
+    void onMemoryRefreshed();
 };
 
 #endif // RAMBUSDEVICEVIEW_HPP
@@ -1,6 +1,14 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    core \
     emulator \
     app \
+    tools \
     unit_tests
+
+# Static libraries must be built before whatever links them.
+emulator.depends = core
+app.depends = core emulator
+tools.depends = core
+unit_tests.depends = core emulator
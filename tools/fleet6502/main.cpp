@@ -0,0 +1,200 @@
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "fleetrunner.hpp"
+
+// Runs a batch of jobs across all cores, printing how each one ended up.
+//
+// usage: fleet6502 [--threads COUNT] JOBS
+//
+// JOBS has one job per line, and # starts a comment:
+//
+//     IMAGE LOAD_ADDRESS ENTRY_POINT CYCLES [INPUT_ADDRESS INPUT_BYTES]
+//
+// Addresses and input bytes are in hexadecimal, the input bytes written as
+// one run of digits, and the cycle budget is in decimal. Each job prints a
+// line with its registers, cycles, instructions, why it stopped and a digest
+// of its memory, in the order the jobs were given.
+
+namespace
+{
+int usage()
+{
+    std::cerr << "usage: fleet6502 [--threads COUNT] JOBS\n";
+    return EXIT_FAILURE;
+}
+
+bool parseNumber(const std::string &text, int base, unsigned long long maximum, unsigned long long &value)
+{
+    char *end = nullptr;
+
+    value = std::strtoull(text.c_str(), &end, base);
+    return !text.empty() && !*end && (value <= maximum);
+}
+
+bool parseAddress(const std::string &text, uint16_t &address)
+{
+    unsigned long long value;
+
+    if (!parseNumber(text, 16, 0xFFFF, value))
+        return false;
+    address = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool parseBytes(const std::string &text, std::vector<uint8_t> &bytes)
+{
+    if (text.size() % 2)
+        return false;
+    for (size_t index = 0; index < text.size(); index += 2)
+    {
+        unsigned long long value;
+
+        if (!parseNumber(text.substr(index, 2), 16, 0xFF, value))
+            return false;
+        bytes.push_back(static_cast<uint8_t>(value));
+    }
+    return true;
+}
+
+const char *nameOf(InstructionExecutor::StopReason reason)
+{
+    switch (reason)
+    {
+    case InstructionExecutor::StopReason::BudgetSpent:   return "budget";
+    case InstructionExecutor::StopReason::Breakpoint:    return "breakpoint";
+    case InstructionExecutor::StopReason::Break:         return "brk";
+    case InstructionExecutor::StopReason::IllegalOpcode: return "illegal";
+    case InstructionExecutor::StopReason::Condition:     return "condition";
+    }
+    return "?";
+}
+
+// Jobs running the same image share one copy of it
+class ImageCache
+{
+public:
+    FleetJob::imageType load(const std::string &path)
+    {
+        auto found = _images.find(path);
+
+        if (found != _images.end())
+            return found->second;
+
+        std::ifstream input(path, std::ios::binary);
+
+        if (!input)
+            return nullptr;
+
+        auto image = std::make_shared<const std::vector<uint8_t>>(std::istreambuf_iterator<char>(input),
+                                                                  std::istreambuf_iterator<char>());
+
+        _images[path] = image;
+        return image;
+    }
+
+private:
+    std::map<std::string, FleetJob::imageType> _images;
+};
+
+bool parseJob(const std::string &line, ImageCache &images, FleetJob &job, std::string &error)
+{
+    std::istringstream       fields(line);
+    std::vector<std::string> field { std::istream_iterator<std::string>(fields), std::istream_iterator<std::string>() };
+    unsigned long long       cycles;
+
+    if (((field.size() != 4) && (field.size() != 6)) ||
+        !parseAddress(field[1], job.load_address) ||
+        !parseAddress(field[2], job.entry_point) ||
+        !parseNumber(field[3], 10, UINT64_MAX, cycles) ||
+        ((field.size() == 6) && (!parseAddress(field[4], job.input_address) || !parseBytes(field[5], job.input))))
+    {
+        error = "expected IMAGE LOAD_ADDRESS ENTRY_POINT CYCLES [INPUT_ADDRESS INPUT_BYTES]";
+        return false;
+    }
+    job.cycle_budget = cycles;
+    job.image = images.load(field[0]);
+    if (!job.image)
+    {
+        error = "cannot read " + field[0];
+        return false;
+    }
+    return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned                 threads = 0;
+    std::vector<std::string> arguments;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string argument = argv[index];
+
+        if ((argument == "--threads") && (index + 1 < argc))
+        {
+            unsigned long long value;
+
+            if (!parseNumber(argv[++index], 10, 1024, value))
+                return usage();
+            threads = static_cast<unsigned>(value);
+        }
+        else
+            arguments.push_back(argument);
+    }
+    if (arguments.size() != 1)
+        return usage();
+
+    std::ifstream jobs_file(arguments[0]);
+
+    if (!jobs_file)
+    {
+        std::cerr << "fleet6502: cannot read " << arguments[0] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    ImageCache            images;
+    std::vector<FleetJob> jobs;
+    std::string           line;
+
+    for (unsigned line_number = 1; std::getline(jobs_file, line); ++line_number)
+    {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        FleetJob    job;
+        std::string error;
+
+        if (!parseJob(line, images, job, error))
+        {
+            std::cerr << "fleet6502: " << arguments[0] << ":" << line_number << ": " << error << "\n";
+            return EXIT_FAILURE;
+        }
+        jobs.push_back(job);
+    }
+
+    const FleetRunner runner(threads);
+    const auto        results = runner.run(jobs);
+
+    for (size_t index = 0; index < results.size(); ++index)
+    {
+        const FleetResult &result = results[index];
+
+        std::printf("%zu A:%02X X:%02X Y:%02X SP:%02X PC:%04X P:%02X cycles:%llu instructions:%llu %s %016llX\n",
+                    index, result.registers.a, result.registers.x, result.registers.y,
+                    result.registers.stack_pointer, result.registers.program_counter, result.registers.status,
+                    static_cast<unsigned long long>(result.cycles),
+                    static_cast<unsigned long long>(result.instructions),
+                    nameOf(result.reason),
+                    static_cast<unsigned long long>(result.memory_digest));
+    }
+    return EXIT_SUCCESS;
+}
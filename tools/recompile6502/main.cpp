@@ -0,0 +1,118 @@
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "staticrecompiler.hpp"
+
+// Recompiles a binary image into a C++ translation unit, to be built into
+// a program running it with a RecompiledRunner.
+//
+// usage: recompile6502 [--name NAME] [--entry ADDRESS]... IMAGE LOAD_ADDRESS OUTPUT
+//
+// Execution is followed from whichever of the NMI, reset and IRQ vectors the
+// image covers, and from each --entry given. Addresses are in hexadecimal.
+
+namespace
+{
+int usage()
+{
+    std::cerr << "usage: recompile6502 [--name NAME] [--entry ADDRESS]... IMAGE LOAD_ADDRESS OUTPUT\n";
+    return EXIT_FAILURE;
+}
+
+bool parseAddress(std::string text, uint16_t &address)
+{
+    if (!text.empty() && (text[0] == '$'))
+        text.erase(0, 1);
+
+    char *end = nullptr;
+    unsigned long value = std::strtoul(text.c_str(), &end, 16);
+
+    if (text.empty() || *end || (value > 0xFFFF))
+        return false;
+    address = static_cast<uint16_t>(value);
+    return true;
+}
+
+// Makes a C++ identifier out of the image's file name
+std::string nameFor(const std::string &path)
+{
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+
+    name = name.substr(0, name.find('.'));
+    for (char &character : name)
+    {
+        if (!std::isalnum(static_cast<unsigned char>(character)))
+            character = '_';
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+        name.insert(0, "program_");
+    return name;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    std::string              name;
+    std::vector<uint16_t>    entry_points;
+    std::vector<std::string> arguments;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        const std::string argument = argv[index];
+
+        if ((argument == "--name") && (index + 1 < argc))
+            name = argv[++index];
+        else if ((argument == "--entry") && (index + 1 < argc))
+        {
+            uint16_t address;
+
+            if (!parseAddress(argv[++index], address))
+                return usage();
+            entry_points.push_back(address);
+        }
+        else
+            arguments.push_back(argument);
+    }
+
+    uint16_t load_address;
+
+    if ((arguments.size() != 3) || !parseAddress(arguments[1], load_address))
+        return usage();
+
+    std::ifstream input(arguments[0], std::ios::binary);
+
+    if (!input)
+    {
+        std::cerr << "recompile6502: cannot read " << arguments[0] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    StaticRecompiler recompiler(std::vector<uint8_t>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()),
+                                load_address);
+
+    for (uint16_t address : entry_points)
+        recompiler.addEntryPoint(address);
+    if ((recompiler.addVectorEntryPoints() == 0) && entry_points.empty())
+    {
+        std::cerr << "recompile6502: the image has no vectors, so give at least one --entry\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ofstream output(arguments[2]);
+
+    if (name.empty())
+        name = nameFor(arguments[0]);
+    recompiler.generate(output, name, arguments[0].substr(arguments[0].find_last_of("/\\") + 1));
+    if (!output)
+    {
+        std::cerr << "recompile6502: cannot write " << arguments[2] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "recompile6502: " << recompiler.analyse().size() << " blocks written to " << arguments[2] << "\n";
+    return EXIT_SUCCESS;
+}
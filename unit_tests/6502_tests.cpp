@@ -1,5 +1,6 @@
 #include <gmock/gmock.h>
-#include "olc6502.hpp"
+#include "instructionexecutor.hpp"
+#include <array>
 
 using namespace testing;
 
@@ -38,9 +39,31 @@ bool Negative(uint8_t status_value)
     return status_value & FLAGS6502::N;
 }
 
+/** The CPU as the emulation thread runs it, with 64 KB of RAM.
+ */
+struct Cpu
+{
+    Registers                       registers;
+    std::array<uint8_t, 0x10000>    memory{};
+    InstructionExecutor             executor{ registers,
+                                              [this](uint16_t address, bool) { return memory[address]; },
+                                              [this](uint16_t address, uint8_t value) { memory[address] = value; } };
+
+    void reset() { executor.reset(); }
+    void clock() { executor.clock(); }
+    bool complete() const { return executor.complete(); }
+    uint64_t clockTicks() const { return executor.clock_ticks; }
+
+    uint8_t a() const { return registers.a; }
+    uint8_t x() const { return registers.x; }
+    uint8_t y() const { return registers.y; }
+    uint8_t stackPointer() const { return registers.stack_pointer; }
+    uint8_t status() const { return registers.status; }
+};
+
 TEST(CPU, ResetSetsProcessorToKnownState)
 {
-    olc6502 cpu;
+    Cpu cpu;
 
     cpu.reset();
 
@@ -66,7 +89,7 @@ TEST(CPU, ResetSetsProcessorToKnownState)
 
 TEST(CPU, ClockTickIncrementsClockCount)
 {
-    olc6502 cpu;
+    Cpu cpu;
 
     cpu.reset();
 
@@ -79,7 +102,7 @@ TEST(CPU, ClockTickIncrementsClockCount)
 
 TEST(CPU, ResetTakesDeterminateNumberOfCycles)
 {
-    olc6502 cpu;
+    Cpu cpu;
 
     cpu.reset();
 
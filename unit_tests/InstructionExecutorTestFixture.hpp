@@ -81,12 +81,7 @@ public:
     InstructionExecutor executor{ r,
                                   std::bind(&InstructionExecutorTestFixture::addressBusReadSignaled,        this, _1, _2),
                                   std::bind(&InstructionExecutorTestFixture::addressBusWriteSignaled,       this, _1, _2),
-                                  std::bind(&InstructionExecutorTestFixture::accumulatorChangedSignaled,    this, _1),
-                                  std::bind(&InstructionExecutorTestFixture::xChangedSignaled,              this, _1),
-                                  std::bind(&InstructionExecutorTestFixture::yChangedSignaled,              this, _1),
-                                  std::bind(&InstructionExecutorTestFixture::programCounterChangedSignaled, this, _1),
-                                  std::bind(&InstructionExecutorTestFixture::stackPointerChangedSignaled,   this, _1),
-                                  std::bind(&InstructionExecutorTestFixture::statusChangedSignaled,         this, _1)
+                                  std::bind(&InstructionExecutorTestFixture::registersChangedSignaled,      this, _1, _2)
                                 };
 
     // Here is where we store the results of the signals.
@@ -135,34 +130,20 @@ protected:
         writeSignalsCaught.emplace_back(address, data);
     }
 
-    void accumulatorChangedSignaled(registerType value)
-    {
-        accumulatorChangedSignalsCaught.emplace_back(value);
-    }
-
-    void xChangedSignaled(registerType value)
-    {
-        xChangedSignalsCaught.emplace_back(value);
-    }
-
-    void yChangedSignaled(registerType value)
-    {
-        yChangedSignalsCaught.emplace_back(value);
-    }
-
-    void programCounterChangedSignaled(addressType address)
-    {
-        programCounterChangedSignalsCaught.emplace_back(address);
-    }
-
-    void stackPointerChangedSignaled(registerType value)
-    {
-        stackPointerChangedSignalsCaught.emplace_back(value);
-    }
-
-    void statusChangedSignaled(registerType value)
-    {
-        statusChangedSignalsCaught.emplace_back(value);
+    void registersChangedSignaled(const Registers &registers, uint8_t changed)
+    {
+        if (changed & REG_A)
+            accumulatorChangedSignalsCaught.emplace_back(registers.a);
+        if (changed & REG_X)
+            xChangedSignalsCaught.emplace_back(registers.x);
+        if (changed & REG_Y)
+            yChangedSignalsCaught.emplace_back(registers.y);
+        if (changed & REG_PC)
+            programCounterChangedSignalsCaught.emplace_back(registers.program_counter);
+        if (changed & REG_STKP)
+            stackPointerChangedSignalsCaught.emplace_back(registers.stack_pointer);
+        if (changed & REG_STATUS)
+            statusChangedSignalsCaught.emplace_back(registers.status);
     }
 };
 
@@ -0,0 +1,166 @@
+#include <gmock/gmock.h>
+#include "batchexecutor.hpp"
+#include <algorithm>
+#include <array>
+
+using namespace testing;
+
+namespace
+{
+const std::vector<uint8_t> batch_test_program =
+{
+    0xA2, 0xFF,             // $0400  LDX #$FF
+    0x9A,                   // $0402  TXS
+    0xA0, 0x00,             // $0403  LDY #$00
+    0xA5, 0x00,             // $0405  LDA $00
+    0x18,                   // $0407  CLC
+    0x79, 0xF0, 0x02,       // $0408  ADC $02F0,Y
+    0x0A,                   // $040B  ASL A
+    0x49, 0x5A,             // $040C  EOR #$5A
+    0x38,                   // $040E  SEC
+    0xE9, 0x03,             // $040F  SBC #$03
+    0x2A,                   // $0411  ROL A
+    0x85, 0x00,             // $0412  STA $00
+    0xC9, 0x80,             // $0414  CMP #$80
+    0xB0, 0x03,             // $0416  BCS $041B    Where the lanes part ways
+    0x20, 0x30, 0x04,       // $0418  JSR $0430
+    0x91, 0x10,             // $041B  STA ($10),Y
+    0xC8,                   // $041D  INY
+    0xC0, 0x40,             // $041E  CPY #$40
+    0xD0, 0xE3,             // $0420  BNE $0405
+    0x4A,                   // $0422  LSR A
+    0x6A,                   // $0423  ROR A
+    0xA8,                   // $0424  TAY
+    0xCA,                   // $0425  DEX
+    0xE0, 0x03,             // $0426  CPX #$03
+    0xBA,                   // $0428  TSX
+    0xB8,                   // $0429  CLV
+    0x00,                   // $042A  BRK
+    0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE6, 0x01,             // $0430  INC $01
+    0xA6, 0x01,             // $0432  LDX $01
+    0x8A,                   // $0434  TXA
+    0x60                    // $0435  RTS
+};
+
+// Loads the program, with its input at $00, a table at $02F0 and a pointer
+// to $0500 at $10
+void setUpMemory(uint8_t *memory, uint8_t input)
+{
+    std::copy(batch_test_program.begin(), batch_test_program.end(), memory + 0x0400);
+    memory[0x00] = input;
+    memory[0x10] = 0x00;
+    memory[0x11] = 0x05;
+    for (int index = 0; index < 0x40; ++index)
+        memory[0x02F0 + index] = static_cast<uint8_t>(index * 13);
+}
+
+struct Interpreted
+{
+    std::array<uint8_t, 0x10000>   memory {};
+    Registers                      registers;
+    InstructionExecutor::RunResult result;
+};
+
+// Runs whole instructions until at least cycle_budget cycles have gone, as a BatchExecutor does
+Interpreted interpret(uint8_t input, uint64_t cycle_budget)
+{
+    Interpreted interpreted;
+
+    setUpMemory(interpreted.memory.data(), input);
+    interpreted.registers.program_counter = 0x0400;
+
+    InstructionExecutor executor(interpreted.registers,
+                                 [&](uint16_t address, bool) { return interpreted.memory[address]; },
+                                 [&](uint16_t address, uint8_t data) { interpreted.memory[address] = data; });
+
+    interpreted.result = executor.runCycles(cycle_budget);
+    if (!executor.complete())
+        interpreted.result.cycles += executor.runCycles(executor.remainingCyclesForInstruction()).cycles;
+    return interpreted;
+}
+
+void setUpBatch(BatchExecutor &batch, uint8_t (*input)(size_t lane))
+{
+    Registers registers;
+
+    registers.program_counter = 0x0400;
+    for (size_t lane = 0; lane < batch.lanes(); ++lane)
+    {
+        setUpMemory(batch.memory(lane), input(lane));
+        batch.setRegisters(lane, registers);
+    }
+}
+
+void expectLaneMatches(BatchExecutor &batch, size_t lane, const Interpreted &expected)
+{
+    const Registers registers = batch.registers(lane);
+
+    EXPECT_THAT(batch.result(lane).reason, Eq(expected.result.reason)) << "lane " << lane;
+    EXPECT_THAT(batch.result(lane).cycles, Eq(expected.result.cycles)) << "lane " << lane;
+    EXPECT_THAT(batch.result(lane).instructions, Eq(expected.result.instructions)) << "lane " << lane;
+    EXPECT_THAT(registers.a, Eq(expected.registers.a)) << "lane " << lane;
+    EXPECT_THAT(registers.x, Eq(expected.registers.x)) << "lane " << lane;
+    EXPECT_THAT(registers.y, Eq(expected.registers.y)) << "lane " << lane;
+    EXPECT_THAT(registers.stack_pointer, Eq(expected.registers.stack_pointer)) << "lane " << lane;
+    EXPECT_THAT(registers.program_counter, Eq(expected.registers.program_counter)) << "lane " << lane;
+    EXPECT_THAT(registers.status, Eq(expected.registers.status)) << "lane " << lane;
+    EXPECT_THAT(std::equal(expected.memory.begin(), expected.memory.end(), batch.memory(lane)), Eq(true)) << "lane " << lane;
+}
+}
+
+TEST(BatchExecutor, EveryLaneEndsUpWhereTheInterpreterDoes)
+{
+    // An odd number of lanes, so some are left over from whole vectors
+    const auto input = [](size_t lane) { return static_cast<uint8_t>(lane * 37); };
+
+    for (uint64_t cycle_budget : { 777, 1000000 })
+    {
+        BatchExecutor batch(37);
+
+        setUpBatch(batch, input);
+        batch.run(cycle_budget);
+
+        size_t dropped_out = 0;
+
+        for (size_t lane = 0; lane < batch.lanes(); ++lane)
+        {
+            expectLaneMatches(batch, lane, interpret(input(lane), cycle_budget));
+            EXPECT_THAT(batch.result(lane).lockstep_instructions, Gt(0U));
+            if (batch.result(lane).lockstep_instructions < batch.result(lane).instructions)
+                ++dropped_out;
+        }
+        EXPECT_THAT(dropped_out, Gt(0U));
+    }
+    EXPECT_THAT(interpret(0, 1000000).result.reason, Eq(InstructionExecutor::StopReason::Break));
+}
+
+TEST(BatchExecutor, LanesWhichAgreeStayInLockstep)
+{
+    BatchExecutor batch(20);
+
+    setUpBatch(batch, [](size_t) { return uint8_t(0x42); });
+    batch.run(1000000);
+
+    const Interpreted expected = interpret(0x42, 1000000);
+
+    for (size_t lane = 0; lane < batch.lanes(); ++lane)
+    {
+        expectLaneMatches(batch, lane, expected);
+        EXPECT_THAT(batch.result(lane).lockstep_instructions, Eq(batch.result(lane).instructions));
+    }
+}
+
+TEST(BatchExecutor, LaneWithDifferentCodeDropsOut)
+{
+    BatchExecutor batch(3);
+
+    setUpBatch(batch, [](size_t) { return uint8_t(0x42); });
+    batch.memory(1)[0x040D] = 0xA5; // EOR #$A5 instead
+    batch.run(1000000);
+
+    EXPECT_THAT(batch.result(0).lockstep_instructions, Eq(batch.result(0).instructions));
+    EXPECT_THAT(batch.result(1).lockstep_instructions, Eq(7U));
+    EXPECT_THAT(batch.result(1).reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(batch.registers(2).a, Eq(batch.registers(0).a));
+}
@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include "clockpacer.hpp"
+
+using namespace testing;
+
+namespace
+{
+const ClockPacer::clockType::time_point start_time;
+
+ClockPacer::clockType::time_point after(int milliseconds)
+{
+    return start_time + std::chrono::milliseconds(milliseconds);
+}
+}
+
+TEST(ClockPacer, OwesTheCyclesForTheTimeElapsed)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    EXPECT_THAT(pacer.cyclesOwed(after(0)), Eq(0U));
+    EXPECT_THAT(pacer.cyclesOwed(after(16)), Eq(16000U));
+}
+
+TEST(ClockPacer, MakesUpForRunningLongOrShort)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    pacer.ran(1100, after(1));
+    EXPECT_THAT(pacer.cyclesOwed(after(1)), Eq(0U));
+    EXPECT_THAT(pacer.cyclesOwed(after(2)), Eq(900U));
+
+    pacer.ran(500, after(2));
+    EXPECT_THAT(pacer.cyclesOwed(after(3)), Eq(1400U));
+}
+
+TEST(ClockPacer, GivesUpOnCyclesOwedWhenTooFarBehind)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    EXPECT_THAT(pacer.cyclesOwed(after(1000)), Eq(100000U));
+
+    pacer.ran(100000, after(1000));
+    EXPECT_THAT(pacer.cyclesOwed(after(1001)), Eq(1000U));
+}
+
+TEST(ClockPacer, SpeedMultiplierScalesTheFrequency)
+{
+    ClockPacer pacer(ClockPacer::ntscFrequency);
+
+    pacer.start(start_time);
+    pacer.setSpeedMultiplier(2.0, start_time);
+    EXPECT_THAT(pacer.cyclesOwed(after(10)), Eq(35795U));
+}
+
+TEST(ClockPacer, TurboIgnoresTheClock)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    pacer.setTurbo(true, start_time);
+    EXPECT_THAT(pacer.cyclesOwed(after(0)), Eq(ClockPacer::turboBatch()));
+
+    // Leaving turbo doesn't owe for the time spent in it.
+    pacer.setTurbo(false, after(500));
+    EXPECT_THAT(pacer.cyclesOwed(after(501)), Eq(1000U));
+}
+
+TEST(ClockPacer, MeasuresTheFrequencyAchieved)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    for (int millisecond = 1; millisecond <= 300; ++millisecond)
+        pacer.ran(500, after(millisecond));
+    EXPECT_THAT(pacer.effectiveFrequency(), DoubleNear(500000.0, 1.0));
+}
+
+TEST(ClockPacer, KnowsWhenCyclesAheadFallDue)
+{
+    ClockPacer pacer(1000000.0);
+
+    pacer.start(start_time);
+    pacer.ran(2000, after(1));
+    EXPECT_TRUE(pacer.dueAt(0) == after(2));
+    EXPECT_TRUE(pacer.dueAt(8000) == after(10));
+}
@@ -0,0 +1,156 @@
+#include <gmock/gmock.h>
+#include "batchexecutor.hpp"
+#include "decimalmode.hpp"
+#include "machine.hpp"
+
+using namespace testing;
+
+namespace
+{
+struct Example
+{
+    uint8_t accumulator;
+    uint8_t operand;
+    bool    carry;
+    uint8_t value;
+    uint8_t status; // C, Z, V and N
+};
+
+// Worked examples of what an NMOS 6502 does, valid BCD or not
+const std::vector<Example> additions =
+{
+    { 0x00, 0x00, false, 0x00, Z         },
+    { 0x09, 0x01, false, 0x10, 0         },
+    { 0x58, 0x46, true,  0x05, C | V | N },
+    { 0x99, 0x01, false, 0x00, C | N     }, // Z comes from the binary sum, $9A
+    { 0x79, 0x00, true,  0x80, V | N     },
+    { 0x24, 0x56, false, 0x80, V | N     },
+    { 0x93, 0x82, false, 0x75, C | V     },
+    { 0x89, 0x76, false, 0x65, C         },
+    { 0x80, 0xF0, false, 0xD0, C | V     },
+    { 0x0F, 0x01, false, 0x16, 0         },
+};
+
+const std::vector<Example> subtractions =
+{
+    { 0x00, 0x00, false, 0x99, N         },
+    { 0x00, 0x00, true,  0x00, C | Z     },
+    { 0x00, 0x01, true,  0x99, N         },
+    { 0x46, 0x12, true,  0x34, C         },
+    { 0x40, 0x13, true,  0x27, C         },
+    { 0x32, 0x02, false, 0x29, C         },
+    { 0x12, 0x21, true,  0x91, N         },
+    { 0x0A, 0x00, true,  0x0A, C         },
+    { 0x9B, 0x00, false, 0x9A, C | N     },
+};
+
+constexpr uint8_t arithmetic_flags = C | Z | V | N;
+
+#ifdef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+// What ADC or SBC of the example does in binary, which is all there is
+// when built without decimal mode
+Example binaryOf(const Example &example, bool subtract)
+{
+    const uint8_t  operand = subtract ? static_cast<uint8_t>(~example.operand) : example.operand;
+    const unsigned sum     = example.accumulator + operand + (example.carry ? 1 : 0);
+    const uint8_t  value   = static_cast<uint8_t>(sum);
+    uint8_t        status  = 0;
+
+    if (sum > 0xFF)
+        status |= C;
+    if (value == 0)
+        status |= Z;
+    if (~(example.accumulator ^ operand) & (example.accumulator ^ value) & 0x80)
+        status |= V;
+    if (value & 0x80)
+        status |= N;
+    return { example.accumulator, example.operand, example.carry, value, status };
+}
+#endif
+
+// SED / LDA #accumulator / CLC or SEC / ADC or SBC #operand / BRK
+std::vector<uint8_t> programFor(const Example &example, bool subtract)
+{
+    return { 0xF8, 0xA9, example.accumulator, static_cast<uint8_t>(example.carry ? 0x38 : 0x18),
+             static_cast<uint8_t>(subtract ? 0xE9 : 0x69), example.operand, 0x00 };
+}
+}
+
+TEST(DecimalMode, AddsAsTheNmos6502Does)
+{
+    for (const Example &example : additions)
+    {
+        const DecimalResult &result = decimalAdd(example.accumulator, example.operand, example.carry);
+
+        EXPECT_THAT(result.value, Eq(example.value)) << std::hex << int(example.accumulator) << "+" << int(example.operand);
+        EXPECT_THAT(result.status, Eq(example.status)) << std::hex << int(example.accumulator) << "+" << int(example.operand);
+    }
+}
+
+TEST(DecimalMode, SubtractsAsTheNmos6502Does)
+{
+    for (const Example &example : subtractions)
+    {
+        const DecimalResult &result = decimalSubtract(example.accumulator, example.operand, example.carry);
+
+        EXPECT_THAT(result.value, Eq(example.value)) << std::hex << int(example.accumulator) << "-" << int(example.operand);
+        EXPECT_THAT(result.status, Eq(example.status)) << std::hex << int(example.accumulator) << "-" << int(example.operand);
+    }
+}
+
+TEST(DecimalMode, EveryWayOfExecutingFollowsTheDFlag)
+{
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        for (bool subtract : { false, true })
+        {
+            for (const Example &example : subtract ? subtractions : additions)
+            {
+#ifdef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+                // The D flag is set, but does nothing
+                const Example expected = binaryOf(example, subtract);
+#else
+                const Example &expected = example;
+#endif
+                Machine machine;
+
+                machine.load(0x0200, programFor(example, subtract));
+                machine.start(0x0200);
+                machine.executor().setPredecode(mode == 1);
+                machine.executor().setRecompile(mode == 2);
+                machine.run(100);
+
+                EXPECT_THAT(machine.registers().a, Eq(expected.value)) << "mode " << mode;
+                EXPECT_THAT(machine.registers().status & arithmetic_flags, Eq(expected.status)) << "mode " << mode;
+                EXPECT_THAT(machine.registers().status & D, Eq(D));
+            }
+        }
+    }
+}
+
+TEST(DecimalMode, LanesInDecimalModeLeaveLockstep)
+{
+    BatchExecutor batch(2);
+
+    // LDA #$09 / CLC / ADC #$01 / BRK, with one of the lanes in decimal mode
+    batch.load(0x0200, { 0xA9, 0x09, 0x18, 0x69, 0x01, 0x00 });
+    for (size_t lane = 0; lane < 2; ++lane)
+    {
+        Registers registers;
+
+        registers.program_counter = 0x0200;
+        registers.stack_pointer   = 0xFD;
+        registers.status          = U | ((lane == 1) ? D : 0);
+        batch.setRegisters(lane, registers);
+    }
+
+    batch.run(100);
+
+    EXPECT_THAT(batch.registers(0).a, Eq(0x0A));
+#ifdef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+    // Without decimal mode, the lanes never had to part
+    EXPECT_THAT(batch.registers(1).a, Eq(0x0A));
+#else
+    EXPECT_THAT(batch.registers(1).a, Eq(0x10));
+#endif
+}
@@ -0,0 +1,185 @@
+#include <gmock/gmock.h>
+#include "emulationthread.hpp"
+#include "spscqueue.hpp"
+#include <thread>
+
+using namespace testing;
+
+namespace
+{
+// Keeps a copy of memory up to date from the dirty pages of each snapshot,
+// as a user interface would, until @p done is satisfied.
+bool readUntil(EmulationThread &emulation,
+               EmulationSnapshot::memoryType &mirror,
+               const std::function<bool (const EmulationSnapshot &)> &done)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    bool       finished = false;
+
+    while (!finished && (std::chrono::steady_clock::now() < deadline))
+    {
+        emulation.readSnapshot([&](const EmulationSnapshot &snapshot)
+                               {
+                                   for (size_t page = 0; page < snapshot.dirty_pages.size(); ++page)
+                                   {
+                                       if (snapshot.dirty_pages.test(page))
+                                           std::copy_n(snapshot.memory.begin() + page * 0x100, 0x100, mirror.begin() + page * 0x100);
+                                   }
+                                   finished = done(snapshot);
+                               });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return finished;
+}
+}
+
+TEST(SpscQueue, KeepsOrderAndRefusesWhenFull)
+{
+    SpscQueue<int, 4> queue;
+    int               value = 0;
+
+    EXPECT_TRUE(queue.empty());
+    for (int i = 1; i <= 4; ++i)
+        EXPECT_TRUE(queue.push(i));
+    EXPECT_FALSE(queue.push(5));
+
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_THAT(value, Eq(1));
+    EXPECT_TRUE(queue.push(5));
+    for (int i = 2; i <= 5; ++i)
+    {
+        EXPECT_TRUE(queue.pop(value));
+        EXPECT_THAT(value, Eq(i));
+    }
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, HandsEverythingAcrossThreads)
+{
+    constexpr int      count = 10000;
+    SpscQueue<int, 64> queue;
+    std::thread        producer([&queue]()
+                                {
+                                    for (int i = 0; i < count; ++i)
+                                    {
+                                        while (!queue.push(i))
+                                            std::this_thread::yield();
+                                    }
+                                });
+    int expected = 0;
+    int value    = 0;
+
+    while (expected < count)
+    {
+        if (queue.pop(value))
+        {
+            ASSERT_THAT(value, Eq(expected));
+            ++expected;
+        }
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+}
+
+TEST(EmulationThread, PokesOnlyDirtyTheirPages)
+{
+    EmulationThread        emulation;
+    EmulationSnapshot::memoryType mirror {};
+
+    emulation.poke(0x1234, 0x56);
+    emulation.poke(0x12FF, 0x78);
+
+    EmulationSnapshot::pagesType dirty;
+
+    EXPECT_TRUE(readUntil(emulation, mirror, [&dirty](const EmulationSnapshot &snapshot)
+                                             {
+                                                 dirty |= snapshot.dirty_pages;
+                                                 return snapshot.memory[0x12FF] == 0x78;
+                                             }));
+    EXPECT_THAT(dirty.count(), Eq(1U));
+    EXPECT_TRUE(dirty.test(0x12));
+    EXPECT_THAT(mirror[0x1234], Eq(0x56));
+}
+
+TEST(EmulationThread, RunsWhenStartedAndPublishesAsItGoes)
+{
+    // Multiplies 10 by 3 into $0002 by repeated addition, then spins.
+    const std::vector<uint8_t> program {
+        0xA2, 0x0A, 0x8E, 0x00, 0x00, 0xA2, 0x03, 0x8E, 0x01, 0x00, 0xAC, 0x00, 0x00, 0xA9, 0x00,
+        0x18, 0x6D, 0x01, 0x00, 0x88, 0xD0, 0xFA, 0x8D, 0x02, 0x00, 0x4C, 0x19, 0x80
+    };
+    EmulationThread        emulation;
+    EmulationSnapshot::memoryType mirror {};
+
+    for (size_t offset = 0; offset < program.size(); ++offset)
+        emulation.poke(static_cast<uint16_t>(0x8000 + offset), program[offset]);
+    emulation.poke(0xFFFC, 0x00);
+    emulation.poke(0xFFFD, 0x80);
+    emulation.reset();
+    emulation.start();
+
+    EXPECT_TRUE(readUntil(emulation, mirror, [](const EmulationSnapshot &snapshot)
+                                             {
+                                                 return snapshot.running && (snapshot.registers.program_counter == 0x8019);
+                                             }));
+    EXPECT_THAT(mirror[0x0002], Eq(30));
+    EXPECT_THAT(mirror[0x8000], Eq(0xA2));
+
+    emulation.stop();
+    EXPECT_TRUE(readUntil(emulation, mirror, [](const EmulationSnapshot &snapshot)
+                                             {
+                                                 return !snapshot.running;
+                                             }));
+}
+
+TEST(EmulationThread, StepsOneCycleAtATime)
+{
+    EmulationThread        emulation;
+    EmulationSnapshot::memoryType mirror {};
+    uint64_t               ticks = 0;
+
+    emulation.step();
+    emulation.step();
+    EXPECT_TRUE(readUntil(emulation, mirror, [&ticks](const EmulationSnapshot &snapshot)
+                                             {
+                                                 ticks = snapshot.clock_ticks;
+                                                 return ticks == 2;
+                                             }));
+    EXPECT_THAT(ticks, Eq(2U));
+}
+
+TEST(EmulationThread, StepsBackOneCycleAtATime)
+{
+    EmulationThread        emulation;
+    EmulationSnapshot::memoryType mirror {};
+    uint64_t               ticks = 0;
+
+    emulation.step();
+    emulation.poke(0x1234, 0x56);
+    emulation.step();
+    emulation.step();
+    emulation.stepBack();
+    emulation.stepBack();
+    EXPECT_TRUE(readUntil(emulation, mirror, [&ticks](const EmulationSnapshot &snapshot)
+                                             {
+                                                 ticks = snapshot.clock_ticks;
+                                                 return ticks == 1;
+                                             }));
+    EXPECT_THAT(ticks, Eq(1U));
+
+    // The poke was made at cycle 1, so going back to it keeps the poke
+    EXPECT_THAT(mirror[0x1234], Eq(0x56));
+}
+
+TEST(EmulationThread, RefusesIrqSourcesTheCpuDoesntHave)
+{
+    EmulationThread emulation;
+
+    EXPECT_TRUE(emulation.raiseIrq(31));
+    EXPECT_TRUE(emulation.lowerIrq(31));
+    EXPECT_FALSE(emulation.raiseIrq(32));
+    EXPECT_FALSE(emulation.lowerIrq(255));
+    EXPECT_FALSE(emulation.post({ EmulationThread::Command::Type::RaiseIrq, 0, 40 }));
+}
@@ -0,0 +1,243 @@
+#include <gmock/gmock.h>
+#include <array>
+#include "eventscheduler.hpp"
+#include "machine.hpp"
+
+using namespace testing;
+
+namespace
+{
+// INX / JMP back to the INX, forever, with interrupts enabled
+const std::vector<uint8_t> spin_program { 0x58, 0xE8, 0x4C, 0x01, 0x02 };
+
+// INC $10 / RTI
+const std::vector<uint8_t> count_handler { 0xE6, 0x10, 0x40 };
+
+void setVector(Machine &machine, uint16_t vector, uint16_t address)
+{
+    machine.poke(vector, static_cast<uint8_t>(address & 0xFF));
+    machine.poke(static_cast<uint16_t>(vector + 1), static_cast<uint8_t>(address >> 8));
+}
+
+void setUpSpinning(Machine &machine, EventScheduler &scheduler)
+{
+    machine.load(0x0200, spin_program);
+    machine.load(0x0300, count_handler);
+    setVector(machine, 0xFFFE, 0x0300);
+    machine.start(0x0200);
+    machine.executor().setScheduler(&scheduler);
+}
+}
+
+TEST(EventScheduler, RunsEventsInOrderOfCycleThenScheduling)
+{
+    EventScheduler   scheduler;
+    std::vector<int> order;
+
+    scheduler.schedule(20, [&order](uint64_t) { order.push_back(3); });
+    scheduler.schedule(10, [&order](uint64_t) { order.push_back(1); });
+    scheduler.schedule(10, [&order](uint64_t) { order.push_back(2); });
+    scheduler.schedule(30, [&order](uint64_t) { order.push_back(4); });
+
+    EXPECT_THAT(scheduler.nextEventCycle(), Eq(10U));
+    EXPECT_THAT(scheduler.runDue(20), Eq(3U));
+    EXPECT_THAT(order, ElementsAre(1, 2, 3));
+    EXPECT_THAT(scheduler.nextEventCycle(), Eq(30U));
+}
+
+TEST(EventScheduler, CancelledEventsNeverRun)
+{
+    EventScheduler scheduler;
+    int            runs = 0;
+
+    auto first = scheduler.schedule(10, [&runs](uint64_t) { ++runs; });
+
+    scheduler.schedule(20, [&runs](uint64_t) { ++runs; });
+    scheduler.cancel(first);
+
+    EXPECT_THAT(scheduler.nextEventCycle(), Eq(20U));
+    EXPECT_THAT(scheduler.runDue(100), Eq(1U));
+    EXPECT_THAT(runs, Eq(1));
+    EXPECT_TRUE(scheduler.empty());
+    EXPECT_THAT(scheduler.nextEventCycle(), Eq(EventScheduler::never()));
+}
+
+TEST(EventScheduler, EventsCanScheduleMoreEvents)
+{
+    EventScheduler        scheduler;
+    std::vector<uint64_t> expiries;
+
+    // A periodic timer
+    std::function<void (uint64_t)> timer = [&](uint64_t cycle)
+                                           {
+                                               expiries.push_back(cycle);
+                                               scheduler.schedule(cycle + 100, timer);
+                                           };
+    scheduler.schedule(100, timer);
+
+    scheduler.runDue(350);
+    EXPECT_THAT(expiries, ElementsAre(100U, 200U, 300U));
+    EXPECT_THAT(scheduler.nextEventCycle(), Eq(400U));
+}
+
+TEST(InterruptLines, EventsRunAtTheFirstInstructionBoundaryAfterTheirCycle)
+{
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        Machine        machine;
+        EventScheduler scheduler;
+        uint64_t       ran_at = 0;
+
+        setUpSpinning(machine, scheduler);
+        machine.executor().setPredecode(mode == 1);
+        machine.executor().setRecompile(mode == 2);
+        scheduler.schedule(1000, [&](uint64_t) { ran_at = machine.executor().clock_ticks; });
+
+        machine.run(5000);
+
+        EXPECT_THAT(ran_at, AllOf(Ge(1000U), Lt(1003U))) << "mode " << mode;
+    }
+}
+
+TEST(InterruptLines, IrqIsLevelSensitive)
+{
+    Machine        machine;
+    EventScheduler scheduler;
+
+    setUpSpinning(machine, scheduler);
+    scheduler.schedule(100, [&machine](uint64_t) { machine.executor().raiseIrq(3); });
+    scheduler.schedule(200, [&machine](uint64_t) { machine.executor().lowerIrq(3); });
+
+    machine.run(99);
+    EXPECT_THAT(machine.memory()[0x10], Eq(0));
+
+    // Held for 100 cycles, the handler of 18 cycles runs again and again.
+    machine.run(200);
+    const uint8_t interrupts = machine.memory()[0x10];
+
+    EXPECT_THAT(interrupts, AllOf(Ge(5), Le(6)));
+    EXPECT_FALSE(machine.executor().irqLine());
+
+    machine.run(1000);
+    EXPECT_THAT(machine.memory()[0x10], Eq(interrupts));
+}
+
+TEST(InterruptLines, OnlyTheExecutorsSourcesCanHoldIrq)
+{
+    Machine machine;
+
+    EXPECT_TRUE(machine.executor().raiseIrq(31));
+    EXPECT_TRUE(machine.executor().lowerIrq(31));
+
+    // Asserted in debug builds, and ignored otherwise
+    EXPECT_DEBUG_DEATH(EXPECT_FALSE(machine.executor().raiseIrq(32)), "");
+    EXPECT_DEBUG_DEATH(EXPECT_FALSE(machine.executor().lowerIrq(255)), "");
+    EXPECT_FALSE(machine.executor().irqLine());
+}
+
+TEST(InterruptLines, MaskedIrqWaitsForCli)
+{
+    Machine machine;
+
+    // SEI / LDX #0 / INX / CPX #10 / BNE -5 / CLI / JMP to itself
+    machine.load(0x0200, { 0x78, 0xA2, 0x00, 0xE8, 0xE0, 0x0A, 0xD0, 0xFB, 0x58, 0x4C, 0x09, 0x02 });
+    // STX $10 / SEI, and stay there
+    machine.load(0x0300, { 0x86, 0x10, 0x78, 0x4C, 0x02, 0x03 });
+    setVector(machine, 0xFFFE, 0x0300);
+    machine.start(0x0200);
+    machine.run(2);
+    machine.executor().raiseIrq();
+
+    machine.run(1000);
+
+    EXPECT_THAT(machine.memory()[0x10], Eq(10));
+}
+
+TEST(InterruptLines, NmiIsServicedOnceEvenWhileMasked)
+{
+    Machine machine;
+
+    // SEI, then spin
+    machine.load(0x0200, { 0x78, 0x4C, 0x01, 0x02 });
+    // INC $11 / RTI
+    machine.load(0x0400, { 0xE6, 0x11, 0x40 });
+    setVector(machine, 0xFFFA, 0x0400);
+    machine.start(0x0200);
+    machine.run(10);
+    machine.executor().raiseNmi();
+
+    machine.run(1000);
+
+    EXPECT_THAT(machine.memory()[0x11], Eq(1));
+}
+
+TEST(InterruptLines, MasterClockDoesNotWrapAt32Bits)
+{
+    Machine machine;
+
+    machine.load(0x0200, spin_program);
+    machine.start(0x0200);
+    machine.executor().clock_ticks = 0xFFFFFFF0U;
+
+    machine.run(100);
+
+    EXPECT_THAT(machine.executor().clock_ticks, Gt(0x100000000ULL));
+}
+
+TEST(InterruptLines, DevicesRaisingIrqAreServicedAtTheNextBoundary)
+{
+    unsigned serviced[3] = {};
+
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        std::array<uint8_t, 0x10000> memory {};
+        InstructionExecutor         *irq_line = nullptr;
+
+        // Writing to $4000 holds the IRQ line while the value is non-zero,
+        // and writing to $4001 counts an interrupt and lets go of the line.
+        Registers           registers;
+        InstructionExecutor executor(registers,
+                                     [&memory](uint16_t address, bool) { return memory[address]; },
+                                     [&](uint16_t address, uint8_t value)
+                                     {
+                                         if (address == 0x4000)
+                                             value ? irq_line->raiseIrq() : irq_line->lowerIrq();
+                                         else if (address == 0x4001)
+                                         {
+                                             ++serviced[mode];
+                                             irq_line->lowerIrq();
+                                         }
+                                         else
+                                             memory[address] = value;
+                                     });
+
+        irq_line = &executor;
+        for (unsigned page = 0; page < 0x100; ++page)
+        {
+            if (page != 0x40)
+                executor.mapPage(static_cast<uint8_t>(page), &memory[page << 8], &memory[page << 8]);
+        }
+
+        // CLI / LDA #$01 / STA $4000 / LDA #$00 / STA $4000 / JMP $0201,
+        // which raises the line and lowers it again within the same block
+        const std::vector<uint8_t> program { 0x58, 0xA9, 0x01, 0x8D, 0x00, 0x40, 0xA9, 0x00, 0x8D, 0x00, 0x40, 0x4C, 0x01, 0x02 };
+        // STA $4001 / RTI
+        const std::vector<uint8_t> handler { 0x8D, 0x01, 0x40, 0x40 };
+
+        std::copy(program.begin(), program.end(), &memory[0x0200]);
+        std::copy(handler.begin(), handler.end(), &memory[0x0300]);
+        memory[0xFFFE] = 0x00;
+        memory[0xFFFF] = 0x03;
+        registers.stack_pointer   = 0xFD;
+        registers.program_counter = 0x0200;
+        executor.setPredecode(mode == 1);
+        executor.setRecompile(mode == 2);
+
+        executor.runCycles(20000);
+
+        EXPECT_THAT(serviced[mode], Eq(serviced[0])) << "mode " << mode;
+    }
+
+    // One for every pass of 32 cycles
+    EXPECT_THAT(serviced[0], AllOf(Ge(624U), Le(626U)));
+}
@@ -0,0 +1,117 @@
+#include <gmock/gmock.h>
+#include "fleetrunner.hpp"
+#include "machine.hpp"
+
+using namespace testing;
+
+namespace
+{
+// Adds up the sixteen bytes of input at $0300, leaving the sum in A and $10
+const auto sum_program = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>
+{
+    0xA2, 0x00,             // $0200  LDX #$00
+    0xA9, 0x00,             // $0202  LDA #$00
+    0x18,                   // $0204  CLC
+    0x7D, 0x00, 0x03,       // $0205  ADC $0300,X
+    0xE8,                   // $0208  INX
+    0xE0, 0x10,             // $0209  CPX #$10
+    0xD0, 0xF8,             // $020B  BNE $0205
+    0x85, 0x10,             // $020D  STA $10
+    0x00                    // $020F  BRK
+});
+
+FleetJob sumJob(uint8_t seed)
+{
+    FleetJob job;
+
+    job.image         = sum_program;
+    job.load_address  = 0x0200;
+    job.entry_point   = 0x0200;
+    job.cycle_budget  = 100000;
+    job.input_address = 0x0300;
+    for (int index = 0; index < 16; ++index)
+        job.input.push_back(static_cast<uint8_t>(seed * (index + 1)));
+    return job;
+}
+}
+
+TEST(Machine, RunsFromTheEntryPoint)
+{
+    Machine machine;
+
+    machine.load(0x0200, *sum_program);
+    machine.load(0x0300, sumJob(1).input);
+    machine.start(0x0200);
+
+    auto result = machine.run(100000);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(machine.registers().a, Eq(136));
+    EXPECT_THAT(machine.memory()[0x10], Eq(136));
+    EXPECT_THAT(machine.registers().program_counter, Eq(0x020F));
+}
+
+TEST(FleetRunner, GivesTheSameResultsWhateverTheThreads)
+{
+    std::vector<FleetJob> jobs;
+
+    for (int seed = 0; seed < 100; ++seed)
+        jobs.push_back(sumJob(static_cast<uint8_t>(seed)));
+
+    Machine machine;
+    const auto single = FleetRunner(1).run(jobs);
+    const auto many   = FleetRunner(4).run(jobs);
+
+    ASSERT_THAT(single.size(), Eq(jobs.size()));
+    ASSERT_THAT(many.size(), Eq(jobs.size()));
+    for (size_t index = 0; index < jobs.size(); ++index)
+    {
+        const FleetResult alone = FleetRunner::runJob(machine, jobs[index]);
+
+        EXPECT_THAT(alone.registers.a, Eq(static_cast<uint8_t>(index * 136)));
+        EXPECT_THAT(many[index].registers.a, Eq(alone.registers.a));
+        EXPECT_THAT(many[index].registers.status, Eq(alone.registers.status));
+        EXPECT_THAT(many[index].cycles, Eq(alone.cycles));
+        EXPECT_THAT(many[index].instructions, Eq(alone.instructions));
+        EXPECT_THAT(many[index].reason, Eq(alone.reason));
+        EXPECT_THAT(many[index].memory_digest, Eq(alone.memory_digest));
+        EXPECT_THAT(single[index].memory_digest, Eq(alone.memory_digest));
+    }
+}
+
+TEST(FleetRunner, DigestCoversTheWholeOfMemory)
+{
+    Machine machine;
+    FleetJob job = sumJob(3);
+
+    const uint64_t digest = FleetRunner::runJob(machine, job).memory_digest;
+
+    EXPECT_THAT(FleetRunner::runJob(machine, job).memory_digest, Eq(digest));
+
+    job.input.push_back(0x01); // Past what the program reads
+    EXPECT_THAT(FleetRunner::runJob(machine, job).memory_digest, Ne(digest));
+}
+
+TEST(FleetRunner, JobsDontInheritInterruptsFromTheJobBefore)
+{
+    Machine  fresh;
+    Machine  reused;
+    FleetJob job = sumJob(5);
+
+    const FleetResult expected = FleetRunner::runJob(fresh, job);
+
+    // As a device might have left it, part way through the job before
+    FleetRunner::runJob(reused, sumJob(7));
+    reused.executor().raiseIrq(4);
+    reused.executor().raiseNmi();
+
+    const FleetResult result = FleetRunner::runJob(reused, job);
+
+    EXPECT_FALSE(reused.executor().irqLine());
+    EXPECT_THAT(result.registers.a, Eq(expected.registers.a));
+    EXPECT_THAT(result.registers.stack_pointer, Eq(expected.registers.stack_pointer));
+    EXPECT_THAT(result.registers.program_counter, Eq(expected.registers.program_counter));
+    EXPECT_THAT(result.cycles, Eq(expected.cycles));
+    EXPECT_THAT(result.memory_digest, Eq(expected.memory_digest));
+    EXPECT_THAT(reused.executor().clock_ticks, Eq(fresh.executor().clock_ticks));
+}
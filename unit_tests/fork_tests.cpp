@@ -0,0 +1,187 @@
+#include <gmock/gmock.h>
+#include <set>
+#include <thread>
+#include "machine.hpp"
+
+using namespace testing;
+using InstructionSet = InstructionExecutor::InstructionSet;
+
+namespace
+{
+// Adds an input register into a running total, over and over:
+//
+//  $0200  CLC
+//  $0201  LDA $10
+//         ADC $4000
+//         STA $10
+//         INC $0300,X
+//         INX
+//         JMP $0201
+const std::vector<uint8_t> totalling
+{
+    0x18, 0xA5, 0x10, 0x6D, 0x00, 0x40, 0x85, 0x10, 0xFE, 0x00, 0x03, 0xE8, 0x4C, 0x01, 0x02
+};
+
+void setUp(Machine &machine)
+{
+    machine.load(0x0200, totalling);
+    machine.start(0x0200);
+}
+}
+
+TEST(Fork, TheChildStartsOffJustLikeItsParent)
+{
+    Machine machine;
+
+    setUp(machine);
+    machine.executor().setInstructionSet(InstructionSet::Cmos65C02);
+    machine.executor().setPredecode(true);
+    machine.executor().setSkipIdleLoops(false);
+    machine.executor().setBreakpoint(0x1234);
+    machine.setHashWrites(true);
+    machine.run(10000);
+
+    auto child = machine.fork();
+
+    EXPECT_THAT(child->stateHash(), Eq(machine.stateHash()));
+    EXPECT_THAT(child->memoryDigest(), Eq(machine.memoryDigest()));
+    EXPECT_THAT(child->executor().clock_ticks, Eq(machine.executor().clock_ticks));
+    EXPECT_THAT(child->registers().program_counter, Eq(machine.registers().program_counter));
+    EXPECT_THAT(child->executor().instructionSet(), Eq(InstructionSet::Cmos65C02));
+    EXPECT_TRUE(child->executor().predecode());
+    EXPECT_FALSE(child->executor().skipIdleLoops());
+    EXPECT_TRUE(child->executor().hasBreakpoint(0x1234));
+    EXPECT_TRUE(child->hashWrites());
+    EXPECT_THAT(child->executor().scheduler(), IsNull());
+}
+
+TEST(Fork, EachGoesItsOwnWay)
+{
+    Machine unforked;
+    Machine parent;
+
+    setUp(unforked);
+    setUp(parent);
+    unforked.run(10000);
+    parent.run(10000);
+
+    auto child = parent.fork();
+
+    child->poke(0x4000, 0x03);
+    child->run(10000);
+    parent.run(10000);
+    unforked.run(10000);
+
+    // The parent carries on as if nothing had happened.
+    EXPECT_THAT(parent.stateHash(), Eq(unforked.stateHash()));
+    EXPECT_THAT(parent.registers().a, Eq(unforked.registers().a));
+    EXPECT_THAT(child->stateHash(), Ne(parent.stateHash()));
+    EXPECT_THAT(child->memory()[0x4000], Eq(0x03));
+    EXPECT_THAT(parent.memory()[0x4000], Eq(0x00));
+}
+
+TEST(Fork, TheChildSharesThePagesNeitherHasWrittenTo)
+{
+    Machine machine;
+
+    setUp(machine);
+    machine.run(10000);
+
+    auto child = machine.fork();
+
+    child->run(10000);
+
+    for (unsigned page = 0; page < 0x100; ++page)
+    {
+        const bool written = (page == 0x00) || (page == 0x03);
+
+        EXPECT_THAT(child->memory().samePage(machine.memory(), static_cast<uint8_t>(page)), Ne(written)) << page;
+    }
+}
+
+TEST(Fork, ThousandsOfChildrenCanBranchOffOneState)
+{
+    Machine parent;
+
+    setUp(parent);
+    parent.setHashWrites(true);
+    parent.run(50000);
+
+    std::vector<std::unique_ptr<Machine>> children;
+    std::set<uint64_t>                    hashes;
+
+    for (unsigned input = 0; input < 2000; ++input)
+    {
+        children.push_back(parent.fork());
+        children.back()->poke(0x4000, static_cast<uint8_t>(input));
+        children.back()->poke(0x4001, static_cast<uint8_t>(input >> 8));
+        children.back()->run(100);
+        hashes.insert(children.back()->stateHash());
+    }
+
+    EXPECT_THAT(hashes.size(), Eq(2000U));
+}
+
+TEST(Fork, ChildrenCanRunOnDifferentThreads)
+{
+    Machine parent;
+
+    setUp(parent);
+    parent.executor().setPredecode(true);
+    parent.run(10000);
+
+    std::vector<std::unique_ptr<Machine>> children;
+    std::vector<std::thread>              threads;
+
+    for (uint8_t input = 0; input < 4; ++input)
+    {
+        children.push_back(parent.fork());
+        children.back()->poke(0x4000, input);
+    }
+    for (auto &child : children)
+        threads.emplace_back([&child]() { child->run(200000); });
+    for (auto &thread : threads)
+        thread.join();
+
+    // Each does exactly what it would have done on its own.
+    for (uint8_t input = 0; input < 4; ++input)
+    {
+        auto alone = parent.fork();
+
+        alone->poke(0x4000, input);
+        alone->run(200000);
+        EXPECT_THAT(children[input]->stateHash(), Eq(alone->stateHash()));
+        EXPECT_THAT(children[input]->executor().clock_ticks, Eq(alone->executor().clock_ticks));
+    }
+}
+
+TEST(Fork, TheParentCanRunAlongsideItsChild)
+{
+    Machine parent;
+    Machine unforked;
+
+    setUp(parent);
+    setUp(unforked);
+
+    // Every round starts with the two sharing the pages both go on to
+    // write, so each in turn finds itself the last one holding a page the
+    // other was reading a moment ago.
+    for (uint8_t round = 0; round < 20; ++round)
+    {
+        auto child = parent.fork();
+        auto alone = unforked.fork();
+
+        child->poke(0x4000, round);
+        alone->poke(0x4000, round);
+
+        std::thread thread([&child]() { child->run(20000); });
+
+        parent.run(20000);
+        thread.join();
+        unforked.run(20000);
+        alone->run(20000);
+
+        EXPECT_THAT(parent.stateHash(), Eq(unforked.stateHash()));
+        EXPECT_THAT(child->stateHash(), Eq(alone->stateHash()));
+    }
+}
@@ -0,0 +1,95 @@
+#include <gmock/gmock.h>
+#include "eventscheduler.hpp"
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+
+using namespace testing;
+
+namespace
+{
+enum class Mode { Interpret, Predecode, Fuse };
+
+// Each idiom that is fused, over and over:
+//
+//  $0200  LDX #$20
+//  $0202  LDA $0300,X
+//         STA $0400,X
+//         CLC
+//         ADC $10
+//         STA $10
+//         CMP #$80
+//         BEQ +0
+//         DEX
+//         BNE $0202
+//         INC $11
+//         BNE $0200
+//         JMP $0200
+const std::vector<uint8_t> idioms
+{
+    0xA2, 0x20, 0xBD, 0x00, 0x03, 0x9D, 0x00, 0x04, 0x18, 0x65, 0x10, 0x85, 0x10,
+    0xC9, 0x80, 0xF0, 0x00, 0xCA, 0xD0, 0xEE, 0xE6, 0x11, 0xD0, 0xE8, 0x4C, 0x00, 0x02
+};
+
+// INC $12 / RTI
+const std::vector<uint8_t> count_handler { 0xE6, 0x12, 0x40 };
+
+// Runs the program in the given mode, with an event at event_cycle which
+// changes the data it copies, and the IRQ line held for a while after it.
+Outcome runProgram(const std::vector<uint8_t> &program, uint16_t address, Mode mode,
+                   uint64_t event_cycle, uint64_t cycle_budget)
+{
+    Machine        machine;
+    EventScheduler scheduler;
+
+    for (unsigned offset = 0; offset < 0x100; ++offset)
+        machine.poke(static_cast<uint16_t>(0x0300 + offset), static_cast<uint8_t>(offset * 7));
+    machine.load(0x0500, count_handler);
+    machine.poke(0xFFFE, 0x00);
+    machine.poke(0xFFFF, 0x05);
+    machine.load(address, program);
+    machine.start(address);
+    machine.executor().setPredecode(mode != Mode::Interpret);
+    machine.executor().setFuseInstructions(mode == Mode::Fuse);
+    machine.executor().setScheduler(&scheduler);
+    scheduler.schedule(event_cycle, [&machine](uint64_t)
+                                    {
+                                        machine.poke(0x0310, 0x55);
+                                        machine.executor().raiseIrq();
+                                    });
+    scheduler.schedule(event_cycle + 20, [&machine](uint64_t) { machine.executor().lowerIrq(); });
+
+    auto    result  = machine.executor().runCycles(cycle_budget);
+    Outcome outcome = outcomeOf(machine);
+
+    outcome.instructions = result.instructions;
+    return outcome;
+}
+}
+
+TEST(FusedInstructions, RunExactlyAsTheInstructionsOneAtATime)
+{
+    for (uint64_t event_cycle = 500; event_cycle < 520; ++event_cycle)
+    {
+        for (uint64_t budget : { 1000U, 1001U, 1002U, 1003U, 50000U })
+        {
+            const Outcome expected = runProgram(idioms, 0x0200, Mode::Interpret, event_cycle, budget);
+
+            expectSameOutcome(runProgram(idioms, 0x0200, Mode::Predecode, event_cycle, budget), expected);
+            expectSameOutcome(runProgram(idioms, 0x0200, Mode::Fuse, event_cycle, budget), expected);
+        }
+    }
+}
+
+TEST(FusedInstructions, PairIsDecodedAgainWhenTheFirstWritesTheSecond)
+{
+    // INC $23, the offset of the BNE after it, which lands further along a
+    // run of NOPs each time round, and then JMP $0020.
+    std::vector<uint8_t> program { 0xE6, 0x23, 0xD0, 0x00 };
+
+    program.resize(0x90 - 0x20, 0xEA);
+    program.insert(program.end(), { 0x4C, 0x20, 0x00 });
+
+    const Outcome expected = runProgram(program, 0x0020, Mode::Interpret, UINT64_MAX - 100, 2000);
+
+    expectSameOutcome(runProgram(program, 0x0020, Mode::Fuse, UINT64_MAX - 100, 2000), expected);
+}
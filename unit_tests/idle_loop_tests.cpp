@@ -0,0 +1,128 @@
+#include <gmock/gmock.h>
+#include "eventscheduler.hpp"
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+
+using namespace testing;
+
+namespace
+{
+struct IdleOutcome
+{
+    Outcome  machine;
+    uint64_t event_ran_at;
+    bool     idle;
+};
+
+// Runs a program until the budget is spent, with an event at event_cycle
+// which stores 1 in $10, and reports how it ended up.
+IdleOutcome runProgram(const std::vector<uint8_t> &program, uint16_t address, bool skip,
+                   uint64_t event_cycle, uint64_t cycle_budget, uint64_t instruction_budget = UINT64_MAX)
+{
+    Machine        machine;
+    EventScheduler scheduler;
+    IdleOutcome    outcome {};
+
+    machine.load(address, program);
+    machine.start(address);
+    machine.executor().setScheduler(&scheduler);
+    machine.executor().setSkipIdleLoops(skip);
+    scheduler.schedule(event_cycle, [&](uint64_t)
+                                    {
+                                        machine.poke(0x10, 1);
+                                        outcome.event_ran_at = machine.executor().clock_ticks;
+                                    });
+
+    auto result = (instruction_budget == UINT64_MAX) ? machine.executor().runCycles(cycle_budget)
+                                                     : machine.executor().runInstructions(instruction_budget);
+
+    outcome.machine              = outcomeOf(machine);
+    outcome.machine.instructions = result.instructions;
+    outcome.idle                 = result.idle;
+    return outcome;
+}
+
+void expectSameOutcome(const IdleOutcome &skipped, const IdleOutcome &run)
+{
+    ::expectSameOutcome(skipped.machine, run.machine);
+    EXPECT_THAT(skipped.event_ran_at, Eq(run.event_ran_at));
+}
+
+// LDA $10 / BEQ back to the LDA / INX / JMP to itself
+std::vector<uint8_t> waitLoop(uint16_t address)
+{
+    const uint16_t spin = static_cast<uint16_t>(address + 5);
+
+    return { 0xA5, 0x10, 0xF0, 0xFC, 0xE8, 0x4C,
+             static_cast<uint8_t>(spin & 0xFF), static_cast<uint8_t>(spin >> 8) };
+}
+}
+
+TEST(IdleLoops, JumpToItselfIsSkippedExactly)
+{
+    // JMP to itself
+    const std::vector<uint8_t> program { 0x4C, 0x00, 0x02 };
+
+    for (uint64_t budget : { 1000U, 1001U, 1002U, 123457U })
+    {
+        const IdleOutcome skipped = runProgram(program, 0x0200, true,  500, budget);
+        const IdleOutcome run     = runProgram(program, 0x0200, false, 500, budget);
+
+        expectSameOutcome(skipped, run);
+        EXPECT_TRUE(skipped.idle) << "budget " << budget;
+    }
+}
+
+TEST(IdleLoops, WaitLoopIsSkippedUntilAnEventLetsItOut)
+{
+    // The second one branches back across a page boundary, which costs a cycle more.
+    for (uint16_t address : { 0x0200, 0x02FD })
+    {
+        for (uint64_t event_cycle : { 100U, 5001U, 77777U })
+        {
+            const IdleOutcome skipped = runProgram(waitLoop(address), address, true,  event_cycle, 100000);
+            const IdleOutcome run     = runProgram(waitLoop(address), address, false, event_cycle, 100000);
+
+            expectSameOutcome(skipped, run);
+            EXPECT_THAT(skipped.machine.registers.x, Eq(1));
+        }
+    }
+}
+
+TEST(IdleLoops, InstructionBudgetsAreKeptExactly)
+{
+    const IdleOutcome skipped = runProgram(waitLoop(0x0200), 0x0200, true,  UINT64_MAX, 0, 10001);
+    const IdleOutcome run     = runProgram(waitLoop(0x0200), 0x0200, false, UINT64_MAX, 0, 10001);
+
+    expectSameOutcome(skipped, run);
+    EXPECT_THAT(skipped.machine.instructions, Eq(10001U));
+}
+
+TEST(IdleLoops, LoopsReadingUnmappedMemoryAreNotSkipped)
+{
+    Machine machine;
+
+    // LDA $4000 / BEQ back to the LDA
+    machine.load(0x0200, { 0xAD, 0x00, 0x40, 0xF0, 0xFB });
+    machine.start(0x0200);
+    machine.executor().mapPage(0x40, nullptr, nullptr);
+
+    auto result = machine.executor().runCycles(10000);
+
+    EXPECT_FALSE(result.idle);
+    EXPECT_THAT(machine.executor().clock_ticks, Eq(10000U));
+}
+
+TEST(IdleLoops, LoopsWhichChangeStateAreNotSkipped)
+{
+    Machine machine;
+
+    // INX / JMP back to the INX
+    machine.load(0x0200, { 0xE8, 0x4C, 0x00, 0x02 });
+    machine.start(0x0200);
+
+    auto result = machine.executor().runCycles(5000);
+
+    EXPECT_FALSE(result.idle);
+    EXPECT_THAT(machine.registers().x, Eq(static_cast<uint8_t>((result.instructions + 1) / 2)));
+}
@@ -0,0 +1,233 @@
+#include <gmock/gmock.h>
+#include "inputjournal.hpp"
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+
+using namespace testing;
+using Type = InputJournal::Type;
+
+namespace
+{
+// Copies an input register into a buffer, while the IRQ handler counts in
+// $10 and the NMI handler in $11:
+//
+//  $0200  CLI
+//  $0201  LDA $4000
+//         STA $0300,X
+//         INX
+//         JMP $0201
+const std::vector<uint8_t> copying { 0x58, 0xAD, 0x00, 0x40, 0x9D, 0x00, 0x03, 0xE8, 0x4C, 0x01, 0x02 };
+
+void setUp(Machine &machine)
+{
+    machine.load(0x0200, copying);
+    machine.load(0x0500, { 0xE6, 0x10, 0x40 });
+    machine.load(0x0510, { 0xE6, 0x11, 0x40 });
+    machine.poke(0xFFFA, 0x10);
+    machine.poke(0xFFFB, 0x05);
+    machine.poke(0xFFFC, 0x00);
+    machine.poke(0xFFFD, 0x02);
+    machine.poke(0xFFFE, 0x00);
+    machine.poke(0xFFFF, 0x05);
+    machine.start(0x0200);
+}
+
+// A session of the host poking the input register and raising interrupts
+// at odd moments, some of them part way through an instruction.
+Outcome record(Machine &machine, InputJournal &journal)
+{
+    for (unsigned step = 0; step < 300; ++step)
+    {
+        if (step % 5 == 0)
+            machine.executor().runCycles(3);
+        else
+            machine.run(101 + step % 13);
+
+        journal.poke(machine, 0x4000, static_cast<uint8_t>(step));
+        if (step % 17 == 0)
+            journal.raiseIrq(machine, 2);
+        if (step % 17 == 1)
+            journal.lowerIrq(machine, 2);
+        if (step % 29 == 7)
+            journal.raiseNmi(machine);
+        if (step == 250)
+            journal.reset(machine);
+    }
+    machine.run(500);
+    return outcomeOf(machine);
+}
+}
+
+TEST(InputJournal, RecordsWhenEachInputHappened)
+{
+    Machine      machine;
+    InputJournal journal;
+
+    setUp(machine);
+    machine.run(100);
+    journal.poke(machine, 0x4000, 0x42);
+    machine.run(50);
+    journal.raiseIrq(machine, 3);
+
+    ASSERT_THAT(journal.entries().size(), Eq(2U));
+    EXPECT_THAT(journal.entries()[0].type, Eq(Type::Poke));
+    EXPECT_THAT(journal.entries()[0].cycle, Ge(100U));
+    EXPECT_THAT(journal.entries()[0].address, Eq(0x4000));
+    EXPECT_THAT(journal.entries()[0].value, Eq(0x42));
+    EXPECT_THAT(journal.entries()[1].type, Eq(Type::RaiseIrq));
+    EXPECT_THAT(journal.entries()[1].cycle, Eq(machine.executor().clock_ticks));
+    EXPECT_THAT(journal.entries()[1].value, Eq(3));
+    EXPECT_THAT(machine.memory()[0x4000], Eq(0x42));
+    EXPECT_TRUE(machine.executor().irqLine());
+}
+
+TEST(InputJournal, ReplayingReproducesTheSessionExactly)
+{
+    for (bool predecode : { false, true })
+    {
+        Machine      recorded;
+        InputJournal journal;
+
+        setUp(recorded);
+
+        const Machine::Snapshot start    = recorded.snapshot();
+        const Outcome           expected = record(recorded, journal);
+
+        Machine replayed;
+
+        replayed.restore(start);
+        replayed.executor().setPredecode(predecode);
+        journal.replay(replayed, expected.clock_ticks, 0);
+
+        expectSameOutcome(outcomeOf(replayed), expected);
+    }
+}
+
+TEST(InputJournal, ReplaysFromPartWayThrough)
+{
+    Machine      recorded;
+    InputJournal journal;
+
+    setUp(recorded);
+    recorded.run(20000);
+
+    const Machine::Snapshot middle   = recorded.snapshot();
+    const Outcome           expected = record(recorded, journal);
+
+    // The entries from before the snapshot's cycle are skipped.
+    InputJournal whole;
+
+    whole.record({ 5, Type::Poke, 0x4000, 0xEE });
+    for (const InputJournal::Entry &entry : journal.entries())
+        whole.record(entry);
+
+    Machine replayed;
+
+    replayed.restore(middle);
+    whole.replay(replayed, expected.clock_ticks, 0);
+
+    expectSameOutcome(outcomeOf(replayed), expected);
+}
+
+TEST(InputJournal, DoesntRedoWhatCameBeforeTheSnapshotInItsCycle)
+{
+    Machine      recorded;
+    InputJournal journal;
+
+    setUp(recorded);
+    recorded.run(1000);
+
+    // Doing the reset again would pick up the new reset vector
+    journal.reset(recorded);
+    journal.poke(recorded, 0xFFFC, 0x01);
+
+    const Machine::Snapshot middle   = recorded.snapshot();
+    const size_t            first    = journal.entries().size();
+    const Outcome           expected = record(recorded, journal);
+
+    Machine replayed;
+
+    replayed.restore(middle);
+    journal.replay(replayed, expected.clock_ticks, first);
+
+    expectSameOutcome(outcomeOf(replayed), expected);
+}
+
+TEST(InputJournal, OnlyRecordsTheExecutorsIrqSources)
+{
+    Machine      machine;
+    InputJournal journal;
+
+    EXPECT_TRUE(journal.raiseIrq(machine, 31));
+    EXPECT_FALSE(journal.raiseIrq(machine, 32));
+    EXPECT_FALSE(journal.lowerIrq(machine, 255));
+    EXPECT_TRUE(journal.lowerIrq(machine, 31));
+
+    InputJournal decoded;
+
+    EXPECT_THAT(journal.entries().size(), Eq(2U));
+    EXPECT_TRUE(decoded.decode(journal.encode()));
+    EXPECT_FALSE(machine.executor().irqLine());
+}
+
+TEST(InputJournal, SurvivesEncodingAsABinaryLog)
+{
+    Machine      recorded;
+    InputJournal journal;
+
+    setUp(recorded);
+
+    const Machine::Snapshot start    = recorded.snapshot();
+    const Outcome           expected = record(recorded, journal);
+    const auto              log      = journal.encode();
+
+    // Most entries are a poke a hundred or so cycles after the one before
+    EXPECT_THAT(log.size(), Lt(journal.entries().size() * 6));
+
+    InputJournal decoded;
+
+    ASSERT_TRUE(decoded.decode(log));
+    ASSERT_THAT(decoded.entries().size(), Eq(journal.entries().size()));
+
+    Machine replayed;
+
+    replayed.restore(start);
+    decoded.replay(replayed, expected.clock_ticks, 0);
+
+    expectSameOutcome(outcomeOf(replayed), expected);
+}
+
+TEST(InputJournal, RejectsLogsItDidntMake)
+{
+    InputJournal journal;
+    InputJournal first;
+
+    first.record({ 1000, Type::Poke, 0x4000, 0x01 });
+    journal.record(first.entries()[0]);
+    journal.record({ 1000000000000ULL, Type::RaiseIrq, 0, 31 });
+
+    const auto log = journal.encode();
+
+    // Cut off just after the header or the first entry, it is still a valid log, only shorter.
+    const size_t header_length = InputJournal().encode().size();
+    const size_t first_length  = first.encode().size();
+
+    for (size_t length = 0; length < log.size(); ++length)
+    {
+        InputJournal truncated;
+
+        if ((length == header_length) || (length == first_length))
+            continue;
+
+        EXPECT_FALSE(truncated.decode(std::vector<uint8_t>(log.begin(), log.begin() + length))) << length;
+    }
+
+    InputJournal decoded;
+
+    EXPECT_FALSE(decoded.decode({ 'I', 'J', 'N', 2 }));
+    EXPECT_FALSE(decoded.decode({ 'I', 'J', 'N', 1, 7, 0 }));
+    EXPECT_FALSE(decoded.decode({ 'I', 'J', 'N', 1, 0, 0, 32 }));
+    EXPECT_TRUE(decoded.decode(log));
+    EXPECT_THAT(decoded.entries()[1].cycle, Eq(1000000000000ULL));
+    EXPECT_THAT(decoded.entries()[1].value, Eq(31));
+}
@@ -1,5 +1,7 @@
 #include <gmock/gmock.h>
 #include "InstructionExecutorTestFixture.hpp"
+#include "blockrecompiler.hpp"
+#include <algorithm>
 #include <limits>
 
 using namespace testing;
@@ -44,3 +46,386 @@ TEST_F(InstructionExecutorTestFixture, ClockTickIncrementsClockCount)
 
     EXPECT_THAT(executor.clock_ticks, Eq(std::numeric_limits<decltype(executor.clock_ticks)>::min()));
 }
+
+TEST_F(InstructionExecutorTestFixture, ReadFromMappedPageDoesNotUseReadDelegate)
+{
+    std::array<uint8_t, 256> page {};
+
+    page[0x34] = 0xA5;
+    executor.mapPage(0x12, page.data(), page.data());
+
+    // LDA $1234
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDA, AddressMode_e::Absolute, 0x8000);
+    fakeMemory[0x8001] = 0x34;
+    fakeMemory[0x8002] = 0x12;
+    executeInstruction();
+
+    EXPECT_THAT(executor.registers().a, Eq(0xA5));
+    for (const auto &read_signal : readSignalsCaught)
+        EXPECT_THAT(read_signal.address, Ne(0x1234));
+}
+
+TEST_F(InstructionExecutorTestFixture, WriteToMappedPageDoesNotUseWriteDelegate)
+{
+    std::array<uint8_t, 256> page {};
+
+    executor.mapPage(0x12, page.data(), page.data());
+    executor.registers().a = 0x5A;
+
+    // STA $1234
+    loadOpcodeIntoMemory(AbstractInstruction_e::STA, AddressMode_e::Absolute, 0x8000);
+    fakeMemory[0x8001] = 0x34;
+    fakeMemory[0x8002] = 0x12;
+    executeInstruction();
+
+    EXPECT_THAT(page[0x34], Eq(0x5A));
+    EXPECT_THAT(writeSignalsCaught.size(), Eq(0U));
+}
+
+TEST_F(InstructionExecutorTestFixture, UnmappedPageUsesDelegatesAgain)
+{
+    std::array<uint8_t, 256> page {};
+
+    executor.mapPage(0x80, page.data(), page.data());
+    executor.unmapPage(0x80);
+
+    // LDA #$42
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDA, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x42;
+    executeInstruction();
+
+    EXPECT_THAT(executor.registers().a, Eq(0x42));
+    EXPECT_THAT(readSignalsCaught.size(), Eq(2U));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunCyclesConsumesExactlyTheBudget)
+{
+    // Two NOPs (2 cycles each) followed by a 4 cycle LDA
+    loadOpcodeIntoMemory(AbstractInstruction_e::NOP, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::NOP, AddressMode_e::Implied);
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Absolute);
+
+    auto result = executor.runCycles(5);
+
+    EXPECT_THAT(result.cycles, Eq(5U));
+    EXPECT_THAT(result.instructions, Eq(3U));
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::BudgetSpent));
+    EXPECT_THAT(executor.clock_ticks, Eq(5U));
+    EXPECT_THAT(executor.remainingCyclesForInstruction(), Eq(3));
+
+    // Finishing off the instruction in progress is what clock() would do.
+    result = executor.runCycles(3);
+
+    EXPECT_THAT(result.cycles, Eq(3U));
+    EXPECT_THAT(result.instructions, Eq(0U));
+    EXPECT_THAT(executor.complete(), Eq(true));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunInstructionsExecutesWholeInstructions)
+{
+    loadOpcodeIntoMemory(AbstractInstruction_e::INX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+
+    auto result = executor.runInstructions(2);
+
+    EXPECT_THAT(result.cycles, Eq(4U));
+    EXPECT_THAT(result.instructions, Eq(2U));
+    EXPECT_THAT(executor.registers().x, Eq(2));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8002));
+    EXPECT_THAT(executor.complete(), Eq(true));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunStopsAtBreakpoint)
+{
+    loadOpcodeIntoMemory(AbstractInstruction_e::INX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+    executor.setBreakpoint(0x8001);
+
+    auto result = executor.runCycles(100);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Breakpoint));
+    EXPECT_THAT(result.instructions, Eq(1U));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8001));
+
+    // Running again steps over the breakpoint.
+    result = executor.runInstructions(1);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::BudgetSpent));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8002));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunStopsAtBreakAndIllegalOpcodes)
+{
+    loadOpcodeIntoMemory(AbstractInstruction_e::INX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::BRK, AddressMode_e::Implied);
+
+    auto result = executor.runCycles(100);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8001));
+
+    loadOpcodeIntoMemory(AbstractInstruction_e::INX, AddressMode_e::Implied, 0x9000);
+    fakeMemory[0x9001] = 0x02; // Not a 6502 instruction
+
+    result = executor.runCycles(100);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::IllegalOpcode));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x9001));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunUntilStopsWhenPredicateIsSatisfied)
+{
+    // DEX, BNE back to the DEX
+    loadOpcodeIntoMemory(AbstractInstruction_e::DEX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    fakeMemory[0x8002] = 0xFD;
+    executor.registers().x = 10;
+
+    auto result = executor.runUntil([](const Registers &registers) { return registers.x == 3; });
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Condition));
+    EXPECT_THAT(executor.registers().x, Eq(3));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8001));
+    EXPECT_THAT(xChangedSignalsCaught.size(), Eq(1U));
+}
+
+TEST_F(InstructionExecutorTestFixture, RegisterChangesArePublishedOncePerRun)
+{
+    loadOpcodeIntoMemory(AbstractInstruction_e::INX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::INY, AddressMode_e::Implied);
+
+    std::vector<uint8_t> masks;
+    executor.setRegistersChangedDelegate([&masks](const Registers &, uint8_t changed) { masks.push_back(changed); });
+
+    executor.runInstructions(3);
+
+    // The unused status bit gets set by the first instruction too.
+    EXPECT_THAT(masks, ElementsAre(REG_X | REG_Y | REG_PC | REG_STATUS));
+
+    // Nothing has changed since, so there is nothing to publish.
+    executor.publishRegisterChanges();
+
+    EXPECT_THAT(masks.size(), Eq(1U));
+
+    // Without a subscriber, nothing is published at all.
+    executor.setRegistersChangedDelegate(nullptr);
+    executor.registers().program_counter = 0x8000;
+    executor.runInstructions(1);
+
+    EXPECT_THAT(masks.size(), Eq(1U));
+}
+
+TEST_F(InstructionExecutorTestFixture, FlagsAreExactAfterARunAndWhenPushed)
+{
+    // LDA #$80, PHP, LDA #$00
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDA, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x80;
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::PHP, AddressMode_e::Implied);
+    fakeMemory[0x8003] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    fakeMemory[0x8004] = 0x00;
+    executor.registers().stack_pointer = 0xFF;
+
+    executor.runInstructions(3);
+
+    EXPECT_THAT(fakeMemory[0x01FF], Eq(N | B | U));
+    EXPECT_THAT(executor.registers().status, Eq(Z | U));
+}
+
+TEST_F(InstructionExecutorTestFixture, PredecodedInstructionsAreNotReadAgain)
+{
+    std::array<uint8_t, 256> page {};
+
+    // DEX, BNE back to the DEX
+    page[0x00] = OpcodeFor(AbstractInstruction_e::DEX, AddressMode_e::Implied);
+    page[0x01] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    page[0x02] = 0xFD;
+    executor.mapPage(0x80, page.data(), page.data());
+    executor.registers().program_counter = 0x8000;
+    executor.registers().x = 10;
+    executor.setPredecode(true);
+    executor.runInstructions(2);
+
+    // Branching onto the next instruction instead, behind the executor's back, goes unseen.
+    page[0x02] = 0x00;
+
+    auto result = executor.runCycles(1000);
+
+    // The loop falls through onto the BRK after it.
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(executor.registers().x, Eq(0));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8003));
+}
+
+TEST_F(InstructionExecutorTestFixture, CodeOutsideMappedPagesIsReadEveryTimeItRuns)
+{
+    executor.setPredecode(true);
+
+    // DEX, BNE back to the DEX
+    loadOpcodeIntoMemory(AbstractInstruction_e::DEX, AddressMode_e::Implied, 0x8000);
+    fakeMemory[0x8001] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    fakeMemory[0x8002] = 0xFD;
+    executor.registers().x = 10;
+
+    auto result = executor.runCycles(1000);
+
+    EXPECT_THAT(result.reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(executor.registers().x, Eq(0));
+
+    // A device could have side effects on being read, so each pass reads the loop afresh.
+    EXPECT_THAT(std::count_if(readSignalsCaught.begin(), readSignalsCaught.end(),
+                              [](const ReadSignalValues &read) { return read.address == 0x8000; }),
+                Eq(10));
+}
+
+TEST_F(InstructionExecutorTestFixture, PredecodedInstructionsAreDecodedAgainWhenWritten)
+{
+    std::array<uint8_t, 256> page {};
+
+    // LDA #$01, INC $8001, JMP $8000
+    page[0x00] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    page[0x01] = 0x01;
+    page[0x02] = OpcodeFor(AbstractInstruction_e::INC, AddressMode_e::Absolute);
+    page[0x03] = 0x01;
+    page[0x04] = 0x80;
+    page[0x05] = OpcodeFor(AbstractInstruction_e::JMP, AddressMode_e::Absolute);
+    page[0x06] = 0x00;
+    page[0x07] = 0x80;
+    executor.mapPage(0x80, page.data(), page.data());
+    executor.registers().program_counter = 0x8000;
+    executor.setPredecode(true);
+
+    executor.runInstructions(1);
+
+    EXPECT_THAT(executor.registers().a, Eq(0x01));
+
+    executor.runInstructions(3);
+
+    EXPECT_THAT(executor.registers().a, Eq(0x02));
+
+    // Changes made behind the executor's back need invalidating explicitly.
+    page[0x01] = 0x42;
+    executor.invalidatePredecoded(0x8001);
+    executor.registers().program_counter = 0x8000;
+    executor.runInstructions(1);
+
+    EXPECT_THAT(executor.registers().a, Eq(0x42));
+}
+
+TEST_F(InstructionExecutorTestFixture, RecompiledLoopTakesExactlyTheSameCycles)
+{
+    if (!BlockRecompiler::available())
+        return;
+
+    std::array<uint8_t, 256> page {};
+
+    // LDX #$00, INX, BNE $8002
+    page[0x00] = OpcodeFor(AbstractInstruction_e::LDX, AddressMode_e::Immediate);
+    page[0x01] = 0x00;
+    page[0x02] = OpcodeFor(AbstractInstruction_e::INX, AddressMode_e::Implied);
+    page[0x03] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    page[0x04] = 0xFD;
+    executor.mapPage(0x80, page.data(), page.data());
+    executor.registers().program_counter = 0x8000;
+    executor.setRecompile(true);
+
+    // 2 cycles, then 5 for each pass round the loop.  The budget runs out
+    // part way through the 200th branch.
+    auto result = executor.runCycles(1000);
+
+    EXPECT_THAT(result.cycles, Eq(1000U));
+    EXPECT_THAT(result.instructions, Eq(401U));
+    EXPECT_THAT(executor.registers().x, Eq(200));
+    EXPECT_THAT(executor.remainingCyclesForInstruction(), Eq(2));
+
+    // The last pass doesn't branch, which takes 4 cycles.
+    result = executor.runCycles(281);
+
+    EXPECT_THAT(result.cycles, Eq(281U));
+    EXPECT_THAT(executor.clock_ticks, Eq(1281U));
+    EXPECT_THAT(executor.registers().x, Eq(0));
+    EXPECT_THAT(executor.registers().GetFlag(Z), Eq(1));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8005));
+    EXPECT_THAT(executor.complete(), Eq(true));
+}
+
+TEST_F(InstructionExecutorTestFixture, RecompiledCodeSeesItsOwnChanges)
+{
+    if (!BlockRecompiler::available())
+        return;
+
+    std::array<uint8_t, 256> page {};
+
+    // LDA #$00, INC $8001, JMP $8000
+    page[0x00] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    page[0x01] = 0x00;
+    page[0x02] = OpcodeFor(AbstractInstruction_e::INC, AddressMode_e::Absolute);
+    page[0x03] = 0x01;
+    page[0x04] = 0x80;
+    page[0x05] = OpcodeFor(AbstractInstruction_e::JMP, AddressMode_e::Absolute);
+    page[0x06] = 0x00;
+    page[0x07] = 0x80;
+    executor.mapPage(0x80, page.data(), page.data());
+    executor.registers().program_counter = 0x8000;
+    executor.setRecompile(true);
+
+    // 11 cycles a pass
+    executor.runCycles(100 * 11);
+
+    EXPECT_THAT(executor.registers().a, Eq(99));
+    EXPECT_THAT(page[0x01], Eq(100));
+    EXPECT_THAT(executor.registers().program_counter, Eq(0x8000));
+}
+
+TEST_F(InstructionExecutorTestFixture, RecompiledCodeCountsTheInstructionWhichWroteOverIt)
+{
+    if (!BlockRecompiler::available())
+        return;
+
+    std::array<uint8_t, 256> page {};
+
+    // LDA #$80, STA $8007, JMP $8000, where the STA writes the JMP's own operand
+    page[0x00] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    page[0x01] = 0x80;
+    page[0x02] = OpcodeFor(AbstractInstruction_e::STA, AddressMode_e::Absolute);
+    page[0x03] = 0x07;
+    page[0x04] = 0x80;
+    page[0x05] = OpcodeFor(AbstractInstruction_e::JMP, AddressMode_e::Absolute);
+    page[0x06] = 0x00;
+    page[0x07] = 0x80;
+    executor.mapPage(0x80, page.data(), page.data());
+
+    // 9 cycles and 3 instructions a pass, however it is run
+    for (bool recompile : { false, true })
+    {
+        executor.registers().program_counter = 0x8000;
+        executor.setRecompile(recompile);
+
+        auto result = executor.runCycles(100 * 9);
+
+        EXPECT_THAT(result.cycles, Eq(900U)) << recompile;
+        EXPECT_THAT(result.instructions, Eq(300U)) << recompile;
+
+        result = executor.runInstructions(300);
+
+        EXPECT_THAT(result.instructions, Eq(300U)) << recompile;
+        EXPECT_THAT(result.cycles, Eq(900U)) << recompile;
+        EXPECT_THAT(executor.registers().program_counter, Eq(0x8000)) << recompile;
+    }
+}
+
+TEST(InstructionExecutorTable, DescribesOpcodes)
+{
+    using Operation      = InstructionExecutor::Operation;
+    using AddressingMode = InstructionExecutor::AddressingMode;
+
+    EXPECT_THAT(InstructionExecutor::instructionFor(0xA9).operate,  Eq(Operation::LDA));
+    EXPECT_THAT(InstructionExecutor::instructionFor(0xA9).addrmode, Eq(AddressingMode::IMM));
+    EXPECT_THAT(InstructionExecutor::instructionFor(0xA9).cycles,   Eq(2));
+    EXPECT_THAT(InstructionExecutor::nameOf(0xA9), StrEq("LDA"));
+
+    EXPECT_THAT(InstructionExecutor::instructionFor(0xFF).operate,  Eq(Operation::XXX));
+    EXPECT_THAT(InstructionExecutor::nameOf(0xFF), StrEq("???"));
+}
@@ -0,0 +1,376 @@
+#include <gmock/gmock.h>
+#include "eventscheduler.hpp"
+#include "machine.hpp"
+
+using namespace testing;
+using InstructionSet = InstructionExecutor::InstructionSet;
+using StopReason     = InstructionExecutor::StopReason;
+
+namespace
+{
+enum class Mode { Interpret, Predecode, Recompile };
+
+const Mode modes[] = { Mode::Interpret, Mode::Predecode, Mode::Recompile };
+
+const InstructionSet instruction_sets[] = { InstructionSet::Nmos6502, InstructionSet::Cmos65C02, InstructionSet::Ricoh2A03 };
+
+void setUp(Machine &machine, InstructionSet set, Mode mode)
+{
+    machine.executor().setInstructionSet(set);
+    machine.executor().setPredecode(mode == Mode::Predecode);
+    machine.executor().setRecompile(mode == Mode::Recompile);
+}
+
+// Each of the 65C02's additions, ending with a JMP ($0400,X) to a BRK at $0280
+//
+//  $0200  LDX #$05
+//         PHX
+//         PLY
+//         LDA #$F0
+//         STA $10
+//         LDA #$0F
+//         TSB $10
+//         STZ $11
+//         LDA #$0C
+//         TRB $10
+//         INC A
+//         INC A
+//         STA $13
+//         SMB0 $12
+//         SMB7 $12
+//         RMB1 $12
+//         LDA ($20)
+//         BBR0 $12, to the BRK after the BRA
+//         BRA over the BRK
+//         BRK
+//         BBS0 $12, over the BRK
+//         BRK
+//         JMP ($0400,X)
+const std::vector<uint8_t> additions
+{
+    0xA2, 0x05, 0xDA, 0x7A, 0xA9, 0xF0, 0x85, 0x10, 0xA9, 0x0F, 0x04, 0x10, 0x64, 0x11, 0xA9, 0x0C,
+    0x14, 0x10, 0x1A, 0x1A, 0x85, 0x13, 0x87, 0x12, 0xF7, 0x12, 0x17, 0x12, 0xB2, 0x20, 0x0F, 0x12,
+    0x02, 0x80, 0x01, 0x00, 0x8F, 0x12, 0x01, 0x00, 0x7C, 0x00, 0x04
+};
+
+// SED / LDA #$99 / CLC / ADC #$01 / BRK
+const std::vector<uint8_t> decimal_addition { 0xF8, 0xA9, 0x99, 0x18, 0x69, 0x01, 0x00 };
+
+// WAI and STP programs run with an IRQ handler at $0500 which counts in Y,
+// and an NMI handler at $0510 which counts in $30.
+void loadHandlers(Machine &machine)
+{
+    machine.load(0x0500, { 0xC8, 0x40 });
+    machine.load(0x0510, { 0xE6, 0x30, 0x40 });
+    machine.poke(0xFFFA, 0x10);
+    machine.poke(0xFFFB, 0x05);
+    machine.poke(0xFFFE, 0x00);
+    machine.poke(0xFFFF, 0x05);
+}
+}
+
+TEST(InstructionSets, TheNamesAndLengthsComeFromTheirOwnTables)
+{
+    EXPECT_THAT(InstructionExecutor::nameOf(0xB2), StrEq("???"));
+    EXPECT_THAT(InstructionExecutor::nameOf(0xB2, InstructionSet::Cmos65C02), StrEq("LDA"));
+    EXPECT_THAT(InstructionExecutor::nameOf(0xCB, InstructionSet::Cmos65C02), StrEq("WAI"));
+    EXPECT_THAT(InstructionExecutor::nameOf(0x1F, InstructionSet::Cmos65C02), StrEq("BBR1"));
+    EXPECT_THAT(InstructionExecutor::instructionFor(0xB2, InstructionSet::Ricoh2A03).operate,
+                Eq(InstructionExecutor::Operation::XXX));
+
+    EXPECT_THAT(InstructionExecutor::lengthOf(0xB2, InstructionSet::Cmos65C02), Eq(2));
+    EXPECT_THAT(InstructionExecutor::lengthOf(0x7C, InstructionSet::Cmos65C02), Eq(3));
+    EXPECT_THAT(InstructionExecutor::lengthOf(0x0F, InstructionSet::Cmos65C02), Eq(3));
+    EXPECT_THAT(InstructionExecutor::lengthOf(0x5C, InstructionSet::Cmos65C02), Eq(3));
+    EXPECT_THAT(InstructionExecutor::lengthOf(0x03, InstructionSet::Cmos65C02), Eq(1));
+
+    for (int opcode = 0; opcode < 0x100; ++opcode)
+    {
+        EXPECT_THAT(InstructionExecutor::instructionFor(static_cast<uint8_t>(opcode), InstructionSet::Cmos65C02).operate,
+                    Ne(InstructionExecutor::Operation::XXX)) << std::hex << opcode;
+    }
+}
+
+TEST(InstructionSets, The65C02RunsItsOwnInstructions)
+{
+    for (Mode mode : modes)
+    {
+        Machine machine;
+
+        machine.load(0x0200, additions);
+        machine.poke(0x11, 0x77);
+        machine.poke(0x12, 0x02);
+        machine.poke(0x20, 0x00);
+        machine.poke(0x21, 0x03);
+        machine.poke(0x0300, 0x42);
+        machine.poke(0x0405, 0x80);
+        machine.poke(0x0406, 0x02);
+        machine.start(0x0200);
+        setUp(machine, InstructionSet::Cmos65C02, mode);
+
+        auto result = machine.run(1000);
+
+        EXPECT_THAT(result.reason, Eq(StopReason::Break));
+        EXPECT_THAT(machine.registers().program_counter, Eq(0x0280));
+        EXPECT_THAT(machine.registers().a, Eq(0x42));
+        EXPECT_THAT(machine.registers().x, Eq(0x05));
+        EXPECT_THAT(machine.registers().y, Eq(0x05));
+        EXPECT_THAT(machine.memory()[0x10], Eq(0xF3));
+        EXPECT_THAT(machine.memory()[0x11], Eq(0x00));
+        EXPECT_THAT(machine.memory()[0x12], Eq(0x81));
+        EXPECT_THAT(machine.memory()[0x13], Eq(0x0E));
+    }
+}
+
+TEST(InstructionSets, TheNmosChipsStopOnThe65C02sInstructions)
+{
+    for (InstructionSet set : { InstructionSet::Nmos6502, InstructionSet::Ricoh2A03 })
+    {
+        for (Mode mode : modes)
+        {
+            Machine machine;
+
+            // NOP / LDA ($20) / BRK
+            machine.load(0x0200, { 0xEA, 0xB2, 0x20, 0x00 });
+            machine.start(0x0200);
+            setUp(machine, set, mode);
+
+            auto result = machine.executor().runCycles(100);
+
+            EXPECT_THAT(result.reason, Eq(StopReason::IllegalOpcode));
+            EXPECT_THAT(machine.registers().program_counter, Eq(0x0201));
+        }
+    }
+}
+
+TEST(InstructionSets, OnlyThe65C02GetsIndirectJumpsAcrossAPageRight)
+{
+    for (InstructionSet set : instruction_sets)
+    {
+        for (Mode mode : modes)
+        {
+            Machine machine;
+
+            // JMP ($02FF)
+            machine.load(0x0400, { 0x6C, 0xFF, 0x02 });
+            machine.poke(0x02FF, 0x34);
+            machine.poke(0x0300, 0x12);
+            machine.poke(0x0200, 0x56);
+            machine.start(0x0400);
+            setUp(machine, set, mode);
+
+            auto result = machine.executor().runInstructions(1);
+            const bool fixed = (set == InstructionSet::Cmos65C02);
+
+            EXPECT_THAT(machine.registers().program_counter, Eq(fixed ? 0x1234 : 0x5634));
+            EXPECT_THAT(result.cycles, Eq(fixed ? 6U : 5U));
+        }
+    }
+}
+
+TEST(InstructionSets, OnlyThe65C02ShiftsByAbsoluteXInSixCyclesWithinAPage)
+{
+    // ASL, ROL, LSR, ROR, then DEC and INC, which take 7 on every chip
+    const uint8_t opcodes[] = { 0x1E, 0x3E, 0x5E, 0x7E, 0xDE, 0xFE };
+
+    for (InstructionSet set : instruction_sets)
+    {
+        for (Mode mode : modes)
+        {
+            for (uint8_t opcode : opcodes)
+            {
+                for (uint8_t x : { 0x01, 0x10 })
+                {
+                    Machine machine;
+
+                    // opcode $10F8,X, which crosses into $1100 when X is $10
+                    machine.load(0x0400, { opcode, 0xF8, 0x10 });
+                    machine.start(0x0400);
+                    machine.registers().x = x;
+                    setUp(machine, set, mode);
+
+                    auto result = machine.executor().runInstructions(1);
+                    const bool shift   = (opcode != 0xDE) && (opcode != 0xFE);
+                    const bool crosses = (x == 0x10);
+                    const unsigned expected = (shift && (set == InstructionSet::Cmos65C02)) ? (crosses ? 7U : 6U) : 7U;
+
+                    EXPECT_THAT(result.cycles, Eq(expected)) << static_cast<int>(set) << " " << static_cast<int>(mode)
+                                                             << " " << static_cast<int>(opcode) << " " << static_cast<int>(x);
+                }
+            }
+        }
+    }
+}
+
+TEST(InstructionSets, DecimalModeIsAsEachChipHasIt)
+{
+    for (InstructionSet set : instruction_sets)
+    {
+        for (Mode mode : modes)
+        {
+            Machine machine;
+
+            machine.load(0x0200, decimal_addition);
+            machine.start(0x0200);
+            setUp(machine, set, mode);
+
+            auto result = machine.executor().runInstructions(4);
+
+#ifdef INSTRUCTIONEXECUTOR_NO_DECIMAL_MODE
+            // Built without decimal mode, every chip adds in binary
+            EXPECT_THAT(machine.registers().a, Eq(0x9A)) << static_cast<int>(set);
+            EXPECT_THAT(machine.registers().status & (C | Z), Eq(0)) << static_cast<int>(set);
+            EXPECT_THAT(result.cycles, Eq(8U)) << static_cast<int>(set);
+#else
+            switch (set)
+            {
+            case InstructionSet::Nmos6502:
+                // Z comes from the binary sum
+                EXPECT_THAT(machine.registers().a, Eq(0x00));
+                EXPECT_THAT(machine.registers().status & (C | Z), Eq(C));
+                EXPECT_THAT(result.cycles, Eq(8U));
+                break;
+            case InstructionSet::Cmos65C02:
+                // Z is right, and it takes a cycle longer
+                EXPECT_THAT(machine.registers().a, Eq(0x00));
+                EXPECT_THAT(machine.registers().status & (C | Z), Eq(C | Z));
+                EXPECT_THAT(result.cycles, Eq(9U));
+                break;
+            case InstructionSet::Ricoh2A03:
+                // No decimal mode at all
+                EXPECT_THAT(machine.registers().a, Eq(0x9A));
+                EXPECT_THAT(machine.registers().status & (C | Z), Eq(0));
+                EXPECT_THAT(result.cycles, Eq(8U));
+                break;
+            }
+#endif
+        }
+    }
+}
+
+TEST(InstructionSets, The65C02ClearsDecimalModeOnInterrupts)
+{
+    for (InstructionSet set : instruction_sets)
+    {
+        Machine machine;
+
+        // SED / BRK, with the IRQ vector pointing at a NOP
+        machine.load(0x0200, { 0xF8, 0x00 });
+        machine.load(0x0500, { 0xEA });
+        machine.poke(0xFFFE, 0x00);
+        machine.poke(0xFFFF, 0x05);
+        machine.start(0x0200);
+        machine.executor().setInstructionSet(set);
+        machine.executor().runInstructions(1);
+        machine.executor().runInstructions(1);
+
+        EXPECT_THAT(machine.registers().program_counter, Eq(0x0500));
+        EXPECT_THAT(machine.registers().status & D, Eq((set == InstructionSet::Cmos65C02) ? 0 : D));
+    }
+}
+
+TEST(InstructionSets, WaiWaitsForAnInterrupt)
+{
+    uint64_t ticks = 0;
+
+    for (bool skip : { false, true })
+    {
+        for (Mode mode : modes)
+        {
+            Machine        machine;
+            EventScheduler scheduler;
+
+            // CLI / WAI / INX / BRK
+            loadHandlers(machine);
+            machine.load(0x0200, { 0x58, 0xCB, 0xE8, 0x00 });
+            machine.start(0x0200);
+            setUp(machine, InstructionSet::Cmos65C02, mode);
+            machine.executor().setScheduler(&scheduler);
+            machine.executor().setSkipIdleLoops(skip);
+            scheduler.schedule(1000, [&machine](uint64_t) { machine.executor().raiseIrq(); });
+            scheduler.schedule(1005, [&machine](uint64_t) { machine.executor().lowerIrq(); });
+
+            auto result = machine.executor().runCycles(5000);
+
+            EXPECT_THAT(result.reason, Eq(StopReason::Break));
+            EXPECT_THAT(machine.registers().program_counter, Eq(0x0203));
+            EXPECT_THAT(machine.registers().x, Eq(1));
+            EXPECT_THAT(machine.registers().y, Eq(1));
+
+            // Skipping the wait mustn't change when things happen
+            if (ticks == 0)
+                ticks = machine.executor().clock_ticks;
+            EXPECT_THAT(machine.executor().clock_ticks, Eq(ticks)) << "skip " << skip;
+        }
+    }
+}
+
+TEST(InstructionSets, WaiCarriesOnWhenTheIrqIsMasked)
+{
+    Machine        machine;
+    EventScheduler scheduler;
+
+    // SEI / WAI / INX / BRK
+    loadHandlers(machine);
+    machine.load(0x0200, { 0x78, 0xCB, 0xE8, 0x00 });
+    machine.start(0x0200);
+    machine.executor().setInstructionSet(InstructionSet::Cmos65C02);
+    machine.executor().setScheduler(&scheduler);
+    scheduler.schedule(1000, [&machine](uint64_t) { machine.executor().raiseIrq(); });
+
+    auto result = machine.executor().runCycles(5000);
+
+    EXPECT_THAT(result.reason, Eq(StopReason::Break));
+    EXPECT_THAT(machine.registers().x, Eq(1));
+    EXPECT_THAT(machine.registers().y, Eq(0));
+}
+
+TEST(InstructionSets, StpStopsUntilReset)
+{
+    Machine        machine;
+    EventScheduler scheduler;
+
+    // STP / INX
+    loadHandlers(machine);
+    machine.load(0x0200, { 0xDB, 0xE8 });
+    machine.poke(0xFFFC, 0x01);
+    machine.poke(0xFFFD, 0x02);
+    machine.start(0x0200);
+    machine.executor().setInstructionSet(InstructionSet::Cmos65C02);
+    machine.executor().setScheduler(&scheduler);
+    scheduler.schedule(500, [&machine](uint64_t) { machine.executor().raiseNmi(); });
+
+    auto result = machine.executor().runCycles(10000);
+
+    EXPECT_THAT(result.cycles, Eq(10000U));
+    EXPECT_TRUE(result.idle);
+    EXPECT_THAT(machine.registers().program_counter, Eq(0x0200));
+    EXPECT_THAT(machine.memory()[0x30], Eq(0));
+
+    // Reset starts it again, at the INX
+    machine.executor().reset();
+    machine.executor().runInstructions(1);
+
+    EXPECT_THAT(machine.registers().x, Eq(1));
+}
+
+TEST(InstructionSets, ChangingTheInstructionSetForgetsDecodedCode)
+{
+    Machine machine;
+
+    // NOP / LDA ($20) / BRK
+    machine.load(0x0200, { 0xEA, 0xB2, 0x20, 0x00 });
+    machine.poke(0x21, 0x03);
+    machine.poke(0x0300, 0x42);
+    machine.executor().setPredecode(true);
+
+    machine.start(0x0200);
+    machine.executor().setInstructionSet(InstructionSet::Cmos65C02);
+    EXPECT_THAT(machine.executor().runCycles(100).reason, Eq(StopReason::Break));
+    EXPECT_THAT(machine.registers().a, Eq(0x42));
+
+    machine.start(0x0200);
+    machine.executor().setInstructionSet(InstructionSet::Nmos6502);
+    EXPECT_THAT(machine.executor().runCycles(100).reason, Eq(StopReason::IllegalOpcode));
+    EXPECT_THAT(machine.executor().instructionSet(), Eq(InstructionSet::Nmos6502));
+}
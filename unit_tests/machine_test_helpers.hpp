@@ -0,0 +1,53 @@
+#ifndef MACHINE_TEST_HELPERS_HPP
+#define MACHINE_TEST_HELPERS_HPP
+
+#include <gmock/gmock.h>
+#include "machine.hpp"
+#include <cstdint>
+#include <vector>
+
+// Counts in memory, and in the operand of its own LDA:
+//
+//  $0200  LDX #$00
+//  $0202  INC $10
+//         INC $0300,X
+//         INC $020E
+//         INX
+//         BNE $0202
+//         LDA #$00
+//         STA $11
+//         JMP $0200
+const std::vector<uint8_t> counting
+{
+    0xA2, 0x00, 0xE6, 0x10, 0xFE, 0x00, 0x03, 0xEE, 0x0E, 0x02, 0xE8, 0xD0, 0xF5,
+    0xA9, 0x00, 0x85, 0x11, 0x4C, 0x00, 0x02
+};
+
+// Everything about a machine which a restore, rewind or replay has to get back
+struct Outcome
+{
+    uint64_t  clock_ticks;
+    Registers registers;
+    uint64_t  memory_digest;
+    uint64_t  instructions = 0; // Left at 0 unless the run's count matters
+};
+
+inline Outcome outcomeOf(Machine &machine)
+{
+    return { machine.executor().clock_ticks, machine.registers(), machine.memoryDigest() };
+}
+
+inline void expectSameOutcome(const Outcome &outcome, const Outcome &expected)
+{
+    EXPECT_THAT(outcome.clock_ticks, ::testing::Eq(expected.clock_ticks));
+    EXPECT_THAT(outcome.registers.a, ::testing::Eq(expected.registers.a));
+    EXPECT_THAT(outcome.registers.x, ::testing::Eq(expected.registers.x));
+    EXPECT_THAT(outcome.registers.y, ::testing::Eq(expected.registers.y));
+    EXPECT_THAT(outcome.registers.stack_pointer, ::testing::Eq(expected.registers.stack_pointer));
+    EXPECT_THAT(outcome.registers.program_counter, ::testing::Eq(expected.registers.program_counter));
+    EXPECT_THAT(outcome.registers.status, ::testing::Eq(expected.registers.status));
+    EXPECT_THAT(outcome.memory_digest, ::testing::Eq(expected.memory_digest));
+    EXPECT_THAT(outcome.instructions, ::testing::Eq(expected.instructions));
+}
+
+#endif // MACHINE_TEST_HELPERS_HPP
@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include "memorybus.hpp"
+#include "ramdevice.hpp"
+#include <memory>
+
+using namespace testing;
+
+namespace
+{
+// A single register, counting how often it is read
+class CounterDevice : public BusDevice
+{
+public:
+    explicit CounterDevice(addressType address) : BusDevice(address, address, true, true) {}
+
+    int reads = 0;
+    uint8_t value = 0;
+
+    void makeDirect() { notifyDirectPagesChanged(); }
+
+protected:
+    void    writeImplementation(addressType, uint8_t data) override { value = data; }
+    uint8_t readImplementation(addressType, bool) override { ++reads; return value; }
+};
+}
+
+TEST(MemoryBus, MostRecentlyAttachedDeviceWins)
+{
+    MemoryBus     bus;
+    RamDevice     ram;
+    CounterDevice counter(0x4016);
+
+    bus.attach(&ram);
+    bus.attach(&counter);
+    bus.write(0x4016, 0x12);
+    bus.write(0x4017, 0x34);
+
+    EXPECT_THAT(bus.deviceAt(0x4016), Eq(&counter));
+    EXPECT_THAT(bus.deviceAt(0x4017), Eq(&ram));
+    EXPECT_THAT(bus.read(0x4016, false), Eq(0x12));
+    EXPECT_THAT(counter.reads, Eq(1));
+    EXPECT_THAT(ram.memory()[0x4017], Eq(0x34));
+}
+
+TEST(MemoryBus, OnlyWholePagesOfMemoryAreDirect)
+{
+    MemoryBus     bus;
+    RamDevice     ram;
+    CounterDevice counter(0x4016);
+
+    bus.attach(&ram);
+    bus.attach(&counter);
+
+    EXPECT_THAT(bus.directReadPage(0x40), IsNull());
+    EXPECT_THAT(bus.directWritePage(0x40), IsNull());
+    EXPECT_THAT(bus.directReadPage(0x41), Eq(ram.memory().data() + 0x4100));
+    EXPECT_THAT(bus.directWritePage(0x00), Eq(ram.memory().data()));
+}
+
+TEST(MemoryBus, DestroyedDeviceDetachesItself)
+{
+    MemoryBus bus;
+    RamDevice ram;
+    int       changes = 0;
+
+    bus.setPageMapChanged([&changes]() { ++changes; });
+    bus.attach(&ram);
+    {
+        CounterDevice counter(0x4016);
+
+        bus.attach(&counter);
+        counter.makeDirect();
+        EXPECT_THAT(changes, Eq(3));
+    }
+    EXPECT_THAT(changes, Eq(4));
+    EXPECT_THAT(bus.deviceAt(0x4016), Eq(&ram));
+    EXPECT_THAT(bus.directReadPage(0x40), NotNull());
+}
+
+TEST(MemoryBus, DestroyedBusLetsGoOfItsDevices)
+{
+    RamDevice ram;
+    {
+        auto bus = std::make_unique<MemoryBus>();
+
+        bus->attach(&ram);
+    }
+    // Destroying the device afterwards mustn't touch the bus.
+}
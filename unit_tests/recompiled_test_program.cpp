@@ -0,0 +1,304 @@
+// Recompiled from test_program.bin by recompile6502. Do not edit.
+
+#include "recompiledcode.hpp"
+
+namespace
+{
+// The code each block was recompiled from, so it can be checked for at run time
+const uint8_t code[] =
+{
+    0xA2, 0xFF, 0x9A, 0xA9, 0x00, 0x85, 0x10, 0x85, 0x11, 0xA0, 0x00, 0x98, 0x20, 0x50, 0x80, 0x99,
+    0x00, 0x02, 0xC8, 0xD0, 0xF6, 0xA9, 0x00, 0x85, 0x20, 0xA9, 0x02, 0x85, 0x21, 0xA0, 0x00, 0x18,
+    0xB1, 0x20, 0x65, 0x10, 0x85, 0x10, 0xA5, 0x11, 0x69, 0x00, 0x85, 0x11, 0xC8, 0xD0, 0xF0, 0x08,
+    0x68, 0x85, 0x12, 0x06, 0x10, 0x26, 0x11, 0x20, 0x60, 0x80, 0x20, 0x60, 0x80, 0x20, 0x60, 0x80,
+    0x85, 0x13, 0xA9, 0x70, 0x85, 0x30, 0xA9, 0x80, 0x85, 0x31, 0x6C, 0x30, 0x00, 0x49, 0x5A, 0x38,
+    0xE9, 0x03, 0x60, 0xA9, 0x00, 0xEE, 0x61, 0x80, 0x60,
+};
+
+void block_8000(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $8000  LDX #$FF
+    cpu.tick(2);
+    cpu.x = cpu.nz(0xFF);
+
+    // $8002  TXS
+    cpu.tick(2);
+    cpu.stack_pointer = cpu.x;
+
+    // $8003  LDA #$00
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x00);
+
+    // $8005  STA $10
+    cpu.tick(3);
+    cpu.writeData(0x0010, cpu.a);
+
+    // $8007  STA $11
+    cpu.tick(3);
+    cpu.writeData(0x0011, cpu.a);
+
+    // $8009  LDY #$00
+    cpu.tick(2);
+    cpu.y = cpu.nz(0x00);
+    return cpu.leave(state, 0x800B);
+}
+
+void block_800B(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $800B  TYA
+    cpu.tick(2);
+    cpu.a = cpu.nz(cpu.y);
+
+    // $800C  JSR $8050
+    cpu.tick(6);
+    cpu.pushData(0x80);
+    cpu.pushData(0x0E);
+    return cpu.leave(state, 0x8050);
+}
+
+void block_800F(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $800F  STA $0200,Y
+    cpu.tick(5);
+    cpu.writeData(cpu.absoluteY(0x0200, false), cpu.a);
+
+    // $8012  INY
+    cpu.tick(2);
+    cpu.y = cpu.nz(cpu.y + 1);
+
+    // $8013  BNE $800B
+    cpu.tick(2);
+    if (!cpu.zero)
+    {
+        cpu.cycles += 1;
+        return cpu.leave(state, 0x800B);
+    }
+    return cpu.leave(state, 0x8015);
+}
+
+void block_8015(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $8015  LDA #$00
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x00);
+
+    // $8017  STA $20
+    cpu.tick(3);
+    cpu.writeData(0x0020, cpu.a);
+
+    // $8019  LDA #$02
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x02);
+
+    // $801B  STA $21
+    cpu.tick(3);
+    cpu.writeData(0x0021, cpu.a);
+
+    // $801D  LDY #$00
+    cpu.tick(2);
+    cpu.y = cpu.nz(0x00);
+    return cpu.leave(state, 0x801F);
+}
+
+void block_801F(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $801F  CLC
+    cpu.tick(2);
+    cpu.carry = false;
+
+    // $8020  LDA ($20),Y
+    cpu.tick(5);
+    cpu.a = cpu.nz(cpu.read(cpu.indirectY(0x20, true)));
+
+    // $8022  ADC $10
+    cpu.tick(3);
+    cpu.adc(cpu.read(0x0010));
+
+    // $8024  STA $10
+    cpu.tick(3);
+    cpu.writeData(0x0010, cpu.a);
+
+    // $8026  LDA $11
+    cpu.tick(3);
+    cpu.a = cpu.nz(cpu.read(0x0011));
+
+    // $8028  ADC #$00
+    cpu.tick(2);
+    cpu.adc(0x00);
+
+    // $802A  STA $11
+    cpu.tick(3);
+    cpu.writeData(0x0011, cpu.a);
+
+    // $802C  INY
+    cpu.tick(2);
+    cpu.y = cpu.nz(cpu.y + 1);
+
+    // $802D  BNE $801F
+    cpu.tick(2);
+    if (!cpu.zero)
+    {
+        cpu.cycles += 1;
+        return cpu.leave(state, 0x801F);
+    }
+    return cpu.leave(state, 0x802F);
+}
+
+void block_802F(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $802F  PHP
+    cpu.tick(3);
+    cpu.pushData(cpu.status() | B);
+    cpu.brk = false;
+
+    // $8030  PLA
+    cpu.tick(4);
+    cpu.a = cpu.nz(cpu.pull());
+
+    // $8031  STA $12
+    cpu.tick(3);
+    cpu.writeData(0x0012, cpu.a);
+
+    // $8033  ASL $10
+    cpu.tick(5);
+    cpu.writeData(0x0010, cpu.asl(cpu.read(0x0010)));
+
+    // $8035  ROL $11
+    cpu.tick(5);
+    cpu.writeData(0x0011, cpu.rol(cpu.read(0x0011)));
+
+    // $8037  JSR $8060
+    cpu.tick(6);
+    cpu.pushData(0x80);
+    cpu.pushData(0x39);
+    return cpu.leave(state, 0x8060);
+}
+
+void block_803A(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $803A  JSR $8060
+    cpu.tick(6);
+    cpu.pushData(0x80);
+    cpu.pushData(0x3C);
+    return cpu.leave(state, 0x8060);
+}
+
+void block_803D(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $803D  JSR $8060
+    cpu.tick(6);
+    cpu.pushData(0x80);
+    cpu.pushData(0x3F);
+    return cpu.leave(state, 0x8060);
+}
+
+void block_8040(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $8040  STA $13
+    cpu.tick(3);
+    cpu.writeData(0x0013, cpu.a);
+
+    // $8042  LDA #$70
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x70);
+
+    // $8044  STA $30
+    cpu.tick(3);
+    cpu.writeData(0x0030, cpu.a);
+
+    // $8046  LDA #$80
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x80);
+
+    // $8048  STA $31
+    cpu.tick(3);
+    cpu.writeData(0x0031, cpu.a);
+
+    // $804A  JMP ($0030)
+    cpu.tick(5);
+    return cpu.leave(state, cpu.indirect(0x0030));
+}
+
+void block_8050(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $8050  EOR #$5A
+    cpu.tick(2);
+    cpu.a = cpu.nz(cpu.a ^ 0x5A);
+
+    // $8052  SEC
+    cpu.tick(2);
+    cpu.carry = true;
+
+    // $8053  SBC #$03
+    cpu.tick(2);
+    cpu.sbc(0x03);
+
+    // $8055  RTS
+    cpu.tick(6);
+    {
+        const uint16_t low = cpu.pull();
+
+        return cpu.leave(state, static_cast<uint16_t>(((cpu.pull() << 8) | low) + 1));
+    }
+}
+
+void block_8060(RecompiledState &state)
+{
+    RecompiledCpu cpu(state);
+
+    // $8060  LDA #$00
+    cpu.tick(2);
+    cpu.a = cpu.nz(0x00);
+
+    // $8062  INC $8061
+    cpu.tick(6);
+    cpu.write(0x8061, cpu.nz(cpu.read(0x8061) + 1));
+    if (cpu.stopped())
+        return cpu.leave(state, 0x8065);
+
+    // $8065  RTS
+    cpu.tick(6);
+    {
+        const uint16_t low = cpu.pull();
+
+        return cpu.leave(state, static_cast<uint16_t>(((cpu.pull() << 8) | low) + 1));
+    }
+}
+
+const RecompiledBlock blocks[] =
+{
+    { 0x8000, 11, code + 0, &block_8000 },
+    { 0x800B, 4, code + 11, &block_800B },
+    { 0x800F, 6, code + 15, &block_800F },
+    { 0x8015, 10, code + 21, &block_8015 },
+    { 0x801F, 16, code + 31, &block_801F },
+    { 0x802F, 11, code + 47, &block_802F },
+    { 0x803A, 3, code + 58, &block_803A },
+    { 0x803D, 3, code + 61, &block_803D },
+    { 0x8040, 13, code + 64, &block_8040 },
+    { 0x8050, 6, code + 77, &block_8050 },
+    { 0x8060, 6, code + 83, &block_8060 },
+};
+}
+
+extern const RecompiledProgram test_program = { blocks, 11 };
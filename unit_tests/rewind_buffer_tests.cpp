@@ -0,0 +1,113 @@
+#include <gmock/gmock.h>
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+#include "rewindbuffer.hpp"
+
+using namespace testing;
+
+namespace
+{
+void setUp(Machine &machine, bool predecode)
+{
+    machine.load(0x0200, counting);
+    machine.start(0x0200);
+    machine.executor().setPredecode(predecode);
+}
+
+// What a machine which was never rewound looks like at clock_ticks
+Outcome outcomeAt(uint64_t clock_ticks)
+{
+    Machine machine;
+
+    setUp(machine, false);
+    while (machine.executor().clock_ticks < clock_ticks)
+        machine.executor().runCycles(clock_ticks - machine.executor().clock_ticks);
+    return outcomeOf(machine);
+}
+}
+
+TEST(RewindBuffer, TakesACheckpointEveryInterval)
+{
+    Machine      machine;
+    RewindBuffer rewind(1000, 1 << 20);
+
+    setUp(machine, false);
+    rewind.run(machine, 10000);
+
+    // Runs finish their last instruction, so checkpoints can be a few cycles late
+    EXPECT_THAT(rewind.checkpoints(), AllOf(Ge(10U), Le(11U)));
+    EXPECT_THAT(rewind.oldest(), Eq(0U));
+    EXPECT_THAT(machine.executor().clock_ticks - rewind.newest(), Lt(1000U));
+}
+
+TEST(RewindBuffer, GoesBackToExactlyHowTheMachineWas)
+{
+    for (bool predecode : { false, true })
+    {
+        Machine      machine;
+        RewindBuffer rewind(1000, 1 << 20);
+
+        setUp(machine, predecode);
+        rewind.run(machine, 100000);
+
+        for (uint64_t clock_ticks : { 99999U, 64000U, 50001U, 12345U, 777U, 0U })
+        {
+            ASSERT_TRUE(rewind.rewindTo(machine, clock_ticks));
+            expectSameOutcome(outcomeOf(machine), outcomeAt(clock_ticks));
+            EXPECT_THAT(rewind.newest(), Le(clock_ticks));
+        }
+    }
+}
+
+TEST(RewindBuffer, RunsOnFromWhereItWentBackTo)
+{
+    Machine      machine;
+    RewindBuffer rewind(500, 1 << 20);
+
+    setUp(machine, true);
+    rewind.run(machine, 30000);
+
+    const uint64_t then = machine.executor().clock_ticks;
+
+    ASSERT_TRUE(rewind.stepBack(machine, 20000));
+    EXPECT_THAT(machine.executor().clock_ticks, Eq(then - 20000));
+
+    rewind.run(machine, 40000);
+
+    const uint64_t now = machine.executor().clock_ticks;
+
+    ASSERT_TRUE(rewind.stepBack(machine, 1234));
+    expectSameOutcome(outcomeOf(machine), outcomeAt(now - 1234));
+}
+
+TEST(RewindBuffer, CheckpointsOnlyKeepWhatChanged)
+{
+    Machine      machine;
+    RewindBuffer rewind(1000, 1 << 20);
+
+    setUp(machine, false);
+    rewind.run(machine, 100000);
+
+    // Three pages change between each, but only a few dozen bytes of them
+    EXPECT_THAT(rewind.size(), Lt(rewind.checkpoints() * 256));
+}
+
+TEST(RewindBuffer, ForgetsTheOldestToStayWithinItsBudget)
+{
+    Machine      machine;
+    RewindBuffer rewind(100, 4096);
+
+    setUp(machine, false);
+    rewind.run(machine, 1000000);
+
+    EXPECT_THAT(rewind.size(), Le(4096U));
+    EXPECT_THAT(rewind.oldest(), Gt(0U));
+    EXPECT_FALSE(rewind.rewindTo(machine, rewind.oldest() - 1));
+    EXPECT_FALSE(rewind.rewindTo(machine, machine.executor().clock_ticks + 1));
+
+    const uint64_t oldest = rewind.oldest();
+
+    ASSERT_TRUE(rewind.rewindTo(machine, oldest));
+    expectSameOutcome(outcomeOf(machine), outcomeAt(oldest));
+    EXPECT_THAT(rewind.checkpoints(), Eq(1U));
+}
@@ -0,0 +1,225 @@
+#include <gmock/gmock.h>
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+#include "pagedmemory.hpp"
+
+using namespace testing;
+
+namespace
+{
+enum class Mode { Interpret, Predecode, Recompile };
+
+const Mode modes[] = { Mode::Interpret, Mode::Predecode, Mode::Recompile };
+
+void setUp(Machine &machine, Mode mode)
+{
+    machine.load(0x0200, counting);
+    machine.start(0x0200);
+    machine.executor().setPredecode(mode == Mode::Predecode);
+    machine.executor().setRecompile(mode == Mode::Recompile);
+}
+}
+
+TEST(PagedMemory, CopiesShareEveryPageUntilItIsWrittenTo)
+{
+    PagedMemory memory;
+
+    memory[0x1234] = 0x56;
+
+    PagedMemory copy(memory);
+
+    EXPECT_TRUE(copy.shared(0x12));
+    EXPECT_THAT(copy.readPage(0x12), Eq(memory.readPage(0x12)));
+
+    copy[0x1235] = 0x78;
+
+    EXPECT_FALSE(copy.shared(0x12));
+    EXPECT_FALSE(copy.samePage(memory, 0x12));
+    EXPECT_TRUE(copy.samePage(memory, 0x13));
+    EXPECT_THAT(copy[0x1234], Eq(0x56));
+    EXPECT_THAT(copy[0x1235], Eq(0x78));
+    EXPECT_THAT(static_cast<const PagedMemory &>(memory)[0x1235], Eq(0x00));
+}
+
+TEST(PagedMemory, TellsOfPagesWhoseMemoryChanged)
+{
+    PagedMemory          memory;
+    std::vector<uint8_t> changed;
+
+    memory.setPageChanged([&changed](uint8_t page) { changed.push_back(page); });
+
+    // Every page starts out shared, so the first write to each copies it.
+    memory[0x0010] = 0x01;
+    memory[0x0011] = 0x02;
+    memory[0x0300] = 0x03;
+    EXPECT_THAT(changed, ElementsAre(0x00, 0x03));
+
+    // Those are the only pages it holds alone, so only they are told of when it is copied.
+    changed.clear();
+
+    PagedMemory saved(memory);
+
+    EXPECT_THAT(changed, ElementsAre(0x00, 0x03));
+
+    changed.clear();
+    memory[0x0012] = 0x04;
+    memory[0x0013] = 0x05;
+    EXPECT_THAT(changed, ElementsAre(0x00));
+
+    changed.clear();
+    memory = saved;
+    EXPECT_THAT(changed, ElementsAre(0x00));
+    EXPECT_THAT(static_cast<const PagedMemory &>(memory)[0x0012], Eq(0x00));
+}
+
+TEST(Snapshots, RestoringOneRunsTheSameAgain)
+{
+    for (Mode mode : modes)
+    {
+        Machine machine;
+
+        setUp(machine, mode);
+        machine.run(10000);
+
+        const Machine::Snapshot snapshot = machine.snapshot();
+
+        machine.run(25000);
+
+        const Outcome expected = outcomeOf(machine);
+
+        for (int again = 0; again < 3; ++again)
+        {
+            machine.restore(snapshot);
+            machine.run(25000);
+            expectSameOutcome(outcomeOf(machine), expected);
+        }
+    }
+}
+
+TEST(Snapshots, AreUntouchedByWhatHappensAfterThem)
+{
+    Machine machine;
+
+    setUp(machine, Mode::Predecode);
+    machine.run(5000);
+
+    const Machine::Snapshot snapshot = machine.snapshot();
+    const uint64_t          digest   = machine.memoryDigest();
+    const uint8_t           counter  = snapshot.memory[0x0010];
+
+    machine.run(5000);
+    machine.poke(0x8000, 0xFF);
+
+    EXPECT_THAT(snapshot.memory[0x0010], Eq(counter));
+    EXPECT_THAT(snapshot.memory[0x8000], Eq(0x00));
+    EXPECT_THAT(machine.memory()[0x0010], Ne(counter));
+
+    machine.restore(snapshot);
+
+    EXPECT_THAT(machine.memoryDigest(), Eq(digest));
+    EXPECT_THAT(machine.registers().program_counter, Eq(snapshot.registers.program_counter));
+    EXPECT_THAT(machine.executor().clock_ticks, Eq(snapshot.executor.clock_ticks));
+}
+
+TEST(Snapshots, CopiesOfMemoryAreUntouchedByWhatHappensAfterThem)
+{
+    for (Mode mode : modes)
+    {
+        Machine machine;
+
+        setUp(machine, mode);
+        machine.run(5000);
+
+        const PagedMemory copy    = machine.memory();
+        const uint8_t     counter = copy[0x0010];
+
+        machine.run(5000);
+
+        EXPECT_THAT(copy[0x0010], Eq(counter));
+        EXPECT_THAT(machine.memory()[0x0010], Ne(counter));
+    }
+}
+
+TEST(Snapshots, OnlyThePagesWrittenToAreCopied)
+{
+    Machine machine;
+
+    setUp(machine, Mode::Interpret);
+
+    const Machine::Snapshot snapshot = machine.snapshot();
+
+    machine.run(5000);
+
+    for (unsigned page = 0; page < 0x100; ++page)
+    {
+        const bool written = (page == 0x00) || (page == 0x02) || (page == 0x03);
+
+        EXPECT_THAT(machine.memory().samePage(snapshot.memory, static_cast<uint8_t>(page)), Ne(written)) << page;
+    }
+}
+
+TEST(Snapshots, PagesAreWrittenDirectlyAgainOnceNothingSharesThem)
+{
+    Machine machine;
+
+    setUp(machine, Mode::Interpret);
+    machine.run(5000);
+
+    {
+        const Machine::Snapshot snapshot = machine.snapshot();
+
+        EXPECT_FALSE(machine.executor().writesDirectly(0x00));
+    }
+
+    // Nothing had to copy the pages, since the snapshot let go of them first
+    machine.run(5000);
+
+    for (uint8_t page : { 0x00, 0x02, 0x03 })
+        EXPECT_TRUE(machine.executor().writesDirectly(page)) << static_cast<int>(page);
+}
+
+TEST(Snapshots, CanBeTakenPartWayThroughAnInstruction)
+{
+    Machine machine;
+
+    setUp(machine, Mode::Interpret);
+    machine.run(1000);
+
+    // INC $0300,X takes 7 cycles
+    while (machine.registers().program_counter != 0x0204)
+        machine.executor().runInstructions(1);
+    machine.executor().clock();
+    machine.executor().clock();
+    ASSERT_FALSE(machine.executor().complete());
+
+    const Machine::Snapshot snapshot = machine.snapshot();
+
+    for (int cycle = 0; cycle < 100; ++cycle)
+        machine.executor().clock();
+
+    const Outcome expected = outcomeOf(machine);
+
+    machine.restore(snapshot);
+    EXPECT_THAT(machine.executor().remainingCyclesForInstruction(), Eq(snapshot.executor.cycles));
+    for (int cycle = 0; cycle < 100; ++cycle)
+        machine.executor().clock();
+    expectSameOutcome(outcomeOf(machine), expected);
+}
+
+TEST(Snapshots, IncludeTheInterruptLines)
+{
+    Machine machine;
+
+    setUp(machine, Mode::Interpret);
+    machine.executor().raiseIrq(3);
+    machine.executor().raiseNmi();
+
+    const Machine::Snapshot snapshot = machine.snapshot();
+
+    machine.executor().lowerIrq(3);
+    machine.run(100);
+    machine.restore(snapshot);
+
+    EXPECT_TRUE(machine.executor().irqLine());
+    EXPECT_TRUE(machine.executor().state().nmi_pending);
+}
@@ -0,0 +1,155 @@
+#include <gmock/gmock.h>
+#include <unordered_map>
+#include "machine.hpp"
+#include "machine_test_helpers.hpp"
+#include "pagedmemory.hpp"
+
+using namespace testing;
+
+namespace
+{
+// The same contents, written one byte at a time through write()
+uint64_t hashOfContents(const PagedMemory &memory)
+{
+    PagedMemory copy;
+
+    for (unsigned address = 0; address < 0x10000; ++address)
+        copy.write(static_cast<uint16_t>(address), memory[static_cast<uint16_t>(address)]);
+    return copy.hash();
+}
+}
+
+TEST(StateHash, OfMemoryIsKeptUpToDateHoweverItIsWritten)
+{
+    PagedMemory memory;
+
+    EXPECT_THAT(memory.hash(), Eq(0U));
+
+    memory.write(0x1234, 0x56);
+    EXPECT_THAT(memory.hash(), Eq(PagedMemory::keyOf(0x1234, 0x56)));
+    memory.write(0x1234, 0x00);
+    EXPECT_THAT(memory.hash(), Eq(0U));
+
+    for (unsigned step = 0; step < 1000; ++step)
+        memory.write(static_cast<uint16_t>(step * 97), static_cast<uint8_t>(step));
+    EXPECT_THAT(memory.hash(), Eq(hashOfContents(memory)));
+
+    // Through a pointer, which is seen until the page is hashed again
+    uint8_t *page = memory.writablePage(0x40);
+
+    page[0x10] = 0x99;
+    EXPECT_THAT(memory.hash(), Eq(hashOfContents(memory)));
+    page[0x11] = 0x98;
+    memory[0x4012] = 0x97;
+    EXPECT_THAT(memory.hash(), Eq(hashOfContents(memory)));
+    memory.hashPages();
+    memory.write(0x4013, 0x96);
+    EXPECT_THAT(memory.hash(), Eq(hashOfContents(memory)));
+
+    // Copies and assignments take the hash with them
+    PagedMemory copy(memory);
+
+    copy.write(0x4013, 0x00);
+    EXPECT_THAT(copy.hash(), Eq(hashOfContents(copy)));
+    EXPECT_THAT(copy.hash(), Ne(memory.hash()));
+    copy = memory;
+    EXPECT_THAT(copy.hash(), Eq(memory.hash()));
+
+    memory.fill(0xAA);
+    EXPECT_THAT(memory.hash(), Eq(hashOfContents(memory)));
+}
+
+TEST(StateHash, IsTheSameHoweverTheMachineGotThere)
+{
+    uint64_t expected = 0;
+
+    for (bool hash_writes : { false, true })
+    {
+        for (bool predecode : { false, true })
+        {
+            Machine machine;
+
+            machine.setHashWrites(hash_writes);
+            machine.load(0x0200, counting);
+            machine.start(0x0200);
+            machine.executor().setPredecode(predecode);
+            machine.run(20000);
+            machine.snapshot();
+            machine.run(20000);
+
+            if (expected == 0)
+                expected = machine.stateHash();
+            EXPECT_THAT(machine.stateHash(), Eq(expected)) << hash_writes << predecode;
+        }
+    }
+}
+
+TEST(StateHash, IsKeptUpToDateOnceAskedFor)
+{
+    Machine machine;
+
+    machine.load(0x0200, counting);
+    machine.start(0x0200);
+    machine.run(5000);
+
+    const Machine::Snapshot start = machine.snapshot();
+
+    EXPECT_FALSE(machine.hashWrites());
+    machine.stateHash();
+    EXPECT_TRUE(machine.hashWrites());
+
+    machine.run(5000);
+    machine.restore(start);
+    machine.run(5000);
+
+    EXPECT_TRUE(machine.memory().hashed());
+    for (unsigned page = 0; page < 0x100; ++page)
+        EXPECT_FALSE(machine.executor().writesDirectly(static_cast<uint8_t>(page))) << page;
+
+    machine.setHashWrites(false);
+    machine.run(5000);
+    EXPECT_TRUE(machine.executor().writesDirectly(0x00));
+}
+
+TEST(StateHash, TellsStatesApart)
+{
+    Machine machine;
+
+    machine.load(0x0200, counting);
+    machine.start(0x0200);
+
+    const Machine::Snapshot start = machine.snapshot();
+    const uint64_t          hash  = machine.stateHash();
+
+    machine.poke(0x8000, 0x01);
+    EXPECT_THAT(machine.stateHash(), Ne(hash));
+    machine.poke(0x8000, 0x00);
+    EXPECT_THAT(machine.stateHash(), Eq(hash));
+
+    machine.registers().y = 1;
+    EXPECT_THAT(machine.stateHash(), Ne(hash));
+    machine.registers().y = 0;
+
+    machine.run(5000);
+    EXPECT_THAT(machine.stateHash(), Ne(hash));
+    machine.restore(start);
+    EXPECT_THAT(machine.stateHash(), Eq(hash));
+}
+
+TEST(StateHash, FindsWhereAProgramStartsGoingRoundInCircles)
+{
+    Machine                                machine;
+    std::unordered_map<uint64_t, uint64_t> seen; // When each state was first seen
+
+    // LDX #$00 / INX / BNE -3 / INC $10 / JMP $0200, which repeats once $10 wraps
+    machine.load(0x0200, { 0xA2, 0x00, 0xE8, 0xD0, 0xFD, 0xE6, 0x10, 0x4C, 0x00, 0x02 });
+    machine.start(0x0200);
+
+    uint64_t instructions = 0;
+
+    while (seen.emplace(machine.stateHash(), instructions).second)
+        instructions += machine.executor().runInstructions(1).instructions;
+
+    // 256 passes of the inner loop, then the INC and the JMP, 256 times over
+    EXPECT_THAT(instructions - seen[machine.stateHash()], Eq(256U * (1 + 2 * 256 + 2)));
+}
@@ -0,0 +1,185 @@
+#include <gmock/gmock.h>
+#include "recompiledrunner.hpp"
+#include "staticrecompiler.hpp"
+#include <algorithm>
+#include <array>
+#include <sstream>
+
+using namespace testing;
+
+// recompiled_test_program.cpp is this image, loaded at $8000, put through
+//
+//     recompile6502 --name test_program --entry 8000 test_program.bin 8000 recompiled_test_program.cpp
+extern const RecompiledProgram test_program;
+
+namespace
+{
+const std::vector<uint8_t> test_program_image =
+{
+    0xA2, 0xFF,             // $8000  LDX #$FF
+    0x9A,                   // $8002  TXS
+    0xA9, 0x00,             // $8003  LDA #$00
+    0x85, 0x10,             // $8005  STA $10
+    0x85, 0x11,             // $8007  STA $11
+    0xA0, 0x00,             // $8009  LDY #$00
+    0x98,                   // $800B  TYA
+    0x20, 0x50, 0x80,       // $800C  JSR $8050
+    0x99, 0x00, 0x02,       // $800F  STA $0200,Y
+    0xC8,                   // $8012  INY
+    0xD0, 0xF6,             // $8013  BNE $800B
+    0xA9, 0x00,             // $8015  LDA #$00
+    0x85, 0x20,             // $8017  STA $20
+    0xA9, 0x02,             // $8019  LDA #$02
+    0x85, 0x21,             // $801B  STA $21
+    0xA0, 0x00,             // $801D  LDY #$00
+    0x18,                   // $801F  CLC
+    0xB1, 0x20,             // $8020  LDA ($20),Y
+    0x65, 0x10,             // $8022  ADC $10
+    0x85, 0x10,             // $8024  STA $10
+    0xA5, 0x11,             // $8026  LDA $11
+    0x69, 0x00,             // $8028  ADC #$00
+    0x85, 0x11,             // $802A  STA $11
+    0xC8,                   // $802C  INY
+    0xD0, 0xF0,             // $802D  BNE $801F
+    0x08,                   // $802F  PHP
+    0x68,                   // $8030  PLA
+    0x85, 0x12,             // $8031  STA $12
+    0x06, 0x10,             // $8033  ASL $10
+    0x26, 0x11,             // $8035  ROL $11
+    0x20, 0x60, 0x80,       // $8037  JSR $8060
+    0x20, 0x60, 0x80,       // $803A  JSR $8060
+    0x20, 0x60, 0x80,       // $803D  JSR $8060
+    0x85, 0x13,             // $8040  STA $13
+    0xA9, 0x70,             // $8042  LDA #$70
+    0x85, 0x30,             // $8044  STA $30
+    0xA9, 0x80,             // $8046  LDA #$80
+    0x85, 0x31,             // $8048  STA $31
+    0x6C, 0x30, 0x00,       // $804A  JMP ($0030)
+    0x00, 0x00, 0x00,
+    0x49, 0x5A,             // $8050  EOR #$5A
+    0x38,                   // $8052  SEC
+    0xE9, 0x03,             // $8053  SBC #$03
+    0x60,                   // $8055  RTS
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xA9, 0x00,             // $8060  LDA #$00     The operand counts the calls...
+    0xEE, 0x61, 0x80,       // $8062  INC $8061    ...by changing the code
+    0x60,                   // $8065  RTS
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xE8,                   // $8070  INX          Only reached through the indirect jump
+    0x86, 0x14,             // $8071  STX $14
+    0x00                    // $8073  BRK
+};
+
+std::vector<uint16_t> blockStarts(const std::vector<StaticRecompiler::Block> &blocks)
+{
+    std::vector<uint16_t> starts;
+
+    for (const auto &block : blocks)
+        starts.push_back(block.start);
+    return starts;
+}
+}
+
+TEST(StaticRecompiler, FollowsBranchesJumpsAndCalls)
+{
+    StaticRecompiler recompiler(test_program_image, 0x8000);
+
+    recompiler.addEntryPoint(0x8000);
+
+    EXPECT_THAT(blockStarts(recompiler.analyse()),
+                ElementsAre(0x8000, 0x800B, 0x800F, 0x8015, 0x801F, 0x802F,
+                            0x803A, 0x803D, 0x8040, 0x8050, 0x8060));
+}
+
+TEST(StaticRecompiler, StopsBeforeBreak)
+{
+    StaticRecompiler recompiler({ 0xE8, 0x00, 0xE8 }, 0x0400); // INX, BRK, INX
+
+    recompiler.addEntryPoint(0x0400);
+
+    ASSERT_THAT(recompiler.analyse().size(), Eq(1U));
+    EXPECT_THAT(recompiler.analyse()[0].length, Eq(1));
+}
+
+TEST(StaticRecompiler, StartsFromTheVectors)
+{
+    std::vector<uint8_t> image(0x100, 0xEA);
+
+    // The NMI, reset and IRQ routines each jump back to themselves.
+    for (uint8_t offset : { 0x00, 0x10, 0x20 })
+    {
+        image[offset]     = 0x4C;
+        image[offset + 1] = offset;
+        image[offset + 2] = 0xFF;
+    }
+    image[0xFA] = 0x00; image[0xFB] = 0xFF;
+    image[0xFC] = 0x10; image[0xFD] = 0xFF;
+    image[0xFE] = 0x20; image[0xFF] = 0xFF;
+
+    StaticRecompiler recompiler(image, 0xFF00);
+
+    EXPECT_THAT(recompiler.addVectorEntryPoints(), Eq(3));
+    EXPECT_THAT(blockStarts(recompiler.analyse()), ElementsAre(0xFF00, 0xFF10, 0xFF20));
+
+    std::ostringstream source;
+
+    recompiler.generate(source, "vectors", "vectors.bin");
+
+    EXPECT_THAT(source.str(), HasSubstr("extern const RecompiledProgram vectors = { blocks, 3 };"));
+}
+
+TEST(RecompiledRunner, EndsUpWhereTheInterpreterDoes)
+{
+    std::array<uint8_t, 0x10000> interpreted_memory {};
+    std::array<uint8_t, 0x10000> recompiled_memory {};
+    Registers interpreted_registers, recompiled_registers;
+
+    std::copy(test_program_image.begin(), test_program_image.end(), interpreted_memory.begin() + 0x8000);
+    recompiled_memory = interpreted_memory;
+    interpreted_registers.program_counter = recompiled_registers.program_counter = 0x8000;
+
+    InstructionExecutor interpreter(interpreted_registers,
+                                    [&](uint16_t address, bool) { return interpreted_memory[address]; },
+                                    [&](uint16_t address, uint8_t data) { interpreted_memory[address] = data; });
+    RecompiledRunner runner(test_program, recompiled_registers, recompiled_memory.data());
+
+    auto expected = interpreter.runCycles(1000000);
+    auto result = runner.run(1000000);
+
+    ASSERT_THAT(expected.reason, Eq(InstructionExecutor::StopReason::Break));
+    EXPECT_THAT(result.reason, Eq(expected.reason));
+    EXPECT_THAT(result.cycles, Eq(expected.cycles));
+    EXPECT_THAT(result.instructions, Eq(expected.instructions));
+    EXPECT_THAT(recompiled_registers.a, Eq(interpreted_registers.a));
+    EXPECT_THAT(recompiled_registers.x, Eq(interpreted_registers.x));
+    EXPECT_THAT(recompiled_registers.y, Eq(interpreted_registers.y));
+    EXPECT_THAT(recompiled_registers.stack_pointer, Eq(interpreted_registers.stack_pointer));
+    EXPECT_THAT(recompiled_registers.program_counter, Eq(0x8073));
+    EXPECT_THAT(recompiled_registers.status, Eq(interpreted_registers.status));
+    EXPECT_THAT(recompiled_memory == interpreted_memory, Eq(true));
+
+    // The code counting calls to it wrote over itself, so it was dropped.
+    EXPECT_THAT(recompiled_memory[0x13], Eq(2));
+    EXPECT_THAT(runner.recompiledAt(0x8000), Eq(true));
+    EXPECT_THAT(runner.recompiledAt(0x8060), Eq(false));
+    EXPECT_THAT(runner.recompiledAt(0x8070), Eq(false));
+
+    // Nor do later writes to it have to look for blocks to drop.
+    EXPECT_THAT(runner.watchesWritesTo(0x8000), Eq(true));
+    EXPECT_THAT(runner.watchesWritesTo(0x8061), Eq(false));
+    EXPECT_THAT(runner.watchesWritesTo(0x8065), Eq(false));
+}
+
+TEST(RecompiledRunner, LeavesCodeThatDoesNotMatchToTheInterpreter)
+{
+    std::array<uint8_t, 0x10000> memory {};
+    Registers registers;
+
+    std::copy(test_program_image.begin(), test_program_image.end(), memory.begin() + 0x8000);
+    memory[0x8054] = 0x04; // SBC #$04 instead
+
+    RecompiledRunner runner(test_program, registers, memory.data());
+
+    EXPECT_THAT(runner.recompiledAt(0x8000), Eq(true));
+    EXPECT_THAT(runner.recompiledAt(0x8050), Eq(false));
+}
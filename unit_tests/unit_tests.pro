@@ -16,7 +16,8 @@ HEADERS += \
     addressing_mode_helpers.hpp \
     instruction_checks.hpp \
     instruction_definitions.hpp \
-    instruction_helpers.hpp
+    instruction_helpers.hpp \
+    machine_test_helpers.hpp
 
 SOURCES += \
         6502_tests.cpp \
@@ -69,6 +70,15 @@ SOURCES += \
         accumulator_mode_ROL.cpp \
         accumulator_mode_ROR.cpp \
         addressing_mode_helpers.cpp \
+        batch_executor_tests.cpp \
+        clock_pacer_tests.cpp \
+        decimal_mode_tests.cpp \
+        emulation_thread_tests.cpp \
+        event_scheduler_tests.cpp \
+        fleet_runner_tests.cpp \
+        fork_tests.cpp \
+        fused_instruction_tests.cpp \
+        idle_loop_tests.cpp \
         immediate_mode_ADC.cpp \
         immediate_mode_AND.cpp \
         immediate_mode_CMP.cpp \
@@ -110,8 +120,12 @@ SOURCES += \
         indirect_y_indexed_LDA.cpp \
         indirect_y_indexed_SBC.cpp \
         indirect_y_indexed_STA.cpp \
+        input_journal_tests.cpp \
         instruction_executor_tests.cpp \
+        instruction_set_tests.cpp \
+        memory_bus_tests.cpp \
         registers_tests.cpp \
+        recompiled_test_program.cpp \
         relative_mode_BCC.cpp \
         relative_mode_BCS.cpp \
         relative_mode_BEQ.cpp \
@@ -120,6 +134,10 @@ SOURCES += \
         relative_mode_BPL.cpp \
         relative_mode_BVC.cpp \
         relative_mode_BVS.cpp \
+        rewind_buffer_tests.cpp \
+        snapshot_tests.cpp \
+        state_hash_tests.cpp \
+        static_recompiler_tests.cpp \
         x_indexed_indirect_ADC.cpp \
         x_indexed_indirect_AND.cpp \
         x_indexed_indirect_CMP.cpp \
@@ -180,5 +198,19 @@ else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PW
 else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../emulator/debug/emulator.lib
 else:unix: PRE_TARGETDEPS += $$OUT_PWD/../emulator/libemulator.a
 
+# The Qt-free core library the emulator library is built on.
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lcore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lcore
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lcore
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libcore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libcore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/core.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/core.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../core/libcore.a
+
 DISTFILES += \
     PLAN.md